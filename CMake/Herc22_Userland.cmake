@@ -441,6 +441,7 @@ herc_Check_Function_Exists( getlogin_r FAIL )
 herc_Check_Function_Exists( realpath FAIL )
 herc_Check_Function_Exists( fsync FAIL )
 herc_Check_Function_Exists( ftruncate FAIL )
+herc_Check_Function_Exists( posix_fallocate OK )
 herc_Check_Function_Exists( fork FAIL )
 herc_Check_Function_Exists( sysconf FAIL )
 
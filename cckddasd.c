@@ -306,7 +306,7 @@ int             fdflags;                /* File flags                */
         return -1;
 
     /* Initialize locks and conditions */
-    initialize_lock (&cckd->cckdiolock);
+    initialize_adaptive_lock (&cckd->cckdiolock);
     initialize_lock (&cckd->filelock);
     initialize_condition (&cckd->cckdiocond);
 
@@ -1577,6 +1577,8 @@ void* cckd_ra (void* arg)
 
     UNREFERENCED(arg);
 
+    apply_thread_affinity(AFFINITY_CCKD, -1);
+
     obtain_lock(&cckdblk.ralock);
     ra = ++cckdblk.raa;  /* increment nr ra threads dispatched */
     MSGBUF(threadname, "Read-ahead thread-%d", ra);
@@ -1826,6 +1828,7 @@ int             rc;
     if(cckdblk.wrprio >= 0)
         set_thread_priority(0, cckdblk.wrprio);
 #endif
+    apply_thread_affinity(AFFINITY_CCKD, -1);
 
     obtain_lock (&cckdblk.wrlock);
 
@@ -2279,6 +2279,7 @@ u_int   waitcount = 0;                  /* Wait counter              */
         set_thread_priority(0, sysblk.devprio);
         current_priority = sysblk.devprio;
     }
+    apply_thread_affinity(AFFINITY_DEV, -1);
 
     obtain_lock(&sysblk.ioqlock);
 
@@ -5720,6 +5721,47 @@ int     i;                              /* Interruption subclass     */
     return SIE_NO_INTERCEPT;
 } /* end function interrupt_enabled */
 
+/*-------------------------------------------------------------------*/
+/* Select the CPUs of mask enabled for a queued I/O interrupt        */
+/*                                                                   */
+/* Input                                                             */
+/*      mask    Waiting CPUs which are candidates for a wakeup       */
+/* Returns the CPUs of mask which are enabled for I/O interrupts     */
+/* and for the interruption subclass of at least one queued          */
+/* interrupt.  The caller holds sysblk.iointqlk.                     */
+/*-------------------------------------------------------------------*/
+static CPU_BITMAP
+ARCH_DEP(io_enabled_mask) (CPU_BITMAP mask)
+{
+REGS   *regs;                           /* -> CPU register context   */
+IOINT  *io;                             /* -> Queued I/O interrupt   */
+CPU_BITMAP enabled = 0;                 /* CPUs enabled              */
+int     i;                              /* CPU number                */
+
+    for (i = 0; mask; mask >>= 1, ++i)
+    {
+        if (!(mask & 1))
+            continue;
+
+        regs = sysblk.regs[i];
+        if (regs == NULL || !(regs->ints_mask & BIT(IC_IO)))
+            continue;
+
+        for (io = sysblk.iointq; io != NULL; io = io->next)
+        {
+            if (!io->dev->tschpending
+             && ARCH_DEP(interrupt_enabled)(regs, io->dev))
+            {
+                enabled |= regs->cpubit;
+                break;
+            }
+        }
+    }
+
+    return enabled;
+
+} /* end function io_enabled_mask */
+
 
 /*-------------------------------------------------------------------*/
 /* PRESENT PENDING I/O INTERRUPT                                     */
@@ -5818,7 +5860,7 @@ retry:
                 /* Wakeup the LRU waiting CPU enabled for I/O
                  * interrupts.
                  */
-                WAKEUP_CPU_MASK(wake);
+                sysblk.iowakeups += WAKEUP_CPU_MASK(wake);
             }
         }
 
@@ -6184,6 +6226,23 @@ DLL_EXPORT int device_attention (DEVBLK *dev, BYTE unitstat)
     return 3;   /* subchannel is not valid or not enabled */
 }
 
+static CPU_BITMAP io_enabled_mask (CPU_BITMAP mask)
+{
+    switch(sysblk.arch_mode)
+    {
+#if defined(_370)
+        case ARCH_370: return s370_io_enabled_mask(mask);
+#endif
+#if defined(_390)
+        case ARCH_390: return s390_io_enabled_mask(mask);
+#endif
+#if defined(_900)
+        case ARCH_900: return z900_io_enabled_mask(mask);
+#endif
+    }
+    return mask;
+}
+
 void call_execute_ccw_chain (int arch_mode, void* pDevBlk)
 {
     switch (arch_mode)
@@ -6237,6 +6296,7 @@ IOINT* prev;
         io->next     = prev->next;
         prev->next   = io;
         io->priority = io->dev->priority;
+        sysblk.iointcount++;
     }
 
     /* Update device flags according to interrupt type */
@@ -6315,7 +6375,33 @@ DLL_EXPORT void Update_IC_IOPENDING_QLocked()
     }
     else
     {
-        ON_IC_IOPENDING;
+        if (!(sysblk.ints_state & BIT(IC_IO)))
+            SET_IC_IOPENDING;
+        Wakeup_IO_CPU_QLocked();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*  Wake up exactly one waiting CPU which is enabled for a queued     */
+/*  I/O interrupt, honouring each CPU's interruption subclass mask.  */
+/*  CPUs which are running will notice IC_IO themselves.             */
+/*-------------------------------------------------------------------*/
+
+DLL_EXPORT void Wakeup_IO_CPU()
+{
+    obtain_lock( &sysblk.iointqlk );
+    Wakeup_IO_CPU_QLocked();
+    release_lock( &sysblk.iointqlk );
+}
+
+DLL_EXPORT void Wakeup_IO_CPU_QLocked()
+{
+CPU_BITMAP wake = sysblk.waiting_mask & sysblk.started_mask;
+
+    if (wake && sysblk.iointq != NULL)
+    {
+        wake = io_enabled_mask( wake );
+        sysblk.iowakeups += WAKEUP_CPU_MASK( wake );
     }
 }
 
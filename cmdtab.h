@@ -97,6 +97,22 @@
   "digits.\n"
 
 #define aea_cmd_desc            "Display AEA tables"
+#define affinity_cmd_desc       "Set/Display host thread affinity and NUMA placement"
+#define affinity_cmd_help       \
+                                \
+  "Format: \"affinity [ CPU [nn] | TOD | DEV | CCKD | QETH | LCS ] cpus|NONE\"\n"  \
+  "        \"affinity NUMA [ INTERLEAVE nodes | BIND nodes | NONE ]\"\n\n"         \
+  "Restricts a class of Hercules threads to a list of host CPUs such as\n"         \
+  "\"0-3,8\", or with NONE lets them run on any host CPU again. CPU applies\n"     \
+  "to all emulated CPU threads or, with a hex CPU address nn, to just that\n"      \
+  "one. TOD is the timer thread, DEV the device threads, CCKD the compressed\n"    \
+  "dasd readahead and writer threads, QETH a QETH device thread while its\n"       \
+  "queues are active and LCS the LCS port threads. CPU and TOD threads are\n"      \
+  "moved at once; other threads take the setting as they next start.\n\n"          \
+  "NUMA interleaves main storage and its storage keys across, or binds them\n"     \
+  "to, a list of host NUMA nodes; storage already allocated is migrated.\n\n"      \
+  "Without operands the current settings and the host CPUs of each online\n"       \
+  "CPU thread are displayed.\n"
 #define aia_cmd_desc            "Display AIA fields"
 #define alrf_cmd_desc           "Command deprecated: Use \"archlvl enable|disable|query asn_lx_reuse\" instead"
 #define ar_cmd_desc             "Display access registers"
@@ -150,6 +166,19 @@
   "tape devices as needed depending on the updated empty/non-empty list\n"      \
   "state.\n"
 
+#define bbdisp_cmd_desc         "Display or set basic block dispatch mode"
+#define bbdisp_cmd_help         \
+                                \
+  "Format: \"bbdisp [on|off]\"\n\n"                                             \
+  "When on, a z/Architecture CPU builds straight line runs of general\n"        \
+  "instructions which it enters often into blocks of resolved\n"                \
+  "instruction handlers and executes them back to back. No host code\n"         \
+  "is generated. How often each block is entered is counted, and the\n"         \
+  "counts decay over time, so only currently hot code is built.\n"              \
+  "Privileged instructions, PER and SIE guests are always interpreted.\n"       \
+  "Without an operand the current setting and the block statistics of\n"        \
+  "each online CPU are displayed.\n"
+
 #define bminus_cm_desc          "Delete breakpoint"
 #define bminus_cm_help          \
                                 \
@@ -208,6 +237,19 @@
   "Use 'cfall' to configure/display all CPUs online/offline state.\n"
 
 #define cfall_cmd_desc          "Configure all CPU's online or offline"
+#define checkpoint_cmd_desc     "Take a checkpoint of hercules while it runs"
+#define checkpoint_cmd_help     \
+                                \
+  "Format: \"checkpoint [filename [base=basefile]]\"\n"                          \
+  "\n"                                                                           \
+  "Saves the state of the system in 'filename' like 'suspend filename\n"         \
+  "chunked' does, but while the CPUs keep running. Storage is saved\n"           \
+  "first, and then the pages that changed meanwhile are saved again,\n"          \
+  "until few are left changing. Only then are the CPUs stopped, for the\n"       \
+  "last of the changed pages and the remaining state, and then started\n"        \
+  "again. Resume the image with the resume command. 'base=basefile' is\n"        \
+  "as for the suspend command.\n"
+
 #define clocks_cmd_desc         "Display tod clkc and cpu timer"
 #define cmdlevel_cmd_desc       "Display/Set current command group"
 #define cmdlevel_cmd_help       \
@@ -524,6 +566,18 @@
   "for 64-bit registers). Enter \"fpr\" by itself to display the register\n"     \
   "values without altering them.\n"
 
+#define fusion_cmd_desc         "Display or set instruction pair fusion"
+#define fusion_cmd_help         \
+                                \
+  "Format: \"fusion [on|off|reset]\"\n\n"                                        \
+  "When on and threaded dispatch is active, common instruction pairs\n"        \
+  "(CR, CLR, C or CHI followed by BRC or BC, LTR followed by BRC, L\n"         \
+  "followed by ST, LA followed by BRCT and ICM followed by BRC) are\n"         \
+  "executed as a unit without returning to the dispatcher. Without an\n"      \
+  "operand the setting and the number of times each pair was fused,\n"        \
+  "summed over all processors, are displayed. \"reset\" clears the\n"         \
+  "counts.\n"
+
 #define g_cmd_desc              "Turn off instruction stepping and start all CPUs"
 #define gpr_cmd_desc            "Display or alter general purpose registers"
 #define gpr_cmd_help            \
@@ -614,6 +668,14 @@
 
 #define i_cmd_desc              "Generate I/O attention interrupt for device"
 #define icount_cmd_desc         "Display individual instruction counts"
+#define icount_cmd_help         \
+                                \
+  "Format: \"icount [sort | time | clear]\"\n\n"                                \
+  "Displays the number of times each instruction was executed, summed\n"       \
+  "over all processors, together with an estimate of the host time in\n"      \
+  "nanoseconds spent executing it. The estimate is derived from timing\n"     \
+  "one instruction in every 1024. \"sort\" orders the display by count,\n"   \
+  "\"time\" by host time, and \"clear\" resets all counts to zero.\n"
 #define iodelay_cmd_desc        "Display or set I/O delay value"
 #define iodelay_cmd_help        \
                                 \
@@ -673,7 +735,9 @@
   "address of where to begin loading memory. The file 'filename' is\n"           \
   "presumed to be a pure binary image file previously created via the\n"         \
   "'savecore' command. The default for 'address' is 0 (beginning of\n"           \
-  "storage).\n"
+  "storage). A sparse image saved by 'savecore ... sparse' is loaded at\n"       \
+  "'address', or by default where it was saved from, and the storage it\n"       \
+  "left out is cleared. Large files are mapped and copied in parallel.\n"
 
 #define loadparm_cmd_desc       "Set IPL parameter"
 #define loadparm_cmd_help       \
@@ -691,7 +755,14 @@
 #define locks_cmd_desc          "Display internal locks list"
 #define locks_cmd_help          \
                                 \
-  "Format: \"locks [HELD|tid|ALL] [SORT [TIME|TOD]|[OWNER|TID]|NAME|LOC]\"\n"
+  "Format: \"locks [HELD|tid|ALL] [SORT [TIME|TOD]|[OWNER|TID]|NAME|LOC]\"\n"   \
+  "        \"locks STATS [ON|OFF|RESET|name]\"\n\n"                            \
+  "\"locks STATS ON\" starts collecting the number of times each lock is\n"     \
+  "obtained and has to be waited for and how long it is waited for and\n"      \
+  "held, \"OFF\" stops and \"RESET\" clears them. \"locks STATS\" lists the\n"  \
+  "locks in descending order of total wait time, and with a lock name also\n"  \
+  "displays the log2 histograms of the wait and hold times of that lock.\n"  \
+  "\"spun\" counts the waits of adaptive locks that ended while spinning.\n"
 
 #define log_cmd_desc            "Direct logger output"
 #define log_cmd_help            \
@@ -733,7 +804,9 @@
 #define mainsize_cmd_desc       "Define/Display mainsize parameter"
 #define mainsize_cmd_help       \
                                 \
-  "Format: mainsize [ mmmm | nnnS [ lOCK | unlOCK ] ]\n"                         \
+  "Format: mainsize [ mmmm | nnnS [ lOCK | unlOCK ]\n"                           \
+  "                                [ huge | hugetlb[=1G] | nohuge ]\n"           \
+  "                                [ file=path | nofile ] ]\n"                   \
   "        mmmm    - define main storage size mmmm Megabytes\n"                  \
   "\n"                                                                           \
   "        nnnS    - define main storage size nnn S where S is the\n"            \
@@ -748,6 +821,20 @@
   "\n"                                                                           \
   "        lOCK    - attempt to lock storage (pages lock by host OS)\n"          \
   "        unlOCK  - leave storage unlocked (pagable by host OS)\n"              \
+  "        huge    - back storage with transparent huge pages\n"                 \
+  "        hugetlb - back storage with 2M hugetlbfs pages\n"                     \
+  "        hugetlb=1G - back storage with 1G hugetlbfs pages\n"                  \
+  "        nohuge  - back storage with normal host pages\n"                      \
+  "                  (unavailable huge pages fall back to the next\n"            \
+  "                  smaller kind and finally to normal pages)\n"                \
+  "        file=path - share storage and its storage keys with the\n"            \
+  "                  file path (e.g. in /dev/shm), which other\n"                \
+  "                  programs may map to inspect storage; only one\n"            \
+  "                  hercules may use the file.  Storage left in it\n"           \
+  "                  by \"suspend filename shared\" is kept for resume,\n"       \
+  "                  and cleared by an IPL or system reset command\n"            \
+  "                  that comes first\n"                                         \
+  "        nofile  - use private host memory for storage\n"                      \
   "\n"                                                                           \
   "      (none)    - display current mainsize value\n"                           \
   "\n"                                                                           \
@@ -937,6 +1024,20 @@
   "interruption.\n"
 
 #define plant_cmd_desc          "Set STSI plant code"
+#define plolock_cmd_desc        "Display or set PLO locking"
+#define plolock_cmd_help        \
+                                \
+  "Format: \"plolock [main|striped|reset]\"\n\n"                                \
+  "With \"main\" (the default) every PERFORM LOCKED OPERATION serializes\n"     \
+  "on the main storage lock, as CS, CDS and TS do. With \"striped\" PLO\n"      \
+  "serializes on one of a table of locks selected by the program lock\n"        \
+  "token address in GR1, so that PLOs on unrelated lock words run in\n"         \
+  "parallel, but PLO is then no longer interlocked with CS, CDS and TS\n"       \
+  "updating the same storage. Use it only for guests which do not mix\n"        \
+  "them. The mode may only be changed while all CPUs are stopped.\n"            \
+  "Without an operand the current setting and the per-CPU counts of PLO\n"      \
+  "locks taken and contended are displayed, and \"reset\" clears them.\n"
+
 #define pr_cmd_desc             "Display or alter prefix register"
 #define pr_cmd_help             \
                                 \
@@ -967,6 +1068,19 @@
   "\n"                                                                           \
   "Enter \"psw\" by itself to display the current PSW without altering it.\n"
 
+#define profile_cmd_desc        "Guest PSW sampling profiler"
+#define profile_cmd_help        \
+                                \
+  "Format: \"profile [on [hz] | off | reset | top [n] | fold file]\"\n\n"         \
+  "Samples the PSW instruction address, primary address space and\n"          \
+  "problem/supervisor state of every online processor (of its SIE\n"          \
+  "guest when in SIE) 'hz' times per second (default 100), without\n"        \
+  "stopping the processors. \"off\" stops sampling and discards the\n"        \
+  "samples, \"reset\" discards the samples taken so far. \"top\" displays\n"  \
+  "the 'n' most frequently sampled addresses (default 20). \"fold\"\n"       \
+  "writes all samples to 'file' in the folded stack format accepted by\n"     \
+  "flamegraph.pl. Without an operand the profiler status is displayed.\n"
+
 #define ptp_cmd_desc            "Enable/Disable PTP debugging"
 #define ptp_cmd_help            \
                                 \
@@ -987,6 +1101,9 @@
   "identifying which events are to be traced. When the last option is numeric,\n"   \
   "it defines the size of the trace table itself and activates tracing.\n"          \
   "\n"                                                                              \
+  "Each thread traces into its own table of that size without any locking.\n"       \
+  "The tables of all threads are merged into time order when displayed.\n"          \
+  "\n"                                                                              \
   "Events:    (should be specified first, before any options are specified)\n"      \
   "\n"                                                                              \
   "     (no)log          trace internal logger events\n"                            \
@@ -1005,11 +1122,12 @@
   "options:   (should be specified last, after any events are specified)\n"         \
   "\n"                                                                              \
   "     ?                show currently defined trace parameters\n"                 \
-  "     (no)lock         lock table before updating\n"                              \
+  "     (no)lock         (obsolete; accepted for compatibility)\n"                  \
   "     (no)tod          timestamp table entries\n"                                 \
   "     (no)wrap         wraparound trace table\n"                                  \
   "     to=nnn           automatic display timeout  (number of seconds)\n"          \
-  "     nnnnnn           table size                 (number of entries)\n"
+  "     dump=file        write all entries in time order to a binary file\n"        \
+  "     nnnnnn           table size                 (entries per thread)\n"
 
 #define pwd_cmd_desc            "Print working directory"
 #define qcpuid_cmd_desc         "Display cpuid"
@@ -1214,12 +1332,14 @@
 #define savecore_cmd_desc       "Save a core image to file"
 #define savecore_cmd_help       \
                                 \
-  "Format: \"savecore filename [{start|*}] [{end|*}]\" where 'start' and\n"      \
-  "'end' define the starting and ending addresss of the range of real\n"         \
-  "storage to be saved to file 'filename'. An '*' for either the start\n"        \
-  "address or end address (the default) means: \"the first/last byte of\n"       \
-  "the first/last modified page as determined by the storage-key\n"              \
-  "'changed' bit\".\n"
+  "Format: \"savecore filename [{start|*}] [{end|*}] [sparse]\" where\n"         \
+  "'start' and 'end' define the starting and ending addresss of the\n"           \
+  "range of real storage to be saved to file 'filename'. An '*' for\n"           \
+  "either the start address or end address (the default) means: \"the\n"         \
+  "first/last byte of the first/last modified page as determined by the\n"       \
+  "storage-key 'changed' bit\". 'sparse' leaves out the pages that are\n"        \
+  "all zero, including those never used, and writes an index of the\n"           \
+  "rest for the 'loadcore' command.\n"
 
 #define sclproot_cmd_desc       "Set SCLP base directory"
 #define sclproot_cmd_help       \
@@ -1379,6 +1499,22 @@
 #define stopall_cmd_desc        "Stop all CPU's"
 #define store_cmd_desc          "Store CPU status at absolute zero"
 #define suspend_cmd_desc        "Suspend hercules"
+#define suspend_cmd_help        \
+                                \
+  "Format: \"suspend [filename [chunked | base=basefile | shared]]\"\n"          \
+  "\n"                                                                           \
+  "Saves the state of the system in 'filename' and shuts hercules down.\n"       \
+  "\n"                                                                           \
+  "'chunked' saves storage in 1M chunks that are compressed in parallel,\n"      \
+  "leaving out pages that are all zero. 'base=basefile' saves only the\n"        \
+  "chunks that changed since the chunked image 'basefile' was saved; the\n"      \
+  "resume command then restores the base image's storage first, so the\n"        \
+  "base image must remain available.\n"                                          \
+  "\n"                                                                           \
+  "'shared', with main storage shared with a file (mainsize file=),\n"           \
+  "leaves main storage in that file instead of saving it. Resume the\n"          \
+  "image once, in a hercules whose mainsize statement names that file.\n"
+
 #define symptom_cmd_desc        "Alias for traceopt"
 #define syncio_cmd_desc         "Display syncio devices statistics"
 #define sysclear_cmd_desc       "System Clear Reset manual operation"
@@ -1428,6 +1564,16 @@
   "is no range (or range was specified as 0) then all instructions will\n"       \
   "be traced.\n"
 
+#define threaded_cmd_desc       "Display or set threaded dispatch mode"
+#define threaded_cmd_help       \
+                                \
+  "Format: \"threaded [on|off]\"\n\n"                                             \
+  "When on, the CPU execution loop uses computed goto dispatch with the\n"      \
+  "most frequently executed instructions (LR, LTR, CR, CLR, C, CHI, AR,\n"     \
+  "SR, LA, BC, BCR, BRC, BRCT, L and ST) executed inline. Instructions\n"      \
+  "replaced by a loaded module are never executed inline. Without an\n"       \
+  "operand the current setting is displayed. See also \"fusion\".\n"
+
 #define timerint_cmd_desc       "Display or set timers update interval"
 #define timerint_cmd_help       \
                                 \
@@ -1441,6 +1587,18 @@
   "(i.e. one second).\n"
 
 #define tlb_cmd_desc            "Display TLB tables"
+#define tlbways_cmd_desc        "Display or set TLB associativity"
+#define tlbways_cmd_help        \
+                                \
+  "Format: \"tlbways [1|2|4|reset]\"\n\n"                                      \
+  "Sets the number of entries in each of the 1024 sets of the\n"               \
+  "translation lookaside buffer. 1 is the direct mapped TLB.\n"               \
+  "The setting can only be changed while all CPUs are stopped and the\n"       \
+  "TLBs are purged when it is. Without an operand the setting and\n"           \
+  "the TLB hits (counted only if built with OPTION_TLB_HIT_COUNTING),\n"       \
+  "hits in the other ways of a set, misses and misses that replaced a\n"       \
+  "valid entry are displayed for each online CPU.\n"                           \
+  "\"reset\" clears the counts.\n"
 #define toddrag_cmd_desc        "Display or set TOD clock drag factor"
 #define todprio_cmd_desc        "Set/Display todprio parameter"
 #define traceopt_cmd_desc       "Instruction trace display options"
@@ -1481,10 +1639,18 @@
   "instead of using the current PSW mode, which is the default.\n"
 
 #define version_cmd_desc        "Display version information"
+#define wakestats_cmd_desc      "Display or reset CPU wakeup statistics"
+#define wakestats_cmd_help      \
+                                \
+  "Format: \"wakestats [reset]\"\n\n"                                           \
+  "Displays the number of I/O interrupts queued, the number of waiting\n"       \
+  "CPUs woken to take them and the wakeups per interrupt, followed by the\n"   \
+  "number of times each CPU was woken from the wait state and how many of\n"    \
+  "those wakeups found no interrupt to take. \"reset\" clears the counts.\n"
 #define xpndsize_cmd_desc       "Define/Display xpndsize parameter"
 #define xpndsize_cmd_help       \
                                 \
-  "Format: xpndsize [ mmmm | nnnS [ lOCK | unlOCK ] ]\n"                                \
+  "Format: xpndsize [ mmmm | nnnS [ lOCK | unlOCK ] [ huge | hugetlb | nohuge ] ]\n"    \
   "        mmmm    - define expanded storage size mmmm Megabytes\n"                     \
   "\n"                                                                                  \
   "        nnnS    - define expanded storage size nnn S where S is the multiplier\n"    \
@@ -1496,6 +1662,10 @@
   "\n"                                                                                  \
   "        lOCK    - attempt to lock storage (pages lock by host OS)\n"                 \
   "        unlOCK  - leave storage unlocked (pagable by host OS)\n"                     \
+  "        huge    - back storage with transparent huge pages\n"                        \
+  "        hugetlb - back storage with 2M hugetlbfs pages\n"                            \
+  "        hugetlb=1G - back storage with 1G hugetlbfs pages\n"                         \
+  "        nohuge  - back storage with normal host pages\n"                             \
   "\n"                                                                                  \
   " Note: Multiplier 'T' is not available on 32bit machines\n"                          \
   "       Expanded storage is limited to 1G on 32bit machines\n"
@@ -1573,6 +1743,7 @@ COMMAND( "b-",                      trace_cmd,              SYSCMDNOPER,
 COMMAND( "b",                       trace_cmd,              SYSCMDNOPER,        b_cmd_desc,             b_cmd_help          )
 COMMAND( "b+",                      trace_cmd,              SYSCMDNOPER,        bplus_cmd_desc,         NULL                )
 COMMAND( "cachestats",              EXTCMD(cachestats_cmd), SYSCMDNOPER,        cachestats_cmd_desc,    NULL                )
+COMMAND( "checkpoint",              checkpoint_cmd,         SYSCMDNOPER,        checkpoint_cmd_desc,    checkpoint_cmd_help )
 COMMAND( "clocks",                  clocks_cmd,             SYSCMDNOPER,        clocks_cmd_desc,        NULL                )
 COMMAND( "codepage",                codepage_cmd,           SYSCMDNOPER,        codepage_cmd_desc,      codepage_cmd_help   )
 COMMAND( "conkpalv",                conkpalv_cmd,           SYSCMDNOPER,        conkpalv_cmd_desc,      conkpalv_cmd_help   )
@@ -1596,6 +1767,7 @@ COMMAND( "numcpu",                  numcpu_cmd,             SYSCMDNOPER,
 COMMAND( "numvec",                  numvec_cmd,             SYSCMDNOPER,        numvec_cmd_desc,        NULL                )
 COMMAND( "ostailor",                ostailor_cmd,           SYSCMDNOPER,        ostailor_cmd_desc,      ostailor_cmd_help   )
 COMMAND( "pgmtrace",                pgmtrace_cmd,           SYSCMDNOPER,        pgmtrace_cmd_desc,      pgmtrace_cmd_help   )
+COMMAND( "plolock",                 plolock_cmd,            SYSCMDNOPER,        plolock_cmd_desc,       plolock_cmd_help    )
 COMMAND( "pr",                      pr_cmd,                 SYSCMDNOPER,        pr_cmd_desc,            pr_cmd_help         )
 COMMAND( "psw",                     psw_cmd,                SYSCMDNOPER,        psw_cmd_desc,           psw_cmd_help        )
 COMMAND( "ptp",                     ptp_cmd,                SYSCMDNOPER,        ptp_cmd_desc,           ptp_cmd_help        )
@@ -1613,7 +1785,7 @@ COMMAND( "savecore",                savecore_cmd,           SYSCMDNOPER,
 COMMAND( "script",                  script_cmd,             SYSCMDNOPER,        script_cmd_desc,        script_cmd_help     )
 COMMAND( "sh",                      sh_cmd,                 SYSCMDNOPER,        sh_cmd_desc,            sh_cmd_help         )
 COMMAND( "shrd",                    EXTCMD(shared_cmd),     SYSCMDNOPER,        shrd_cmd_desc,          NULL                )
-COMMAND( "suspend",                 suspend_cmd,            SYSCMDNOPER,        suspend_cmd_desc,       NULL                )
+COMMAND( "suspend",                 suspend_cmd,            SYSCMDNOPER,        suspend_cmd_desc,       suspend_cmd_help    )
 COMMAND( "symptom",                 traceopt_cmd,           SYSCMDNOPER,        symptom_cmd_desc,       NULL                )
 COMMAND( "t-",                      trace_cmd,              SYSCMDNOPER,        tminus_cmd_desc,        NULL                )
 COMMAND( "t",                       trace_cmd,              SYSCMDNOPER,        t_cmd_desc,             t_cmd_help          )
@@ -1625,6 +1797,7 @@ COMMAND( "toddrag",                 toddrag_cmd,            SYSCMDNOPER,
 COMMAND( "traceopt",                traceopt_cmd,           SYSCMDNOPER,        traceopt_cmd_desc,      traceopt_cmd_help   )
 COMMAND( "u",                       u_cmd,                  SYSCMDNOPER,        u_cmd_desc,             u_cmd_help          )
 COMMAND( "v",                       v_cmd,                  SYSCMDNOPER,        v_cmd_desc,             v_cmd_help          )
+COMMAND( "wakestats",               wakestats_cmd,          SYSCMDNOPER,        wakestats_cmd_desc,     wakestats_cmd_help  )
 
 #if 0 // Changing directory on the fly will invalidate all relative filenames in the configuration that have not yet been opened
 COMMAND( "cd",                      cd_cmd,                 SYSCMDNDIAG8,       cd_cmd_desc,            NULL                )
@@ -1643,6 +1816,7 @@ COMMAND( "store",                   store_cmd,              SYSCMDNDIAG8,
 COMMAND( "sysclear",                sysclear_cmd,           SYSCMDNDIAG8,       sysclear_cmd_desc,      sysclear_cmd_help   )
 COMMAND( "sysreset",                sysreset_cmd,           SYSCMDNDIAG8,       sysreset_cmd_desc,      sysreset_cmd_help   )
 
+COMMAND( "affinity",                affinity_cmd,           SYSCFGNDIAG8,       affinity_cmd_desc,      affinity_cmd_help   )
 COMMAND( "capping",                 capping_cmd,            SYSCFGNDIAG8,       capping_cmd_desc,       capping_cmd_help    )
 COMMAND( "cnslport",                cnslport_cmd,           SYSCFGNDIAG8,       cnslport_cmd_desc,      NULL                )
 COMMAND( "cpuidfmt",                cpuidfmt_cmd,           SYSCFGNDIAG8,       cpuidfmt_cmd_desc,      NULL                )
@@ -1770,7 +1944,7 @@ COMMAND( "httpport",                httpport_cmd,           SYSCONFIG,
 COMMAND( "httproot",                httproot_cmd,           SYSCONFIG,          httproot_cmd_desc,      httproot_cmd_help   )
 #endif
 #if defined( OPTION_INSTRUCTION_COUNTING )
-COMMAND( "icount",                  icount_cmd,             SYSCMDNOPER,        icount_cmd_desc,        NULL                )
+COMMAND( "icount",                  icount_cmd,             SYSCMDNOPER,        icount_cmd_desc,        icount_cmd_help     )
 #endif
 #if defined( OPTION_IODELAY_KLUDGE )
 COMMAND( "iodelay",                 iodelay_cmd,            SYSCMDNOPER,        iodelay_cmd_desc,       iodelay_cmd_help    )
@@ -1811,5 +1985,18 @@ COMMAND( "showdvol1",               showdvol1_cmd,          SYSCMD,
 #ifdef OPTION_SYNCIO
 COMMAND( "syncio",                  syncio_cmd,             SYSCMDNOPER,        syncio_cmd_desc,        NULL                )
 #endif // OPTION_SYNCIO
+#if defined( OPTION_BLOCK_DISPATCH )
+COMMAND( "bbdisp",                  bbdisp_cmd,             SYSCMDNOPER,        bbdisp_cmd_desc,        bbdisp_cmd_help     )
+#endif
+#if defined( OPTION_THREADED_DISPATCH )
+COMMAND( "threaded",                threaded_cmd,           SYSCMDNOPER,        threaded_cmd_desc,      threaded_cmd_help   )
+COMMAND( "fusion",                  fusion_cmd,             SYSCMDNOPER,        fusion_cmd_desc,        fusion_cmd_help     )
+#endif
+#if defined( OPTION_TLB_WAYS )
+COMMAND( "tlbways",                 tlbways_cmd,            SYSCMDNOPER,        tlbways_cmd_desc,       tlbways_cmd_help    )
+#endif
+#if defined( OPTION_GUEST_PROFILER )
+COMMAND( "profile",                 profile_cmd,            SYSCMDNOPER,        profile_cmd_desc,       profile_cmd_help    )
+#endif
 
 /*------------------------------(EOF)--------------------------------*/
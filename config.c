@@ -21,6 +21,11 @@ DISABLE_GCC_WARNING( "-Wunused-function" )
 #include "opcode.h"
 #include "chsc.h"
 
+#if defined(__linux__)
+  #include <sys/syscall.h>
+  #include <linux/mempolicy.h>
+#endif
+
 #if !defined(_GEN_ARCH)
 
 #if defined(_ARCHMODE3)
@@ -110,11 +115,390 @@ DISABLE_GCC_WARNING( "-Wint-to-pointer-cast" )
 /* storage configuration */
 static U64   config_allocmsize = 0;
 static BYTE *config_allocmaddr  = NULL;
+static size_t config_allocmlen  = 0;    /* Bytes obtained            */
+static BYTE  config_allocmhuge  = HUGEPG_NONE; /* ...when requested  */
+static char *config_allocmfile  = NULL; /* ...and shared file        */
+static int   config_allocmfd    = -1;   /* ...held open and locked   */
+
+/*-------------------------------------------------------------------*/
+/* Huge page backed storage.  Storage is obtained with mmap, either  */
+/* from hugetlbfs or with a madvise hint for transparent huge pages, */
+/* falling back to 2M pages when 1G pages are not available, then to */
+/* transparent huge pages and finally to normal pages.               */
+/*                                                                   */
+/* Normal pages are an anonymous demand-zero mapping too where the   */
+/* host has one, so that guest storage only becomes resident as the */
+/* guest touches it and can be handed back with storage_release.     */
+/* Otherwise storage comes from the heap.                            */
+/*-------------------------------------------------------------------*/
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+  #define MAP_ANONYMOUS MAP_ANON
+#endif
+#if !defined(_MSVC_) && defined(MAP_ANONYMOUS)
+  #define STORAGE_MMAP
+#endif
+
+#define HUGEPG_ALIGN    (2 * ONE_MEGABYTE)  /* THP/2M page boundary  */
+
+/*-------------------------------------------------------------------*/
+/* Describe the kind of host pages backing a storage area            */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT const char *hugepg_name(int back)
+{
+    switch (back)
+    {
+    case HUGEPG_1G:  return "1G hugetlbfs pages";
+    case HUGEPG_2M:  return "2M hugetlbfs pages";
+    case HUGEPG_THP: return "transparent huge pages";
+    case HUGEPG_FILE: return "a shared file";
+    }
+    return "normal host pages";
+}
+
+/*-------------------------------------------------------------------*/
+/* Obtain zeroed huge page backed storage with room for len bytes    */
+/* from the first HUGEPG_ALIGN boundary.  Returns NULL if none of    */
+/* the huge page kinds up to the one requested could be obtained;    */
+/* otherwise *back says which was and *plen how many bytes were      */
+/* mapped.                                                           */
+/*-------------------------------------------------------------------*/
+static BYTE *hugepg_alloc(size_t len, int request, int *back, size_t *plen)
+{
+#if defined(STORAGE_MMAP) && (defined(MAP_HUGETLB) || defined(MADV_HUGEPAGE))
+void   *p;
+size_t  pgsz;
+int     flags;
+
+#if defined(MAP_HUGETLB)
+    for (; request >= HUGEPG_2M; request--)
+    {
+        pgsz  = request == HUGEPG_1G ? ONE_GIGABYTE : HUGEPG_ALIGN;
+        flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined(MAP_HUGE_SHIFT)
+        flags |= (request == HUGEPG_1G ? 30 : 21) << MAP_HUGE_SHIFT;
+#endif
+        *plen = (len + pgsz - 1) & ~(pgsz - 1);
+        p = mmap(NULL, *plen, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            *back = request;
+            return p;
+        }
+    }
+#endif /*defined(MAP_HUGETLB)*/
+
+#if defined(MADV_HUGEPAGE)
+    if (request >= HUGEPG_THP)
+    {
+        /* Map an extra huge page so the start can be aligned */
+        *plen = len + HUGEPG_ALIGN;
+        p = mmap(NULL, *plen, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            if (madvise(p, *plen, MADV_HUGEPAGE) == 0)
+            {
+                *back = HUGEPG_THP;
+                return p;
+            }
+            munmap(p, *plen);
+        }
+    }
+#endif /*defined(MADV_HUGEPAGE)*/
+
+#else
+    UNREFERENCED(len);
+    UNREFERENCED(request);
+    UNREFERENCED(plen);
+#endif
+    *back = HUGEPG_NONE;
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Obtain zeroed storage on normal pages with room for len bytes     */
+/* from the first align boundary; *plen is the length obtained.      */
+/*-------------------------------------------------------------------*/
+static BYTE *storage_alloc(size_t len, size_t align, size_t *plen)
+{
+#if defined(STORAGE_MMAP)
+void   *p;
+int     flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#if defined(MAP_NORESERVE)
+    /* Untouched guest storage is not charged against host memory */
+    flags |= MAP_NORESERVE;
+#endif
+    *plen = len + align;
+    p = mmap(NULL, *plen, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+#else
+    *plen = len + align;
+    return calloc(*plen, 1);
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Map main storage and its storage keys from a shared file, after   */
+/* a STORFILE header page; len is the length of the keys and main    */
+/* storage.  The file is locked against other processes.  *pfd is    */
+/* the locked descriptor of the file mapped until now, or -1; it is  */
+/* reused if fn names the same file, since closing either of two     */
+/* descriptors of a file releases the lock.  On success *pfd is the  */
+/* locked descriptor of fn, and the caller closes the old one if it  */
+/* differs; on failure the old one is left open and locked.          */
+/* If the file holds the storage of a suspended image with the same  */
+/* layout, its contents are kept for resume and *kept is set;        */
+/* otherwise the file is made len bytes of zeros.  *plen is the      */
+/* length mapped.                                                    */
+/*-------------------------------------------------------------------*/
+static BYTE *storage_map_file(const char *fn, U64 mainsize, size_t len,
+                              size_t *plen, int *kept, int *pfd)
+{
+#if defined(STORAGE_MMAP)
+STORFILE hdr, old;                      /* Header wanted, found      */
+struct stat st, oldst;
+struct flock lk;
+char    pathname[MAX_PATH];
+void   *p;
+int     fd, rc;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.id, STORFILE_ID, sizeof(hdr.id));
+    hdr.version  = STORFILE_VERSION;
+    hdr.keyunit  = _STORKEY_ARRAY_UNITSIZE;
+    hdr.mainsize = mainsize;
+    hdr.skeyoff  = 4096;
+    hdr.mainoff  = 4096 + len - mainsize;
+    *plen = 4096 + len;
+
+    hostpath(pathname, fn, sizeof(pathname));
+
+    /* Reuse the descriptor of the file mapped until now */
+    if (*pfd >= 0 && stat(pathname, &st) == 0 && fstat(*pfd, &oldst) == 0
+     && st.st_dev == oldst.st_dev && st.st_ino == oldst.st_ino)
+        fd = *pfd;
+    else
+    {
+        if ((fd = HOPEN(pathname, O_RDWR | O_CREAT, S_IREAD | S_IWRITE)) < 0)
+            return NULL;
+
+        /* Only one process may map the file for update */
+        memset(&lk, 0, sizeof(lk));
+        lk.l_type = F_WRLCK;
+        lk.l_whence = SEEK_SET;
+        if (fcntl(fd, F_SETLK, &lk) != 0)
+        {
+            // "Main storage file %s is in use by another process"
+            WRMSG(HHC17023, "E", pathname);
+            close(fd);
+            errno = EBUSY;
+            return NULL;
+        }
+    }
+
+    /* Keep the storage of a suspended image with the same layout */
+    *kept = fstat(fd, &st) == 0 && (U64)st.st_size == (U64)*plen
+         && pread(fd, &old, sizeof(old), 0) == sizeof(old)
+         && memcmp(&old, &hdr, offsetof(STORFILE, suspended)) == 0
+         && old.suspended != 0;
+
+    rc = 0;
+    if (!*kept && (ftruncate(fd, 0) != 0 || ftruncate(fd, *plen) != 0))
+        rc = errno;
+    p = MAP_FAILED;
+    if (rc == 0)
+    {
+        p = mmap(NULL, *plen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        rc = errno;
+    }
+    if (p == MAP_FAILED)
+    {
+        if (fd != *pfd)
+            close(fd);
+        errno = rc;
+        return NULL;
+    }
+    if (!*kept)
+        memcpy(p, &hdr, sizeof(hdr));
+
+    /* Closing the file would release the lock */
+    *pfd = fd;
+    return p;
+#else
+    UNREFERENCED(fn);
+    UNREFERENCED(mainsize);
+    UNREFERENCED(len);
+    UNREFERENCED(plen);
+    UNREFERENCED(pfd);
+    *kept = 0;
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Write main storage in a shared file back to the file.             */
+/* Returns 0 or an errno value.                                      */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int storage_sync()
+{
+#if defined(STORAGE_MMAP)
+    if (sysblk.mainfhdr
+     && msync(sysblk.mainfhdr, (size_t)(sysblk.mainfhdr->mainoff
+                                      + sysblk.mainfhdr->mainsize),
+              MS_SYNC) != 0)
+        return errno;
+    return 0;
+#else
+    return sysblk.mainfhdr ? ENOTSUP : 0;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Release storage obtained by storage_alloc, hugepg_alloc or        */
+/* storage_map_file                                                  */
+/*-------------------------------------------------------------------*/
+static void storage_free(BYTE *addr, size_t len)
+{
+#if defined(STORAGE_MMAP)
+    munmap(addr, len);
+#else
+    UNREFERENCED(len);
+    free(addr);
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Give the host pages backing part of main or expanded storage back */
+/* to the host; the range reads as zeros afterwards.  Partial host   */
+/* pages, hugetlbfs pages and heap storage are cleared instead, as   */
+/* is a shared file whose file system cannot punch holes.            */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT void storage_release(BYTE *addr, size_t len, int back)
+{
+#if defined(STORAGE_MMAP) && defined(__linux__) && defined(MADV_DONTNEED)
+U64     pgsz;
+BYTE   *beg, *end;
+int     advice = MADV_DONTNEED;
+
+#if defined(MADV_REMOVE)
+    /* Shared file pages are zeroed by freeing them in the file */
+    if (back == HUGEPG_FILE)
+        advice = MADV_REMOVE;
+#endif
+    if (back == HUGEPG_NONE || back == HUGEPG_THP
+     || (back == HUGEPG_FILE && advice != MADV_DONTNEED))
+    {
+        pgsz = hostinfo.hostpagesz ? hostinfo.hostpagesz : 4096;
+        beg = (BYTE*)(((U64)addr + pgsz - 1) & ~(pgsz - 1));
+        end = (BYTE*)(((U64)addr + len) & ~(pgsz - 1));
+
+        /* Private anonymous pages are zero filled on next touch */
+        if (beg < end && madvise(beg, end - beg, advice) == 0)
+        {
+            memset(addr, 0, beg - addr);
+            memset(end, 0, (addr + len) - end);
+            return;
+        }
+    }
+#else
+    UNREFERENCED(back);
+#endif
+    memset(addr, 0, len);
+}
+
+/*-------------------------------------------------------------------*/
+/* Count the bytes of a storage area that are resident in host       */
+/* memory.  Returns 0 or an errno value.                             */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int storage_resident(BYTE *addr, size_t len, U64 *resident)
+{
+#if defined(STORAGE_MMAP)
+unsigned char vec[4096];                /* One byte per host page    */
+U64     pgsz;
+BYTE   *beg, *end;
+size_t  n, i;
+
+    pgsz = hostinfo.hostpagesz ? hostinfo.hostpagesz : 4096;
+    beg = (BYTE*)((U64)addr & ~(pgsz - 1));
+    end = addr + len;
+    *resident = 0;
+
+    for (; beg < end; beg += n * pgsz)
+    {
+        n = MIN(sizeof(vec), (size_t)((end - beg + pgsz - 1) / pgsz));
+        if (mincore(beg, n * pgsz, (void*)vec) != 0)
+            return errno;
+        for (i = 0; i < n; i++)
+            if (vec[i] & 1)
+                *resident += pgsz;
+    }
+    if (*resident > len)
+        *resident = len;
+    return 0;
+#else
+    UNREFERENCED(addr);
+    UNREFERENCED(len);
+    UNREFERENCED(resident);
+    return ENOTSUP;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Report the page backing of storage if huge pages were requested   */
+/*-------------------------------------------------------------------*/
+static void hugepg_report(const char *what, int request, int back)
+{
+    if (request == HUGEPG_NONE)
+        return;
+    if (back == request)
+        // "%s storage is backed by %s%s"
+        WRMSG(HHC17020, "I", what, hugepg_name(back), "");
+    else
+        // "%s storage is backed by %s%s"
+        WRMSG(HHC17020, "W", what, hugepg_name(back),
+              "; requested pages are not available");
+}
+
+/*-------------------------------------------------------------------*/
+/* Place storage on host NUMA nodes per sysblk.numapolicy.  Pages    */
+/* already touched are migrated.  Returns 0 or an errno value.       */
+/*-------------------------------------------------------------------*/
+static int numa_place_storage(BYTE *addr, U64 size)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+U64   nodes[MAX_HOST_NODES / 64];
+int   mode = MPOL_DEFAULT;
+
+    memset(nodes, 0, sizeof(nodes));
+    if (sysblk.numapolicy != NUMA_NONE)
+    {
+        if (parse_numlist(sysblk.numanodes, nodes, MAX_HOST_NODES) <= 0)
+            return EINVAL;
+        mode = sysblk.numapolicy == NUMA_BIND ? MPOL_BIND : MPOL_INTERLEAVE;
+    }
+    if (syscall(SYS_mbind, addr, (unsigned long)size, mode,
+                mode == MPOL_DEFAULT ? NULL : nodes,
+                (unsigned long)(MAX_HOST_NODES + 1), MPOL_MF_MOVE) != 0)
+        return errno;
+    return 0;
+#else
+    UNREFERENCED(addr);
+    UNREFERENCED(size);
+    return ENOTSUP;
+#endif
+}
 int configure_storage(U64 mainsize)
 {
 BYTE *mainstor;
 BYTE *storkeys;
 BYTE *dofree = NULL;
+size_t dofreelen = 0;
+size_t alloclen = 0;
+int   back;
+int   kept = 0;
+int   mfd = -1;                         /* Locked shared file        */
 char *mfree = NULL;
 REGS *regs;
 U64   storsize;
@@ -129,12 +513,20 @@ int cpu;
     if (mainsize == ~0ULL)
     {
         if (config_allocmaddr)
-            free(config_allocmaddr);
+            storage_free(config_allocmaddr, config_allocmlen);
+        if (config_allocmfd >= 0)
+            close(config_allocmfd);
+        config_allocmfd = -1;
         sysblk.storkeys = 0;
         sysblk.mainstor = 0;
         sysblk.mainsize = 0;
+        sysblk.mainback = HUGEPG_NONE;
+        sysblk.mainfhdr = NULL;
         config_allocmsize = 0;
         config_allocmaddr = NULL;
+        config_allocmlen = 0;
+        free(config_allocmfile);
+        config_allocmfile = NULL;
         return 0;
     }
 
@@ -207,22 +599,54 @@ int cpu;
 
     if (storsize > config_allocmsize ||
         (mainsize <= (2 * ONE_MEGABYTE) &&
-         storsize < config_allocmsize))
+         storsize < config_allocmsize) ||
+        sysblk.mainhuge != config_allocmhuge ||
+        (sysblk.mainfile ? !config_allocmfile ||
+                           strcmp(sysblk.mainfile, config_allocmfile) ||
+                           storsize != config_allocmsize
+                         : config_allocmfile != NULL))
     {
         if (config_mfree &&
             mainsize > (2* ONE_MEGABYTE))
             mfree = malloc(config_mfree);
 
-        /* Obtain storage with hint to page size for cleanest allocation
+        storkeys = NULL;
+        back = HUGEPG_NONE;
+
+        /* Map storage from a shared file if requested; its layout
+         * is fixed by the storage size, so it is remapped whenever
+         * that changes
          */
-        storkeys = calloc((size_t)storsize + 1, 4096);
+        if (sysblk.mainfile)
+        {
+            mfd = config_allocmfd;
+            storkeys = storage_map_file(sysblk.mainfile, mainsize << 12,
+                                        (size_t)storsize << 12,
+                                        &alloclen, &kept, &mfd);
+            back = HUGEPG_FILE;
+        }
+
+        /* Obtain storage from huge pages if requested, with room to
+         * pad the storage keys to a huge page boundary
+         */
+        else if (sysblk.mainhuge != HUGEPG_NONE)
+            storkeys = hugepg_alloc(((size_t)storsize << 12) + HUGEPG_ALIGN,
+                                    sysblk.mainhuge, &back, &alloclen);
+
+        /* Otherwise obtain storage on normal pages, with room to
+         * adjust to a page boundary; it is not touched here, so it only
+         * becomes resident as the guest references it
+         */
+        if (storkeys == NULL && back != HUGEPG_FILE)
+            storkeys = storage_alloc((size_t)storsize << 12, 4096,
+                                     &alloclen);
 
         if (mfree)
             free(mfree);
 
         if (storkeys == NULL)
         {
-            char buf[64];
+            char buf[160];              /* fmt_memsize buffer is 128 */
             sysblk.main_clear = 0;
             MSGBUF( buf, "configure_storage(%s)",
                     fmt_memsize_KB((U64)mainsize << 2) );
@@ -234,10 +658,52 @@ int cpu;
          * storage pointers and adjust new storage to page boundary.
          */
         dofree = config_allocmaddr,
+        dofreelen = config_allocmlen,
         config_allocmsize = storsize,
         config_allocmaddr = storkeys,
-        sysblk.main_clear = 1,
-        storkeys = (BYTE*)(((U64)storkeys + 4095) & ~0x0FFFULL);
+        config_allocmlen = alloclen,
+        config_allocmhuge = sysblk.mainhuge,
+        sysblk.mainback = back,
+        sysblk.main_clear = !kept;
+        free(config_allocmfile);
+        config_allocmfile = sysblk.mainfile ? strdup(sysblk.mainfile) : NULL;
+        /* The file mapped until now stays locked until replaced */
+        if (config_allocmfd >= 0 && config_allocmfd != mfd)
+            close(config_allocmfd);
+        config_allocmfd = back == HUGEPG_FILE ? mfd : -1;
+        sysblk.mainfhdr = NULL;
+        if (back == HUGEPG_FILE)
+        {
+            /* Storage keys follow the file header page */
+            sysblk.mainfhdr = (STORFILE*)storkeys;
+            storkeys += 4096;
+            // "Main storage is shared with file %s%s"
+            WRMSG(HHC17022, "I", sysblk.mainfile,
+                  kept ? "; it holds suspended storage, kept for resume" : "");
+        }
+        else if (back == HUGEPG_NONE)
+            storkeys = (BYTE*)(((U64)storkeys + 4095) & ~0x0FFFULL);
+        else
+        {
+            /* Pad the storage keys so that mainstor, which follows
+             * them, starts on a huge page boundary too
+             */
+            storkeys = (BYTE*)(((U64)storkeys + (HUGEPG_ALIGN - 1)) &
+                               ~((U64)HUGEPG_ALIGN - 1));
+            storkeys += ((((U64)skeysize << 12) + (HUGEPG_ALIGN - 1)) &
+                         ~((U64)HUGEPG_ALIGN - 1)) - ((U64)skeysize << 12);
+        }
+        if (back != HUGEPG_FILE)
+            hugepg_report("Main", sysblk.mainhuge, back);
+
+        /* Place storage keys and mainstor before they are cleared */
+        if (sysblk.numapolicy != NUMA_NONE)
+        {
+            int rc = numa_place_storage(storkeys, storsize << 12);
+            if (rc)
+                // "NUMA placement of main storage failed: %s"
+                WRMSG(HHC17019, "W", strerror(rc));
+        }
     }
     else
     {
@@ -264,10 +730,14 @@ int cpu;
      *
      */
     if (dofree)
-        free(dofree);
+        storage_free(dofree, dofreelen);
 
-    /* Initial power-on reset for main storage */
-    storage_clear();
+    /* Initial power-on reset for main storage, unless a shared file
+     * holds it for resume; it is then cleared by an IPL or a system
+     * reset command that comes before the resume
+     */
+    if (!kept)
+        storage_clear();
 
 #if 0   /*DEBUG-JJ-20/03/2000*/
     /* Mark selected frames invalid for debugging purposes */
@@ -312,11 +782,16 @@ int cpu;
 
 static U64   config_allocxsize = 0;
 static BYTE *config_allocxaddr = NULL;
+static size_t config_allocxlen = 0;     /* Bytes obtained            */
+static BYTE  config_allocxhuge = HUGEPG_NONE; /* ...when requested   */
 int configure_xstorage(U64 xpndsize)
 {
 #ifdef _FEATURE_EXPANDED_STORAGE
 BYTE *xpndstor;
 BYTE *dofree = NULL;
+size_t dofreelen = 0;
+size_t alloclen = 0;
+int   back;
 char *mfree = NULL;
 REGS *regs;
 int  cpu;
@@ -330,11 +805,13 @@ int  cpu;
         xpndsize == ~0ULL)
     {
         if (config_allocxaddr)
-            free(config_allocxaddr);
+            storage_free(config_allocxaddr, config_allocxlen);
         sysblk.xpndsize = 0,
         sysblk.xpndstor = 0,
+        sysblk.xpndback = HUGEPG_NONE,
         config_allocxsize = 0,
-        config_allocxaddr = NULL;
+        config_allocxaddr = NULL,
+        config_allocxlen = 0;
         return 0;
     }
 
@@ -354,20 +831,32 @@ int  cpu;
      *
      */
 
-    if (xpndsize > config_allocxsize)
+    if (xpndsize > config_allocxsize ||
+        sysblk.xpndhuge != config_allocxhuge)
     {
         if (config_mfree)
             mfree = malloc(config_mfree);
 
-        /* Obtain expanded storage, hinting to megabyte boundary */
-        xpndstor = calloc((size_t)xpndsize + 1, ONE_MEGABYTE);
+        /* Obtain expanded storage from huge pages if requested */
+        xpndstor = NULL;
+        back = HUGEPG_NONE;
+        if (sysblk.xpndhuge != HUGEPG_NONE)
+            xpndstor = hugepg_alloc((size_t)xpndsize << SHIFT_MEGABYTE,
+                                    sysblk.xpndhuge, &back, &alloclen);
+
+        /* Otherwise obtain expanded storage, with room to adjust to
+         * a megabyte boundary
+         */
+        if (xpndstor == NULL)
+            xpndstor = storage_alloc((size_t)xpndsize << SHIFT_MEGABYTE,
+                                     ONE_MEGABYTE, &alloclen);
 
         if (mfree)
             free(mfree);
 
         if (xpndstor == NULL)
         {
-            char buf[64];
+            char buf[160];              /* fmt_memsize buffer is 128 */
             sysblk.xpnd_clear = 0;
             MSGBUF( buf, "configure_xstorage(%s)",
                     fmt_memsize_MB((U64)xpndsize));
@@ -379,12 +868,21 @@ int  cpu;
          * storage pointers and adjust new storage to megabyte boundary.
          */
         dofree = config_allocxaddr,
+        dofreelen = config_allocxlen,
         config_allocxsize = xpndsize,
         config_allocxaddr = xpndstor,
-        sysblk.xpnd_clear = 1,
-        xpndstor = (BYTE*)(((U64)xpndstor + (ONE_MEGABYTE - 1)) &
-                           ~((U64)ONE_MEGABYTE - 1)),
+        config_allocxlen = alloclen,
+        config_allocxhuge = sysblk.xpndhuge,
+        sysblk.xpndback = back,
+        sysblk.xpnd_clear = 1;
+        if (back == HUGEPG_NONE)
+            xpndstor = (BYTE*)(((U64)xpndstor + (ONE_MEGABYTE - 1)) &
+                               ~((U64)ONE_MEGABYTE - 1));
+        else
+            xpndstor = (BYTE*)(((U64)xpndstor + (HUGEPG_ALIGN - 1)) &
+                               ~((U64)HUGEPG_ALIGN - 1));
         sysblk.xpndstor = xpndstor;
+        hugepg_report("Expanded", sysblk.xpndhuge, back);
     }
     else
     {
@@ -407,7 +905,7 @@ int  cpu;
      */
 
     if (dofree)
-        free(dofree);
+        storage_free(dofree, dofreelen);
 
     /* Initial power-on reset for expanded storage */
     xstorage_clear();
@@ -595,7 +1093,7 @@ DEVBLK**dvpp;
 
         /* Initialize the device lock and conditions */
 
-        initialize_lock      ( &dev->lock               );
+        initialize_adaptive_lock( &dev->lock            );
         initialize_condition ( &dev->kbcond             );
 #if defined( OPTION_SHARED_DEVICES )
         initialize_condition ( &dev->shiocond           );
@@ -991,6 +1489,74 @@ int configure_srv_priority(int prio)
     return 0;
 }
 
+/*-------------------------------------------------------------------*/
+/* Host CPU list that applies to an emulated CPU's thread            */
+/*-------------------------------------------------------------------*/
+static const char *cpu_affinity_list(int cpu)
+{
+    return sysblk.cpuaffinity[cpu] ? sysblk.cpuaffinity[cpu]
+                                   : sysblk.affinity[AFFINITY_CPU];
+}
+
+/*-------------------------------------------------------------------*/
+/* Set the host CPU list of a class of threads, or of a single CPU   */
+/* thread if cpu >= 0, and apply it to the CPU and timer threads now */
+/* running.  Other threads pick it up as they start.  A NULL list    */
+/* lets the threads run on any host CPU again.                       */
+/*-------------------------------------------------------------------*/
+int configure_affinity(int aclass, int cpu, const char *cpulist)
+{
+char **pp;
+int    i;
+
+    pp = (aclass == AFFINITY_CPU && cpu >= 0) ? &sysblk.cpuaffinity[cpu]
+                                              : &sysblk.affinity[aclass];
+    free(*pp);
+    *pp = cpulist ? strdup(cpulist) : NULL;
+
+    switch (aclass)
+    {
+    case AFFINITY_CPU:
+        for (i = 0; i < MAX_CPU_ENGINES; i++)
+            if ((cpu < 0 || cpu == i) && sysblk.cputid[i])
+                set_thread_affinity(sysblk.cputid[i], cpu_affinity_list(i));
+        break;
+    case AFFINITY_TOD:
+        if (sysblk.todtid)
+            set_thread_affinity(sysblk.todtid, sysblk.affinity[AFFINITY_TOD]);
+        break;
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Restrict the calling thread to the host CPUs of its class         */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT void apply_thread_affinity(int aclass, int cpu)
+{
+const char *cpulist;
+
+    cpulist = (aclass == AFFINITY_CPU && cpu >= 0) ? cpu_affinity_list(cpu)
+                                                   : sysblk.affinity[aclass];
+    if (cpulist)
+        set_thread_affinity(0, cpulist);
+}
+
+/*-------------------------------------------------------------------*/
+/* Set the NUMA placement of main storage and apply it to storage    */
+/* already allocated.  Returns 0 or an errno value.                  */
+/*-------------------------------------------------------------------*/
+int configure_numa(int policy, const char *nodes)
+{
+    free(sysblk.numanodes);
+    sysblk.numanodes = nodes ? strdup(nodes) : NULL;
+    sysblk.numapolicy = policy;
+
+    if (!config_allocmaddr)
+        return 0;
+    return numa_place_storage(sysblk.storkeys, config_allocmsize << 12);
+}
+
 /*-------------------------------------------------------------------*/
 /* Function to start a new CPU thread                                */
 /* Caller MUST own the intlock                                       */
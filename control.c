@@ -740,15 +740,17 @@ U32     old;                            /* old value                 */
 
     if (regs->psw.cc == 0)
     {
+        CS_BACKOFF_RESET(regs);
+
         /* Perform requested funtion specified as per request code in r2 */
         if (regs->GR_L(r2) & 3)
         {
             OBTAIN_INTLOCK(regs);
-            SYNCHRONIZE_CPUS(regs);
             if (regs->GR_L(r2) & 1)
-                ARCH_DEP(purge_tlb_all)();
+                ARCH_DEP(purge_tlb_all)(regs);
             if (regs->GR_L(r2) & 2)
-                ARCH_DEP(purge_alb_all)();
+                ARCH_DEP(purge_alb_all)(regs);
+            ARCH_DEP(purge_wait)(regs);
             RELEASE_INTLOCK(regs);
         }
     }
@@ -756,10 +758,9 @@ U32     old;                            /* old value                 */
     {
         PTT_CSF("*CSP",regs->GR_L(r1),regs->GR_L(r2),regs->psw.IA_L);
 
-        /* Otherwise yield */
+        /* Otherwise back off */
         regs->GR_L(r1) = CSWAP32(old);
-        if (sysblk.cpus > 1)
-            sched_yield();
+        CS_BACKOFF(regs);
     }
 
     /* Perform serialization after completing operation */
@@ -1539,7 +1540,6 @@ int     op3;
     /* Perform serialization before operation */
     PERFORM_SERIALIZATION (regs);
     OBTAIN_INTLOCK(regs);
-    SYNCHRONIZE_CPUS(regs);
 
 #if defined(_FEATURE_SIE)
     if(SIE_MODE(regs) && regs->sie_scao)
@@ -1564,6 +1564,9 @@ int     op3;
     /* Invalidate page table entry */
     ARCH_DEP(invalidate_pte) (inst[1], op1, op2, regs);
 
+    /* Wait for the other CPUs to purge their TLB entries */
+    ARCH_DEP(purge_wait) (regs);
+
 #if defined(_FEATURE_SIE)
     if(SIE_MODE(regs) && regs->sie_scao)
     {
@@ -3382,6 +3385,8 @@ int     rc;                             /* return code from load_psw */
 
     /* Now INVALIDATE ALL TLB ENTRIES in our working copy.. */
     memset( &newregs.tlb.vaddr, 0, TLBN * sizeof(DW) );
+    memset( &newregs.tlb.lvaddr, 0, TLB_LARGEN * sizeof(DW) );
+    TLB_RMAP_RESET( &newregs.tlb );
     newregs.tlbID = 1;
 
     /* Set the breaking event address register in the copy */
@@ -4579,7 +4584,7 @@ U64     dreg;                           /* Clock value               */
 
     dreg >>= 8;
 
-    OBTAIN_INTLOCK(regs);
+    OBTAIN_CPULOCK(regs);
 
     regs->clkc = dreg;
 
@@ -4590,7 +4595,7 @@ U64     dreg;                           /* Clock value               */
     else
         OFF_IC_CLKC(regs);
 
-    RELEASE_INTLOCK(regs);
+    RELEASE_CPULOCK(regs);
 
     RETURN_INTCHECK(regs);
 }
@@ -4641,7 +4646,7 @@ S64     dreg;                           /* Timer value               */
     /* Fetch the CPU timer value from operand location */
     dreg = ARCH_DEP(vfetch8) ( effective_addr2, b2, regs );
 
-    OBTAIN_INTLOCK(regs);
+    OBTAIN_CPULOCK(regs);
 
     set_cpu_timer(regs, dreg);
 
@@ -4651,7 +4656,7 @@ S64     dreg;                           /* Timer value               */
     else
         OFF_IC_PTIMER(regs);
 
-    RELEASE_INTLOCK(regs);
+    RELEASE_CPULOCK(regs);
 
 //  /*debug*/logmsg("Set CPU timer=%16.16"PRIX64"\n", dreg);
 
@@ -5539,6 +5544,7 @@ int     cpu;                            /* cpu number                */
 int     set_arch = 0;                   /* Need to switch mode       */
 #endif /*defined(_900) || defined(FEATURE_ESAME)*/
 size_t  log_sigp = 0;                   /* Log SIGP instruction flag */
+int     cpulocked;                      /* 1=Serialized by cpulock   */
 char    log_buf[128];                   /* Log buffer                */
 static char *ordername[] = {
     /* 0x00                          */  "Unassigned",
@@ -5620,20 +5626,37 @@ static char *ordername[] = {
                 parm);
     }
 
-    /* [4.9.2.1] Claim the use of the CPU signaling and response
-       facility, and return condition code 2 if the facility is
-       busy.  The sigplock is held while the facility is in
-       use by any CPU. */
-    if(try_obtain_lock (&sysblk.sigplock))
+    /* Sense, external call and emergency signal only examine or
+       post interrupt state of the target CPU.  They are serialized
+       by the target's cpulock instead of the signalling facility
+       and the interrupt lock, so that CPUs may signal each other
+       concurrently. */
+    cpulocked = (order == SIGP_SENSE
+              || order == SIGP_EXTCALL
+#if defined(_900) || defined(FEATURE_ESAME)
+              || order == SIGP_COND_EMERGENCY
+#endif /* defined(_900) || defined(FEATURE_ESAME) */
+              || order == SIGP_EMERGENCY);
+
+    if (cpulocked)
+        obtain_lock(&sysblk.cpulock[cpad]);
+    else
     {
-        regs->psw.cc = 2;
-        if (log_sigp)
-            WRMSG(HHC00814, "I", log_buf, 2, "");
-        return;
-    }
+        /* [4.9.2.1] Claim the use of the CPU signaling and response
+           facility, and return condition code 2 if the facility is
+           busy.  The sigplock is held while the facility is in
+           use by any CPU. */
+        if(try_obtain_lock (&sysblk.sigplock))
+        {
+            regs->psw.cc = 2;
+            if (log_sigp)
+                WRMSG(HHC00814, "I", log_buf, 2, "");
+            return;
+        }
 
-    /* Obtain the interrupt lock */
-    OBTAIN_INTLOCK(regs);
+        /* Obtain the interrupt lock */
+        OBTAIN_INTLOCK(regs);
+    }
 
     /* If the cpu is not part of the configuration then return cc3
        Initial CPU reset may IML a processor that is currently not
@@ -5645,8 +5668,13 @@ static char *ordername[] = {
 #endif /*defined(FEATURE_S370_CHANNEL)*/
        && !IS_CPU_ONLINE(cpad))
     {
-        RELEASE_INTLOCK(regs);
-        release_lock(&sysblk.sigplock);
+        if (cpulocked)
+            release_lock(&sysblk.cpulock[cpad]);
+        else
+        {
+            RELEASE_INTLOCK(regs);
+            release_lock(&sysblk.sigplock);
+        }
         regs->psw.cc = 3;
         if (log_sigp)
             WRMSG(HHC00814, "I", log_buf, 3, "");
@@ -5668,8 +5696,13 @@ static char *ordername[] = {
        && (tregs) && (tregs->cpustate == CPUSTATE_STOPPING
         || IS_IC_RESTART(tregs)))
     {
-        RELEASE_INTLOCK(regs);
-        release_lock(&sysblk.sigplock);
+        if (cpulocked)
+            release_lock(&sysblk.cpulock[cpad]);
+        else
+        {
+            RELEASE_INTLOCK(regs);
+            release_lock(&sysblk.sigplock);
+        }
         regs->psw.cc = 2;
         if (log_sigp)
             WRMSG(HHC00814, "I", log_buf, 2, "");
@@ -5732,8 +5765,8 @@ static char *ordername[] = {
             }
 
             /* Raise an external call interrupt pending condition */
-            ON_IC_EXTCALL(tregs);
             tregs->extccpu = regs->cpuad;
+            ON_IC_EXTCALL(tregs);
 
             break;
 
@@ -5792,8 +5825,8 @@ static char *ordername[] = {
             }
 
             /* Raise an emergency signal interrupt pending condition */
-            ON_IC_EMERSIG(tregs);
             tregs->emercpu[regs->cpuad] = 1;
+            ON_IC_EMERSIG(tregs);
 
             break;
 
@@ -6214,15 +6247,26 @@ static char *ordername[] = {
             status = SIGP_STATUS_INVALID_ORDER;
         } /* end switch(order) */
 
-    /* Release the use of the signalling and response facility */
-    release_lock(&sysblk.sigplock);
+    if (cpulocked)
+    {
+        /* Wake up the target CPU if an interrupt was posted */
+        if (order != SIGP_SENSE && status == 0)
+            wakeup_posted_cpu(tregs);
+
+        release_lock(&sysblk.cpulock[cpad]);
+    }
+    else
+    {
+        /* Release the use of the signalling and response facility */
+        release_lock(&sysblk.sigplock);
 
-    /* Wake up the target CPU */
-    if (IS_CPU_ONLINE(cpad))
-        WAKEUP_CPU (sysblk.regs[cpad]);
+        /* Wake up the target CPU */
+        if (IS_CPU_ONLINE(cpad))
+            WAKEUP_CPU (sysblk.regs[cpad]);
 
-    /* Release the interrupt lock */
-    RELEASE_INTLOCK(regs);
+        /* Release the interrupt lock */
+        RELEASE_INTLOCK(regs);
+    }
 
     if(status)
         PTT_ERR("*SIGP",parm,cpad,order);
@@ -6286,8 +6330,8 @@ U64     dreg;                           /* Clock value               */
         longjmp(regs->progjmp, SIE_INTERCEPT_INST);
 #endif /*defined(_FEATURE_SIE)*/
 
-    /* Obtain the interrupt lock */
-    OBTAIN_INTLOCK(regs);
+    /* Obtain the CPU lock */
+    OBTAIN_CPULOCK(regs);
 
     /* Save clock comparator value */
     dreg = regs->clkc;
@@ -6303,7 +6347,7 @@ U64     dreg;                           /* Clock value               */
            and we are enabled for such interrupts *JJ */
         if( OPEN_IC_CLKC(regs) )
         {
-            RELEASE_INTLOCK(regs);
+            RELEASE_CPULOCK(regs);
             UPD_PSW_IA(regs, PSW_IA(regs, -4));
             RETURN_INTCHECK(regs);
         }
@@ -6311,7 +6355,7 @@ U64     dreg;                           /* Clock value               */
     else
         OFF_IC_CLKC(regs);
 
-    RELEASE_INTLOCK(regs);
+    RELEASE_CPULOCK(regs);
 
     /* Store clock comparator value at operand location */
     ARCH_DEP(vstore8) ((dreg << 8), effective_addr2, b2, regs );
@@ -6442,7 +6486,7 @@ S64     dreg;                           /* Double word workarea      */
         longjmp(regs->progjmp, SIE_INTERCEPT_INST);
 #endif /*defined(_FEATURE_SIE)*/
 
-    OBTAIN_INTLOCK(regs);
+    OBTAIN_CPULOCK(regs);
 
     /* Save the CPU timer value */
     dreg = cpu_timer(regs);
@@ -6457,7 +6501,7 @@ S64     dreg;                           /* Double word workarea      */
            and we are enabled for such interrupts *JJ */
         if( OPEN_IC_PTIMER(regs) )
         {
-            RELEASE_INTLOCK(regs);
+            RELEASE_CPULOCK(regs);
             UPD_PSW_IA(regs, PSW_IA(regs, -4));
             RETURN_INTCHECK(regs);
         }
@@ -6465,7 +6509,7 @@ S64     dreg;                           /* Double word workarea      */
     else
         OFF_IC_PTIMER(regs);
 
-    RELEASE_INTLOCK(regs);
+    RELEASE_CPULOCK(regs);
 
     /* Store CPU timer value at operand location */
     ARCH_DEP(vstore8) ( dreg, effective_addr2, b2, regs );
@@ -426,6 +426,7 @@ static char *pgmintname[] = {
         RELEASE_INTLOCK(realregs);
     if (sysblk.mainowner == realregs->cpuad)
         RELEASE_MAINLOCK(realregs);
+    RELEASE_PLOLOCKS(realregs);
 
     /* Ensure psw.IA is set and aia invalidated */
     INVALIDATE_AIA(realregs);
@@ -468,9 +469,10 @@ static char *pgmintname[] = {
         realregs->guestregs->execflag = 0;
 #endif /*defined(FEATURE_INTERPRETIVE_EXECUTION)*/
 
-    /* Unlock the main storage lock if held */
+    /* Unlock the main storage and PLO locks if held */
     if (realregs->cpuad == sysblk.mainowner)
         RELEASE_MAINLOCK(realregs);
+    RELEASE_PLOLOCKS(realregs);
 
     /* Remove PER indication from program interrupt code
        such that interrupt code specific tests may be done.
@@ -1224,6 +1226,79 @@ RADR    fsta;                           /* Failing storage address   */
 
 #if !defined(_GEN_ARCH)
 
+#if defined(OPTION_BLOCK_DISPATCH)
+/*-------------------------------------------------------------------*/
+/* Basic block class of each first z/Architecture opcode byte        */
+/*                                                                   */
+/* Only unprivileged general instructions are built into blocks.     */
+/* Branches end a block; storing instructions cause the rest of the  */
+/* block to be rechecked for modification after they execute.        */
+/*-------------------------------------------------------------------*/
+#define BB_NONE         0               /* Not part of a block       */
+#define BB_INST         1               /* Straight line instruction */
+#define BB_STORE        2               /* ...which stores           */
+#define BB_END          3               /* Branch; ends the block    */
+#define BB_SUB          4               /* Classified by 2nd opcode  */
+
+static const BYTE bbclass[256] = {
+ [0x05] = BB_END,   [0x06] = BB_END,   [0x07] = BB_END,   [0x0D] = BB_END,
+ [0x10] = BB_INST,  [0x11] = BB_INST,  [0x12] = BB_INST,  [0x13] = BB_INST,
+ [0x14] = BB_INST,  [0x15] = BB_INST,  [0x16] = BB_INST,  [0x17] = BB_INST,
+ [0x18] = BB_INST,  [0x19] = BB_INST,  [0x1A] = BB_INST,  [0x1B] = BB_INST,
+ [0x1C] = BB_INST,  [0x1D] = BB_INST,  [0x1E] = BB_INST,  [0x1F] = BB_INST,
+ [0x40] = BB_STORE, [0x41] = BB_INST,  [0x42] = BB_STORE, [0x43] = BB_INST,
+ [0x45] = BB_END,   [0x46] = BB_END,   [0x47] = BB_END,   [0x48] = BB_INST,
+ [0x49] = BB_INST,  [0x4A] = BB_INST,  [0x4B] = BB_INST,  [0x4C] = BB_INST,
+ [0x4D] = BB_END,   [0x4E] = BB_STORE, [0x4F] = BB_INST,  [0x50] = BB_STORE,
+ [0x54] = BB_INST,  [0x55] = BB_INST,  [0x56] = BB_INST,  [0x57] = BB_INST,
+ [0x58] = BB_INST,  [0x59] = BB_INST,  [0x5A] = BB_INST,  [0x5B] = BB_INST,
+ [0x5C] = BB_INST,  [0x5D] = BB_INST,  [0x5E] = BB_INST,  [0x5F] = BB_INST,
+ [0x71] = BB_INST,  [0x86] = BB_END,   [0x87] = BB_END,   [0x88] = BB_INST,
+ [0x89] = BB_INST,  [0x8A] = BB_INST,  [0x8B] = BB_INST,  [0x8C] = BB_INST,
+ [0x8D] = BB_INST,  [0x8E] = BB_INST,  [0x8F] = BB_INST,  [0x90] = BB_STORE,
+ [0x91] = BB_INST,  [0x92] = BB_STORE, [0x94] = BB_STORE, [0x95] = BB_INST,
+ [0x96] = BB_STORE, [0x97] = BB_STORE, [0x98] = BB_INST,  [0xA7] = BB_SUB,
+ [0xB9] = BB_SUB,   [0xC0] = BB_SUB,   [0xD2] = BB_STORE, [0xD4] = BB_STORE,
+ [0xD5] = BB_INST,  [0xD6] = BB_STORE, [0xD7] = BB_STORE, [0xDC] = BB_STORE,
+ [0xE3] = BB_SUB,   [0xF2] = BB_STORE, [0xF3] = BB_STORE };
+
+static BYTE bb_class(BYTE *ip)
+{
+BYTE    c = bbclass[ip[0]];
+
+    if (c != BB_SUB)
+        return c;
+
+    switch (ip[0]) {
+    case 0xA7:                          /* BRC BRAS BRCT BRCTG       */
+        c = ip[1] & 0x0F;
+        return (c >= 0x4 && c <= 0x7) ? BB_END : BB_INST;
+    case 0xC0:                          /* BRCL BRASL                */
+        c = ip[1] & 0x0F;
+        return (c == 0x4 || c == 0x5) ? BB_END : BB_INST;
+    case 0xB9:
+        switch (ip[1]) {
+        case 0x02: case 0x04: case 0x08: case 0x09: case 0x14:
+        case 0x16: case 0x20: case 0x21: case 0x80: case 0x81:
+        case 0x82:
+            return BB_INST;
+        }
+        return BB_NONE;
+    case 0xE3:
+        switch (ip[5]) {
+        case 0x02: case 0x04: case 0x08: case 0x09: case 0x0A:
+        case 0x0B: case 0x12: case 0x14: case 0x20: case 0x21:
+        case 0x58: case 0x71: case 0x80: case 0x81: case 0x82:
+            return BB_INST;
+        case 0x24: case 0x50:
+            return BB_STORE;
+        }
+        return BB_NONE;
+    }
+    return BB_NONE;
+}
+#endif /*defined(OPTION_BLOCK_DISPATCH)*/
+
 
 REGS *s370_run_cpu (int cpu, REGS *oldregs);
 REGS *s390_run_cpu (int cpu, REGS *oldregs);
@@ -1274,8 +1349,9 @@ int   rc;
         }
     }
 
-    /* Set CPU thread priority */
+    /* Set CPU thread priority and host CPU affinity */
     set_thread_priority(0, sysblk.cpuprio);
+    apply_thread_affinity(AFFINITY_CPU, cpu);
 
     /* Display thread started message on control panel */
     MSGBUF( cpustr, "Processor %s%02X", PTYPSTR( cpu ), cpu );
@@ -1321,6 +1397,35 @@ int i;
 
     obtain_lock (&sysblk.cpulock[cpu]);
 
+#if defined(OPTION_PREDECODE_CACHE)
+    /* Allocate the predecoded instruction cache; it is filled on
+       first use by instfetch since regs->pdc->oct is still NULL */
+    regs->pdc = calloc(1, sizeof(PDC));
+    if (regs->pdc == NULL)
+    {
+        char buf[40];
+        MSGBUF(buf, "calloc(%d)", (int)sizeof(PDC));
+        WRMSG (HHC00813, "E", PTYPSTR(cpu), cpu, buf, strerror(errno));
+        release_lock (&sysblk.cpulock[cpu]);
+        return -1;
+    }
+#endif /*defined(OPTION_PREDECODE_CACHE)*/
+
+#if defined(OPTION_BLOCK_DISPATCH)
+    /* Allocate the basic block cache */
+    regs->bbc = calloc(1, sizeof(BBC));
+    if (regs->bbc == NULL)
+    {
+        char buf[40];
+        MSGBUF(buf, "calloc(%d)", (int)sizeof(BBC));
+        WRMSG (HHC00813, "E", PTYPSTR(cpu), cpu, buf, strerror(errno));
+        free(regs->pdc);
+        regs->pdc = NULL;
+        release_lock (&sysblk.cpulock[cpu]);
+        return -1;
+    }
+#endif /*defined(OPTION_BLOCK_DISPATCH)*/
+
     /* initialize eye-catchers */
     memset(&regs->blknam,SPACE,sizeof(regs->blknam));
     memset(&regs->blkver,SPACE,sizeof(regs->blkver));
@@ -1459,6 +1564,19 @@ void *cpu_uninit (int cpu, REGS *regs)
         release_lock (&sysblk.cpulock[cpu]);
     }
 
+#if defined(OPTION_PREDECODE_CACHE)
+    /* Free the predecoded instruction cache */
+    free(regs->pdc);
+    regs->pdc = NULL;
+    regs->pdcpage = NULL;
+#endif /*defined(OPTION_PREDECODE_CACHE)*/
+
+#if defined(OPTION_BLOCK_DISPATCH)
+    /* Free the basic block cache */
+    free(regs->bbc);
+    regs->bbc = NULL;
+#endif /*defined(OPTION_BLOCK_DISPATCH)*/
+
     /* Free the REGS structure */
     free_aligned(regs);
 
@@ -1510,12 +1628,62 @@ CPU_Wait (REGS* regs)
         release_lock( &sysblk.scrlock );
     }
 
-    /* Wait for interrupt */
-    wait_condition (&regs->intcond, &sysblk.intlock);
+    /* Wait for interrupt.  The wakelock is obtained before intlock
+       is released so that a wakeup posted under intlock is not lost;
+       a wakeup posted while we were running merely ends the wait */
+    obtain_lock (&sysblk.wakelock[regs->cpuad]);
+    release_lock (&sysblk.intlock);
+    while (!sysblk.wakeset[regs->cpuad])
+        wait_condition (&sysblk.wakecond[regs->cpuad],
+                        &sysblk.wakelock[regs->cpuad]);
+    sysblk.wakeset[regs->cpuad] = 0;
+    release_lock (&sysblk.wakelock[regs->cpuad]);
+    obtain_lock (&sysblk.intlock);
 
     /* And we're the owner of intlock once again */
     sysblk.intowner = regs->cpuad;
+
+    regs->wakeups++;
+    regs->woken = 1;
+}
+
+#if defined(OPTION_INSTRUCTION_COUNTING)
+/*-------------------------------------------------------------------*/
+/* Sample the host time taken by an instruction                      */
+/*                                                                   */
+/* Called by COUNT_INST every ICOUNT_SAMPLE instructions to start    */
+/* timing the instruction about to execute, and again when the next  */
+/* instruction starts to charge the elapsed time to it.  Samples     */
+/* which took longer than ICOUNT_MAXNS are discarded since they were */
+/* most likely interrupted by a wait or a host preemption.           */
+/*-------------------------------------------------------------------*/
+void icount_sample(REGS *regs, U64 *cnt)
+{
+struct timespec ts;                     /* Host monotonic time       */
+U64     now;                            /* Host nanoseconds          */
+int     slot;                           /* Instruction map slot      */
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = (U64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+    if (regs->icslot)
+    {
+        slot = regs->icslot - 1;
+        if (now - regs->icstart < ICOUNT_MAXNS)
+        {
+            ((U64 *)&regs->imapns)[slot] += now - regs->icstart;
+            ((U64 *)&regs->imapsmp)[slot]++;
+        }
+        regs->icslot = 0;
+        regs->icsample = ICOUNT_SAMPLE;
+        return;
+    }
+
+    regs->icslot = IMAP_SLOT(regs->imap, cnt) + 1;
+    regs->icstart = now;
+    regs->icsample = 1;
 }
+#endif /*defined(OPTION_INSTRUCTION_COUNTING)*/
 
 #endif /*!defined(_GEN_ARCH)*/
 
@@ -1541,6 +1709,10 @@ void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
     if (unlikely(regs->invalidate))
         ARCH_DEP(invalidate_tlbe)(regs, regs->invalidate_main);
 
+    /* Perform broadcast purges posted by other CPUs */
+    if (unlikely(regs->purgereq))
+        ARCH_DEP(perform_purge)(regs);
+
     /* Take interrupts if CPU is not stopped */
     if (likely(regs->cpustate == CPUSTATE_STARTED))
     {
@@ -1570,7 +1742,7 @@ void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
                 ARCH_DEP (perform_io_interrupt) (regs);
             }
             else
-                WAKEUP_CPU_MASK(sysblk.waiting_mask);
+                WAKEUP_IO_CPU();
         }
     } /*CPU_STARTED*/
 
@@ -1641,7 +1813,7 @@ cpustate_stopping:
         CPU_Wait(regs);
 
         sysblk.started_mask |= regs->cpubit;
-        regs->ints_state |= sysblk.ints_state;
+        IC_STATE_ON(regs, sysblk.ints_state);
         set_cpu_timer(regs,saved_timer);
 
         ON_IC_INTERRUPT(regs);
@@ -1665,6 +1837,13 @@ cpustate_stopping:
     {
         regs->waittod = host_tod();
 
+        /* Count a wakeup which found no interrupt to take */
+        if (regs->woken)
+        {
+            regs->rewaits++;
+            regs->woken = 0;
+        }
+
         /* Test for disabled wait PSW and issue message */
         if( IS_IC_DISABLED_WAIT_PSW(regs) )
         {
@@ -1677,9 +1856,13 @@ cpustate_stopping:
             longjmp(regs->progjmp, SIE_NO_INTERCEPT);
         }
 
-        /* Indicate waiting and invoke CPU wait */
+        /* Indicate waiting and invoke CPU wait, unless an external
+           interrupt was posted without intlock (wakeup_posted_cpu)
+           before the waiting bit became visible */
         sysblk.waiting_mask |= regs->cpubit;
-        CPU_Wait(regs);
+        HOST_MB();
+        if (!OPEN_IC_EXTPENDING(regs))
+            CPU_Wait(regs);
 
         /* Turn off the waiting bit .
          *
@@ -1703,12 +1886,527 @@ cpustate_stopping:
         longjmp(regs->progjmp, SIE_NO_INTERCEPT);
     } /* end if(wait) */
 
+    regs->woken = 0;
+
     /* Release the interrupt lock */
     RELEASE_INTLOCK(regs);
     return;
 
 } /* process_interrupt */
 
+#if defined(OPTION_BLOCK_DISPATCH) && __GEN_ARCH == 900
+/*-------------------------------------------------------------------*/
+/* Build the block starting at the current instruction address       */
+/*                                                                   */
+/* The block extends over eligible instructions until a branch, an   */
+/* ineligible instruction, the end of the AIA page or the block size */
+/* limits.  Blocks of fewer than two instructions are recorded as    */
+/* not buildable.  Returns the number of instructions.               */
+/*-------------------------------------------------------------------*/
+static int ARCH_DEP(bb_build) (REGS *regs, const zz_func *oct,
+                               BBLK *blk)
+{
+BYTE   *ip = regs->ip;                  /* Start of block            */
+PDCENT  pde;                            /* Decoded instruction       */
+int     n = 0;                          /* Instructions in block     */
+int     len = 0;                        /* Bytes in block            */
+int     lastoff = 0;                    /* Offset of last inst       */
+int     ilc;                            /* Instruction length        */
+BYTE    c;                              /* Block class               */
+U16     stmask = 0;                     /* Storing instructions      */
+
+    do {
+        if (ip + len >= regs->aie)
+            break;
+        c = bb_class(ip + len);
+        ilc = ILC(ip[len]);
+        if (c == BB_NONE || len + ilc > BB_MAXBYTES)
+            break;
+        ARCH_DEP(pdc_decode) (oct, ip + len, regs, &pde);
+        blk->func[n] = pde.func;
+        if (c == BB_STORE)
+            stmask |= 1 << n;
+        lastoff = len;
+        len += ilc;
+        n++;
+    } while (c != BB_END && n < BB_MAXINST);
+
+    if (n < 2)
+    {
+        /* Leave the first instruction in place so that the entry
+           is reconsidered only if it changes                        */
+        blk->heat = BB_NOBUILD;
+        return 0;
+    }
+
+    blk->ninst = n;
+    blk->nbytes = len;
+    blk->lastoff = lastoff;
+    blk->stmask = stmask;
+    memcpy(blk->src, ip, len);
+    regs->bbc->builds++;
+
+    return n;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Halve the heat of every block                                     */
+/*-------------------------------------------------------------------*/
+static void ARCH_DEP(bb_decay) (BBC *bbc)
+{
+int     i;                              /* Block index               */
+
+    bbc->ticks = 0;
+    for (i = 0; i < BB_BLOCKS; i++)
+        if (bbc->blk[i].heat != BB_NOBUILD)
+            bbc->blk[i].heat >>= 1;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Execute instructions using basic blocks                           */
+/*                                                                   */
+/* Runs at least `count' instructions (or until the AIA page is      */
+/* left), executing built blocks where available and single          */
+/* instructions otherwise.  Each entry at an address heats its slot, */
+/* and a block is built once the slot is hot.  A slot held by another*/
+/* address is cooled down before it is taken over, and all slots     */
+/* cool down every BB_DECAY entries.                                 */
+/* A block is checked once on entry against the AIA and its          */
+/* instruction bytes; within the block only the instruction address  */
+/* is checked, to detect a taken branch or an interruption, and      */
+/* after a storing instruction the remainder of the block is checked */
+/* for modification.                                                 */
+/*                                                                   */
+/* Returns the number of instructions executed.                      */
+/*-------------------------------------------------------------------*/
+static int ARCH_DEP(bb_run) (REGS *regs, const zz_func *oct, int count)
+{
+BBC    *bbc = regs->bbc;                /* Block cache               */
+BBLK   *blk;                            /* Basic block               */
+BYTE   *ip;                             /* Instruction pointer       */
+BYTE   *next;                           /* Expected next instruction */
+int     n = 0;                          /* Instructions executed     */
+int     i;                              /* Block instruction index   */
+int     off;                            /* Offset into block         */
+
+    while (n < count && regs->ip < regs->aie)
+    {
+        ip = regs->ip;
+        blk = &bbc->blk[BB_HASH(ip)];
+
+        if (unlikely(++bbc->ticks >= BB_DECAY))
+            ARCH_DEP(bb_decay) (bbc);
+
+        if (unlikely(blk->ip != ip || blk->oct != oct
+                  || blk->gen != sysblk.pdcgen
+                  || memcmp(blk->src, ip, blk->nbytes) != 0))
+        {
+            if (blk->ip != ip && blk->heat && blk->heat != BB_NOBUILD)
+            {
+                /* Cool down the slot of the other address */
+                blk->heat >>= 1;
+                PDC_EXECUTE(oct, ip, regs);
+                n++;
+                continue;
+            }
+            if (blk->ip == ip && blk->ninst)
+                bbc->stale++;
+
+            /* Take over the slot, remembering the first instruction */
+            blk->ip = ip;
+            blk->oct = oct;
+            blk->gen = sysblk.pdcgen;
+            blk->ninst = 0;
+            blk->nbytes = ILC(ip[0]);
+            blk->heat = 0;
+            memcpy(blk->src, ip, blk->nbytes);
+        }
+
+        if (blk->heat < BB_MAXHEAT)
+            blk->heat++;
+
+        if (!blk->ninst
+         && (blk->heat < BB_HOT || blk->heat == BB_NOBUILD
+          || !ARCH_DEP(bb_build) (regs, oct, blk)))
+        {
+            PDC_EXECUTE(oct, ip, regs);
+            n++;
+            continue;
+        }
+
+        /* Single AIA bounds check for the whole block */
+        if (unlikely(ip + blk->lastoff >= regs->aie))
+        {
+            PDC_EXECUTE(oct, ip, regs);
+            n++;
+            continue;
+        }
+
+        bbc->execs++;
+        for (i = 0; ; )
+        {
+            next = ip + ILC(ip[0]);
+            FOOTPRINT(ip, regs);
+            COUNT_INST(ip, regs);
+            blk->func[i](ip, regs);
+            if (++i >= blk->ninst)
+                break;
+            if (unlikely(regs->ip != next || regs->aie == NULL))
+            {
+                bbc->exits++;
+                break;
+            }
+            if (unlikely(blk->stmask & (1 << (i - 1))))
+            {
+                off = (int)(next - blk->ip);
+                if (memcmp(next, blk->src + off, blk->nbytes - off) != 0)
+                {
+                    bbc->stale++;
+                    break;
+                }
+            }
+            ip = next;
+        }
+        n += i;
+        bbc->insts += i;
+    }
+
+    return n;
+}
+#endif /*defined(OPTION_BLOCK_DISPATCH) && __GEN_ARCH == 900*/
+
+
+#if defined(OPTION_THREADED_DISPATCH)
+/*-------------------------------------------------------------------*/
+/* Threaded instruction dispatch                                     */
+/*                                                                   */
+/* Executes at most `count' instructions from the current AIA page,  */
+/* stopping as soon as the instruction address leaves the page or    */
+/* the AIA is invalidated, exactly like UNROLLED_EXECUTE.  The most  */
+/* frequently executed instructions are executed inline and every    */
+/* handler ends with its own indirect jump to the next one, so the   */
+/* host branch predictor sees one dispatch site per opcode instead   */
+/* of a single shared indirect call.  Everything else, and any case  */
+/* the inline code does not handle (overflow, out of page branches,  */
+/* serialization), is passed to the handler in the opcode table.     */
+/* Program checks longjmp out of here just as they do from the       */
+/* unrolled loop.                                                    */
+/*                                                                   */
+/* Unless fusion is disabled, common pairs (compare or LTR followed  */
+/* by BRC or BC, L followed by ST, LA followed by BRCT and ICM       */
+/* followed by BRC) are executed as one unit: the second instruction */
+/* is recognised while the first completes and is entered directly,  */
+/* without going back through the dispatcher.  Each instruction      */
+/* still updates the instruction address before the next one starts */
+/* so interruptions remain precise, and PER never reaches this code  */
+/* since it keeps the AIA invalid.                                   */
+/*                                                                   */
+/* Returns the number of instructions executed.                      */
+/*-------------------------------------------------------------------*/
+static int ARCH_DEP(threaded_execute) (REGS *regs, const zz_func *oct,
+                                       int count)
+{
+static const void *const label[] = {
+        &&op_generic,
+        &&op_07, &&op_12, &&op_15, &&op_18, &&op_19, &&op_1A,
+        &&op_1B, &&op_41, &&op_47, &&op_50, &&op_58, &&op_59,
+        &&op_A7, &&op_BF };
+static const BYTE opclass[256] = {
+        [0x07] =  1, [0x12] =  2, [0x15] =  3, [0x18] =  4,
+        [0x19] =  5, [0x1A] =  6, [0x1B] =  7, [0x41] =  8,
+        [0x47] =  9, [0x50] = 10, [0x58] = 11, [0x59] = 12,
+#if defined(FEATURE_IMMEDIATE_AND_RELATIVE)
+        [0xA7] = 13,
+#endif /*defined(FEATURE_IMMEDIATE_AND_RELATIVE)*/
+        [0xBF] = 14 };
+const BYTE *noinl;                      /* Replaced opcode map       */
+BYTE   *ip;                             /* Instruction pointer       */
+int     n = 0;                          /* Instructions executed     */
+int     fuse;                           /* 1=Pair fusion enabled     */
+int     r1, r2;                         /* Values of R fields        */
+int     b2;                             /* Base of effective addr    */
+VADR    effective_addr2;                /* Effective address         */
+S64     result;                         /* Arithmetic result         */
+S32     offset;                         /* Relative branch offset    */
+U32     n2;                             /* Storage operand           */
+#if defined(OPTION_PREDECODE_CACHE)
+PDCENT *pde;                            /* Predecode cache entry     */
+#endif
+
+#define THREAD_NEXT() \
+do { \
+    if (unlikely(regs->ip >= regs->aie) || unlikely(n >= count)) \
+        goto done; \
+    ip = regs->ip; \
+    n++; \
+    goto *label[noinl[ip[0]] ? 0 : opclass[ip[0]]]; \
+} while (0)
+
+#if defined(OPTION_PREDECODE_CACHE)
+#define THREAD_CALL() \
+do { \
+    pde = &regs->pdcpage->ent[((uintptr_t)ip & PDC_BYTEMASK) >> 1]; \
+    if (unlikely(pde->hw != fetch_hw(ip) || (pde->ex5 && pde->b5 != ip[5]))) \
+        ARCH_DEP(pdc_decode) (oct, ip, regs, pde); \
+    pde->func(ip, regs); \
+} while (0)
+#else
+#define THREAD_CALL() \
+    oct[fetch_hw(ip)](ip, regs)
+#endif
+
+/* Enter the handler for the next instruction directly if _cond */
+#define THREAD_FUSE(_cond, _label, _pair) \
+do { \
+    if (fuse && likely(regs->ip < regs->aie) && likely(n < count) \
+     && (_cond) && !noinl[regs->ip[0]]) \
+    { \
+        ip = regs->ip; \
+        n++; \
+        regs->fusecnt[(_pair)]++; \
+        goto _label; \
+    } \
+} while (0)
+
+#if defined(FEATURE_IMMEDIATE_AND_RELATIVE)
+#define NEXT_IS_BRC  (regs->ip[0] == 0xA7 && (regs->ip[1] & 0x0F) == 0x4)
+#define NEXT_IS_BRCT (regs->ip[0] == 0xA7 && (regs->ip[1] & 0x0F) == 0x6)
+#else
+#define NEXT_IS_BRC  0
+#define NEXT_IS_BRCT 0
+#endif
+#define NEXT_IS_BC   (regs->ip[0] == 0x47)
+#define NEXT_IS_ST   (regs->ip[0] == 0x50)
+
+#define THREAD_RELATIVE_BRANCH(_offset) \
+do { \
+    if (unlikely(regs->permode || regs->execflag) \
+     || ip + (_offset) < regs->aip || ip + (_offset) >= regs->aie) \
+        goto op_call; \
+    UPDATE_BEAR(regs, 0); \
+    regs->ip = ip + (_offset); \
+} while (0)
+
+#define THREAD_BRANCH(_newia) \
+do { \
+    if (unlikely(regs->permode || regs->execflag) \
+     || ((_newia) & (PAGEFRAME_PAGEMASK|0x01)) != regs->AIV) \
+        goto op_call; \
+    UPDATE_BEAR(regs, 0); \
+    regs->ip = (BYTE *)((uintptr_t)regs->aim ^ (uintptr_t)(_newia)); \
+} while (0)
+
+    noinl = sysblk.thrdrepl[regs->arch_mode];
+    fuse = !sysblk.nofusion;
+
+    THREAD_NEXT();
+
+op_generic:
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+op_call:
+    THREAD_CALL();
+    THREAD_NEXT();
+
+op_07:  /* BCR - Branch on Condition Register                        */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    if ((ip[1] & 0x0F) != 0 && (ip[1] & (0x80 >> regs->psw.cc)))
+    {
+        effective_addr2 = regs->GR(ip[1] & 0x0F) & ADDRESS_MAXWRAP(regs);
+        THREAD_BRANCH(effective_addr2);
+    }
+    else if (ip[1] == 0xF0 || ip[1] == 0xE0)
+        goto op_call;
+    else
+        INST_UPDATE_PSW(regs, 2, 0);
+    THREAD_NEXT();
+
+op_12:  /* LTR - Load and Test Register                              */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RR0(ip, regs, r1, r2);
+    regs->GR_L(r1) = regs->GR_L(r2);
+    regs->psw.cc = (S32)regs->GR_L(r1) < 0 ? 1 :
+                   (S32)regs->GR_L(r1) > 0 ? 2 : 0;
+    THREAD_FUSE(NEXT_IS_BRC, op_brc, FUSE_LTR_BRC);
+    THREAD_NEXT();
+
+op_15:  /* CLR - Compare Logical Register                            */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RR0(ip, regs, r1, r2);
+    regs->psw.cc = regs->GR_L(r1) < regs->GR_L(r2) ? 1 :
+                   regs->GR_L(r1) > regs->GR_L(r2) ? 2 : 0;
+    THREAD_FUSE(NEXT_IS_BRC, op_brc, FUSE_COMPARE_BRC);
+    THREAD_FUSE(NEXT_IS_BC, op_47, FUSE_COMPARE_BC);
+    THREAD_NEXT();
+
+op_18:  /* LR - Load Register                                        */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RR0(ip, regs, r1, r2);
+    regs->GR_L(r1) = regs->GR_L(r2);
+    THREAD_NEXT();
+
+op_19:  /* CR - Compare Register                                     */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RR0(ip, regs, r1, r2);
+    regs->psw.cc = (S32)regs->GR_L(r1) < (S32)regs->GR_L(r2) ? 1 :
+                   (S32)regs->GR_L(r1) > (S32)regs->GR_L(r2) ? 2 : 0;
+    THREAD_FUSE(NEXT_IS_BRC, op_brc, FUSE_COMPARE_BRC);
+    THREAD_FUSE(NEXT_IS_BC, op_47, FUSE_COMPARE_BC);
+    THREAD_NEXT();
+
+op_1A:  /* AR - Add Register                                         */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    result = (S64)(S32)regs->GR_L(ip[1] >> 4)
+           + (S64)(S32)regs->GR_L(ip[1] & 0x0F);
+    if (unlikely(result != (S32)result))
+        goto op_call;
+    RR(ip, regs, r1, r2);
+    regs->GR_L(r1) = (U32)result;
+    regs->psw.cc = result < 0 ? 1 : result > 0 ? 2 : 0;
+    THREAD_NEXT();
+
+op_1B:  /* SR - Subtract Register                                    */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    result = (S64)(S32)regs->GR_L(ip[1] >> 4)
+           - (S64)(S32)regs->GR_L(ip[1] & 0x0F);
+    if (unlikely(result != (S32)result))
+        goto op_call;
+    RR(ip, regs, r1, r2);
+    regs->GR_L(r1) = (U32)result;
+    regs->psw.cc = result < 0 ? 1 : result > 0 ? 2 : 0;
+    THREAD_NEXT();
+
+op_41:  /* LA - Load Address                                         */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RX0(ip, regs, r1, b2, effective_addr2);
+    SET_GR_A(r1, regs, effective_addr2);
+    THREAD_FUSE(NEXT_IS_BRCT, op_brct, FUSE_LA_BRCT);
+    THREAD_NEXT();
+
+op_47:  /* BC - Branch on Condition                                  */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    if ((0x80 >> regs->psw.cc) & ip[1])
+    {
+        RX_BC(ip, regs, b2, effective_addr2);
+        effective_addr2 &= ADDRESS_MAXWRAP(regs);
+        THREAD_BRANCH(effective_addr2);
+    }
+    else
+        INST_UPDATE_PSW(regs, 4, 0);
+    THREAD_NEXT();
+
+op_50:  /* ST - Store                                                */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RX(ip, regs, r1, b2, effective_addr2);
+    ARCH_DEP(vstore4) (regs->GR_L(r1), effective_addr2, b2, regs);
+    THREAD_NEXT();
+
+op_58:  /* L - Load                                                  */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RX(ip, regs, r1, b2, effective_addr2);
+    regs->GR_L(r1) = ARCH_DEP(vfetch4) (effective_addr2, b2, regs);
+    THREAD_FUSE(NEXT_IS_ST, op_50, FUSE_L_ST);
+    THREAD_NEXT();
+
+op_59:  /* C - Compare                                               */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    RX(ip, regs, r1, b2, effective_addr2);
+    n2 = ARCH_DEP(vfetch4) (effective_addr2, b2, regs);
+    regs->psw.cc = (S32)regs->GR_L(r1) < (S32)n2 ? 1 :
+                   (S32)regs->GR_L(r1) > (S32)n2 ? 2 : 0;
+    THREAD_FUSE(NEXT_IS_BRC, op_brc, FUSE_COMPARE_BRC);
+    THREAD_FUSE(NEXT_IS_BC, op_47, FUSE_COMPARE_BC);
+    THREAD_NEXT();
+
+op_A7:  /* RI instructions                                           */
+    switch (ip[1] & 0x0F) {
+    case 0x4: goto op_brc;
+    case 0x6: goto op_brct;
+    case 0xE: goto op_chi;
+    }
+    goto op_generic;
+
+op_brc: /* BRC - Branch Relative on Condition                        */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    if (ip[1] & (0x80 >> regs->psw.cc))
+    {
+        offset = 2 * (S16)fetch_hw(ip + 2);
+        THREAD_RELATIVE_BRANCH(offset);
+    }
+    else
+        INST_UPDATE_PSW(regs, 4, 0);
+    THREAD_NEXT();
+
+op_brct: /* BRCT - Branch Relative on Count                          */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    r1 = ip[1] >> 4;
+    if (regs->GR_L(r1) != 1)
+    {
+        /* Check the branch can be taken inline before the count
+           is decremented, the table handler would decrement again */
+        offset = 2 * (S16)fetch_hw(ip + 2);
+        THREAD_RELATIVE_BRANCH(offset);
+        regs->GR_L(r1)--;
+    }
+    else
+    {
+        regs->GR_L(r1) = 0;
+        INST_UPDATE_PSW(regs, 4, 0);
+    }
+    THREAD_NEXT();
+
+op_chi: /* CHI - Compare Halfword Immediate                          */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    r1 = ip[1] >> 4;
+    offset = (S16)fetch_hw(ip + 2);
+    INST_UPDATE_PSW(regs, 4, 0);
+    regs->psw.cc = (S32)regs->GR_L(r1) < offset ? 1 :
+                   (S32)regs->GR_L(r1) > offset ? 2 : 0;
+    THREAD_FUSE(NEXT_IS_BRC, op_brc, FUSE_COMPARE_BRC);
+    THREAD_FUSE(NEXT_IS_BC, op_47, FUSE_COMPARE_BC);
+    THREAD_NEXT();
+
+op_BF:  /* ICM - Insert Characters under Mask                        */
+    FOOTPRINT(ip, regs);
+    COUNT_INST(ip, regs);
+    THREAD_CALL();
+    THREAD_FUSE(NEXT_IS_BRC, op_brc, FUSE_ICM_BRC);
+    THREAD_NEXT();
+
+done:
+    return n;
+
+#undef THREAD_NEXT
+#undef THREAD_CALL
+#undef THREAD_FUSE
+#undef THREAD_RELATIVE_BRANCH
+#undef THREAD_BRANCH
+#undef NEXT_IS_BRC
+#undef NEXT_IS_BRCT
+#undef NEXT_IS_BC
+#undef NEXT_IS_ST
+
+} /* end function threaded_execute */
+#endif /*defined(OPTION_THREADED_DISPATCH)*/
+
+
 /*-------------------------------------------------------------------*/
 /* Run CPU                                                           */
 /*-------------------------------------------------------------------*/
@@ -1747,7 +2445,10 @@ register int    *caplocked = &sysblk.caplocked[cpu];
         memset(regs, 0, sizeof(REGS));
 
         if (cpu_init (cpu, regs, NULL))
+        {
+            free_aligned(regs);
             return NULL;
+        }
 
         WRMSG (HHC00811, "I", PTYPSTR(cpu), cpu, get_arch_mode_string(regs));
 
@@ -1763,7 +2464,7 @@ register int    *caplocked = &sysblk.caplocked[cpu];
 #endif
 
     regs->tracing = (sysblk.inststep || sysblk.insttrace);
-    regs->ints_state |= sysblk.ints_state;
+    IC_STATE_ON(regs, sysblk.ints_state);
 
     /* Establish longjmp destination for cpu thread exit */
     if (setjmp(regs->exitjmp))
@@ -1823,6 +2524,24 @@ register int    *caplocked = &sysblk.caplocked[cpu];
         EXECUTE_INSTRUCTION(current_opcode_table, ip, regs);
         regs->instcount++;
 
+#if defined(OPTION_BLOCK_DISPATCH) && __GEN_ARCH == 900
+        if (sysblk.bbdisp)
+        {
+            regs->instcount += ARCH_DEP(bb_run)
+                                   (regs, current_opcode_table, 256);
+            continue;
+        }
+#endif /*defined(OPTION_BLOCK_DISPATCH) && __GEN_ARCH == 900*/
+
+#if defined(OPTION_THREADED_DISPATCH)
+        if (sysblk.threaded)
+        {
+            regs->instcount += ARCH_DEP(threaded_execute)
+                                   (regs, current_opcode_table, 256);
+            continue;
+        }
+#endif /*defined(OPTION_THREADED_DISPATCH)*/
+
         /* BHe: I have tried several settings. But 2 unrolled */
         /* executes gives (core i7 at my place) the best results. */
         /* Even a 'do { } while(0);' with several unrolled executes */
@@ -267,26 +267,38 @@
 /*
  * State bits indicate what interrupts are possibly pending
  * for a CPU.  These bits can be set by any thread and therefore
- * are serialized by the `intlock'.
+ * are updated with interlocked host instructions.  Floating
+ * interrupts (I/O, channel report, interrupt key and service
+ * signal) are also recorded in sysblk.ints_state and remain
+ * serialized by the `intlock'.  Interrupts for one CPU only
+ * (clock comparator, CPU timer, external call, emergency signal)
+ * need only be serialized by the target CPU's `cpulock' and are
+ * followed by wakeup_posted_cpu.
  * For PER, the state bits are set when CR9 is loaded and the mask
  * bits are set when a PER event occurs
  */
 
+#define IC_STATE_ON(_regs, _bits) \
+        atomic_or4(&(_regs)->ints_state, (_bits))
+
+#define IC_STATE_OFF(_regs, _bits) \
+        atomic_and4(&(_regs)->ints_state, ~(U32)(_bits))
+
 #define SET_IC_TRACE \
  do { \
    int i; \
    CPU_BITMAP mask = sysblk.started_mask; \
    for (i = 0; mask; i++) { \
      if (mask & 1) \
-       sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT); \
+       IC_STATE_ON(sysblk.regs[i], BIT(IC_INTERRUPT)); \
      mask >>= 1; \
    } \
  } while (0)
 
 #define SET_IC_PER(_regs) \
  do { \
-  (_regs)->ints_state &= (~IC_PER_MASK); \
-  (_regs)->ints_state |= (((_regs)->CR(9) >> IC_CR9_SHIFT) & IC_PER_MASK); \
+  IC_STATE_OFF((_regs), IC_PER_MASK); \
+  IC_STATE_ON((_regs), (((_regs)->CR(9) >> IC_CR9_SHIFT) & IC_PER_MASK)); \
   (_regs)->ints_mask  &= (~IC_PER_MASK | (_regs)->ints_state); \
  } while (0)
 
@@ -296,39 +308,58 @@
 
 #define ON_IC_INTERRUPT(_regs) \
  do { \
-   (_regs)->ints_state |=  BIT(IC_INTERRUPT); \
+   IC_STATE_ON((_regs), BIT(IC_INTERRUPT)); \
  } while (0)
 
 #define ON_IC_RESTART(_regs) \
  do { \
-   (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_RESTART); \
+   IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_RESTART)); \
  } while (0)
 
 #define ON_IC_STORSTAT(_regs) \
  do { \
-   (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_STORSTAT); \
+   IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_STORSTAT)); \
+ } while (0)
+
+/* SET_IC_IOPENDING posts the pending I/O interrupt to the started
+   CPUs without waking any of them; the channel subsystem then wakes
+   one waiting CPU enabled for a queued interrupt (Wakeup_IO_CPU).
+   ON_IC_IOPENDING wakes the LRU waiting CPU enabled for I/O. */
+#define SET_IC_IOPENDING \
+ do { \
+   REGS *regs; \
+   CPU_BITMAP mask = sysblk.started_mask; \
+   int i; \
+   sysblk.ints_state |= BIT(IC_IO); \
+   for (i = 0; mask; mask >>= 1, ++i) \
+   { \
+     if (mask & 1) \
+     { \
+       regs = sysblk.regs[i]; \
+       if ( regs->ints_mask & BIT(IC_IO) ) \
+         IC_STATE_ON(regs, BIT(IC_INTERRUPT) | BIT(IC_IO)); \
+       else \
+         IC_STATE_ON(regs, BIT(IC_IO)); \
+     } \
+   } \
  } while (0)
 
 #define ON_IC_IOPENDING \
  do { \
    REGS *regs; \
    CPU_BITMAP mask = sysblk.started_mask; \
-   CPU_BITMAP wake; \
+   CPU_BITMAP wake = 0; \
    int i; \
    if ( !(sysblk.ints_state & BIT(IC_IO)) ) \
    { \
-     sysblk.ints_state |= BIT(IC_IO); \
-     wake = mask; \
+     SET_IC_IOPENDING; \
      for (i = 0; mask; mask >>= 1, ++i) \
      { \
        if (mask & 1) \
        { \
          regs = sysblk.regs[i]; \
          if ( regs->ints_mask & BIT(IC_IO) ) \
-           regs->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_IO); \
-         else \
-           regs->ints_state |= BIT(IC_IO), \
-           wake ^= regs->cpubit; \
+           wake |= regs->cpubit; \
        } \
      } \
      WAKEUP_CPU_MASK(wake); \
@@ -344,9 +375,9 @@
      for (i = 0; mask; i++) { \
        if (mask & 1) { \
          if ( sysblk.regs[i]->ints_mask & BIT(IC_CHANRPT) ) \
-           sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_CHANRPT); \
+           IC_STATE_ON(sysblk.regs[i], BIT(IC_INTERRUPT) | BIT(IC_CHANRPT)); \
          else \
-           sysblk.regs[i]->ints_state |= BIT(IC_CHANRPT); \
+           IC_STATE_ON(sysblk.regs[i], BIT(IC_CHANRPT)); \
        } \
        mask >>= 1; \
      } \
@@ -362,9 +393,9 @@
      for (i = 0; mask; i++) { \
        if (mask & 1) { \
          if ( sysblk.regs[i]->ints_mask & BIT(IC_INTKEY) ) \
-           sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_INTKEY); \
+           IC_STATE_ON(sysblk.regs[i], BIT(IC_INTERRUPT) | BIT(IC_INTKEY)); \
          else \
-           sysblk.regs[i]->ints_state |=  BIT(IC_INTKEY); \
+           IC_STATE_ON(sysblk.regs[i], BIT(IC_INTKEY)); \
        } \
        mask >>= 1; \
      } \
@@ -380,9 +411,9 @@
      for (i = 0; mask; i++) { \
        if (mask & 1) { \
          if ( sysblk.regs[i]->ints_mask & BIT(IC_SERVSIG) ) \
-           sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_SERVSIG); \
+           IC_STATE_ON(sysblk.regs[i], BIT(IC_INTERRUPT) | BIT(IC_SERVSIG)); \
          else \
-           sysblk.regs[i]->ints_state |= BIT(IC_SERVSIG); \
+           IC_STATE_ON(sysblk.regs[i], BIT(IC_SERVSIG)); \
          } \
        mask >>= 1; \
      } \
@@ -392,57 +423,57 @@
 #define ON_IC_ITIMER(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_ITIMER) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_ITIMER); \
+     IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_ITIMER)); \
    else \
-     (_regs)->ints_state |= BIT(IC_ITIMER); \
+     IC_STATE_ON((_regs), BIT(IC_ITIMER)); \
  } while (0)
 
 #define ON_IC_PTIMER(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_PTIMER) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_PTIMER); \
+     IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_PTIMER)); \
    else \
-     (_regs)->ints_state |= BIT(IC_PTIMER); \
+     IC_STATE_ON((_regs), BIT(IC_PTIMER)); \
  } while (0)
 
 #define ON_IC_ECPSVTIMER(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_ECPSVTIMER) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_ECPSVTIMER); \
+     IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_ECPSVTIMER)); \
    else \
-     (_regs)->ints_state |= BIT(IC_ECPSVTIMER); \
+     IC_STATE_ON((_regs), BIT(IC_ECPSVTIMER)); \
  } while (0)
 
 #define ON_IC_CLKC(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_CLKC) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_CLKC); \
+     IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_CLKC)); \
    else \
-     (_regs)->ints_state |= BIT(IC_CLKC); \
+     IC_STATE_ON((_regs), BIT(IC_CLKC)); \
  } while (0)
 
 #define ON_IC_EXTCALL(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_EXTCALL) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_EXTCALL); \
+     IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_EXTCALL)); \
    else \
-     (_regs)->ints_state |= BIT(IC_EXTCALL); \
+     IC_STATE_ON((_regs), BIT(IC_EXTCALL)); \
  } while (0)
 
 #define ON_IC_MALFALT(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_MALFALT) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_MALFALT); \
+     IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_MALFALT)); \
    else \
-     (_regs)->ints_state |= BIT(IC_MALFALT); \
+     IC_STATE_ON((_regs), BIT(IC_MALFALT)); \
  } while (0)
 
 #define ON_IC_EMERSIG(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_EMERSIG) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_EMERSIG); \
+     IC_STATE_ON((_regs), BIT(IC_INTERRUPT) | BIT(IC_EMERSIG)); \
    else \
-     (_regs)->ints_state |= BIT(IC_EMERSIG); \
+     IC_STATE_ON((_regs), BIT(IC_EMERSIG)); \
  } while (0)
 
     /*
@@ -488,17 +519,17 @@
 
 #define OFF_IC_INTERRUPT(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_INTERRUPT); \
+   IC_STATE_OFF((_regs), BIT(IC_INTERRUPT)); \
  } while (0)
 
 #define OFF_IC_RESTART(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_RESTART); \
+   IC_STATE_OFF((_regs), BIT(IC_RESTART)); \
  } while (0)
 
 #define OFF_IC_STORSTAT(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_STORSTAT); \
+   IC_STATE_OFF((_regs), BIT(IC_STORSTAT)); \
  } while (0)
 
 #define OFF_IC_IOPENDING \
@@ -509,7 +540,7 @@
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_IO); \
+         IC_STATE_OFF(sysblk.regs[i], BIT(IC_IO)); \
        mask >>= 1; \
      } \
    } \
@@ -523,7 +554,7 @@
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_CHANRPT); \
+         IC_STATE_OFF(sysblk.regs[i], BIT(IC_CHANRPT)); \
        mask >>= 1; \
      } \
    } \
@@ -537,7 +568,7 @@
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_INTKEY); \
+         IC_STATE_OFF(sysblk.regs[i], BIT(IC_INTKEY)); \
        mask >>= 1; \
      } \
    } \
@@ -551,7 +582,7 @@
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_SERVSIG); \
+         IC_STATE_OFF(sysblk.regs[i], BIT(IC_SERVSIG)); \
        mask >>= 1; \
      } \
    } \
@@ -559,37 +590,37 @@
 
 #define OFF_IC_ITIMER(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_ITIMER); \
+   IC_STATE_OFF((_regs), BIT(IC_ITIMER)); \
  } while (0)
 
 #define OFF_IC_PTIMER(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_PTIMER); \
+   IC_STATE_OFF((_regs), BIT(IC_PTIMER)); \
  } while (0)
 
 #define OFF_IC_ECPSVTIMER(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_ECPSVTIMER); \
+   IC_STATE_OFF((_regs), BIT(IC_ECPSVTIMER)); \
  } while (0)
 
 #define OFF_IC_CLKC(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_CLKC); \
+   IC_STATE_OFF((_regs), BIT(IC_CLKC)); \
  } while (0)
 
 #define OFF_IC_EXTCALL(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_EXTCALL); \
+   IC_STATE_OFF((_regs), BIT(IC_EXTCALL)); \
  } while (0)
 
 #define OFF_IC_MALFALT(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_MALFALT); \
+   IC_STATE_OFF((_regs), BIT(IC_MALFALT)); \
  } while (0)
 
 #define OFF_IC_EMERSIG(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_EMERSIG); \
+   IC_STATE_OFF((_regs), BIT(IC_EMERSIG)); \
  } while (0)
 
 #define OFF_IC_PER(_regs) \
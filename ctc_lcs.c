@@ -1837,6 +1837,8 @@ static void*  LCS_PortThread( void* arg)
 
     pLCSPORT->pid = getpid();
 
+    apply_thread_affinity( AFFINITY_LCS, -1 );
+
     PTT_DEBUG(            "PORTHRD: ENTRY    ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
 
     for (;;)
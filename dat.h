@@ -504,15 +504,13 @@ int i;
 
 /*-------------------------------------------------------------------*/
 /* Purge the ART lookaside buffer for all CPUs                       */
+/*                                                                   */
+/* Running CPUs purge at their next interrupt check; the caller      */
+/* waits for them with purge_wait before releasing the intlock.      */
 /*-------------------------------------------------------------------*/
-_DAT_C_STATIC void ARCH_DEP(purge_alb_all) ()
+_DAT_C_STATIC void ARCH_DEP(purge_alb_all) (REGS *regs)
 {
-int i;
-
-    for (i = 0; i < sysblk.maxcpu; i++)
-        if (IS_CPU_ONLINE(i)
-         && (sysblk.regs[i]->cpubit & sysblk.started_mask))
-            ARCH_DEP(purge_alb) (sysblk.regs[i]);
+    ARCH_DEP(post_purge) (regs, PURGE_REQ_ALB, 0);
 
 } /* end function purge_alb_all */
 #endif /*defined(FEATURE_ACCESS_REGISTERS)*/
@@ -949,6 +947,7 @@ U32     ptl;                            /* Page table length         */
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
+            TLB_RMAP_SET(&regs->tlb, tlbix, pte);
             regs->tlb.common[tlbix]    = (ste & SEGTAB_370_CMN) ? 1 : 0;
             regs->tlb.protect[tlbix]   = regs->dat.protect;
             regs->tlb.acc[tlbix]       = 0;
@@ -960,6 +959,7 @@ U32     ptl;                            /* Page table length         */
                 regs->tlb.TLB_ASD(tlbix^1)   = regs->tlb.TLB_ASD(tlbix);
                 regs->tlb.TLB_VADDR(tlbix^1) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
                 regs->tlb.TLB_PTE(tlbix^1)   = regs->tlb.TLB_PTE(tlbix);
+                TLB_RMAP_SET(&regs->tlb, tlbix^1, pte);
                 regs->tlb.common[tlbix^1]    = regs->tlb.common[tlbix];
                 regs->tlb.protect[tlbix^1]   = regs->tlb.protect[tlbix];
                 regs->tlb.acc[tlbix^1]       = 0;
@@ -1087,6 +1087,7 @@ U32     ptl;                            /* Page table length         */
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
+            TLB_RMAP_SET(&regs->tlb, tlbix, pte);
             regs->tlb.common[tlbix]    = (ste & SEGTAB_COMMON) ? 1 : 0;
             regs->tlb.acc[tlbix]       = 0;
             regs->tlb.protect[tlbix]   = regs->dat.protect;
@@ -1123,6 +1124,9 @@ U16     rfx, rsx, rtx;                  /* Region first/second/third
                                            index + 3 low-order zeros */
 U16     sx, px;                         /* Segment and page index,
                                            + 3 low-order zero bits   */
+#if defined(FEATURE_ENHANCED_DAT_FACILITY)
+int     lix = TLB_LARGEIX(vaddr);       /* Large frame TLB index     */
+#endif /*defined(FEATURE_ENHANCED_DAT_FACILITY)*/
 
     regs->dat.pvtaddr = regs->dat.protect = 0;
 
@@ -1147,6 +1151,21 @@ U16     sx, px;                         /* Segment and page index,
     }
     else
     {
+#if defined(FEATURE_ENHANCED_DAT_FACILITY)
+        /* Look up the segment in the large frame TLB.  A hit yields
+           the 4K page of the segment frame as if from a page table */
+        if (   ((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.lvaddr[lix].D
+            && (regs->tlb.lcommon[lix] || regs->dat.asd == regs->tlb.lasd[lix].D)
+            && !(regs->tlb.lcommon[lix] && regs->dat.pvtaddr)
+            && !(acctype & (ACC_NOTLB|ACC_PTE|ACC_LPTEA))
+            && (regs->CR_L(0) & CR0_ED) )
+        {
+            pte = regs->tlb.lsfaa[lix].D | (vaddr & ~ZSEGTAB_SFAA & PAGEFRAME_PAGEMASK);
+            ste = regs->tlb.lcommon[lix] ? SEGTAB_COMMON : 0;
+            regs->dat.protect |= regs->tlb.lprotect[lix];
+        }
+        else
+#endif /*defined(FEATURE_ENHANCED_DAT_FACILITY)*/
         /* If ASCE indicates a real-space then real addr = virtual addr */
         if (regs->dat.asd & ASCE_R)
         {
@@ -1433,10 +1452,19 @@ U16     sx, px;                         /* Segment and page index,
                     regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
                     /* Fake 4K PTE for TLB purposes */
                     regs->tlb.TLB_PTE(tlbix)   = ((ste & ZSEGTAB_SFAA) | (vaddr & ~ZSEGTAB_SFAA)) & PAGEFRAME_PAGEMASK;
+                    TLB_RMAP_SET(&regs->tlb, tlbix, regs->tlb.TLB_PTE(tlbix));
                     regs->tlb.common[tlbix]    = (ste & SEGTAB_COMMON) ? 1 : 0;
                     regs->tlb.protect[tlbix]   = regs->dat.protect;
                     regs->tlb.acc[tlbix]       = 0;
                     regs->tlb.main[tlbix]      = NULL;
+
+                    /* Place the whole segment frame in the large
+                       frame TLB for the other pages of the segment */
+                    regs->tlb.lasd[lix].D      = regs->dat.asd;
+                    regs->tlb.lvaddr[lix].D    = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
+                    regs->tlb.lsfaa[lix].D     = ste & ZSEGTAB_SFAA;
+                    regs->tlb.lcommon[lix]     = (ste & SEGTAB_COMMON) ? 1 : 0;
+                    regs->tlb.lprotect[lix]    = regs->dat.protect;
                 }
 
                 /* Clear exception code and return with zero return code */
@@ -1500,6 +1528,7 @@ U16     sx, px;                         /* Segment and page index,
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
+            TLB_RMAP_SET(&regs->tlb, tlbix, pte);
             regs->tlb.common[tlbix]    = (ste & SEGTAB_COMMON) ? 1 : 0;
             regs->tlb.protect[tlbix]   = regs->dat.protect;
             regs->tlb.acc[tlbix]       = 0;
@@ -1737,9 +1766,11 @@ tran_excp_addr:
 _DAT_C_STATIC void ARCH_DEP(purge_tlb) (REGS *regs)
 {
     INVALIDATE_AIA(regs);
+    INVALIDATE_BTC(regs);
     if (((++regs->tlbID) & TLBID_BYTEMASK) == 0)
     {
         memset(&regs->tlb.vaddr, 0, TLBN * sizeof(DW) );
+        memset(&regs->tlb.lvaddr, 0, TLB_LARGEN * sizeof(DW) );
         regs->tlbID = 1;
     }
 #if defined(_FEATURE_SIE)
@@ -1747,9 +1778,11 @@ _DAT_C_STATIC void ARCH_DEP(purge_tlb) (REGS *regs)
     if(regs->host && regs->guestregs)
     {
         INVALIDATE_AIA(regs->guestregs);
+        INVALIDATE_BTC(regs->guestregs);
         if (((++regs->guestregs->tlbID) & TLBID_BYTEMASK) == 0)
         {
             memset(&regs->guestregs->tlb.vaddr, 0, TLBN * sizeof(DW));
+            memset(&regs->guestregs->tlb.lvaddr, 0, TLB_LARGEN * sizeof(DW));
             regs->guestregs->tlbID = 1;
         }
     }
@@ -1757,27 +1790,68 @@ _DAT_C_STATIC void ARCH_DEP(purge_tlb) (REGS *regs)
 } /* end function purge_tlb */
 
 
+#if !defined(PURGE_TIME_START)
+/* Note the start of a broadcast purge for ptt 'inf'.  The first     */
+/* post before a purge_wait starts the clock; purge_wait traces the  */
+/* time including the wait for the other CPUs.                       */
+#define PURGE_TIME_START(_hostregs, _msg, _tag) \
+do { \
+    if ((pttclass & PTT_CL_INF) && !(_hostregs)->purgemsg) \
+    { \
+        (_hostregs)->purgemsg = (_msg); \
+        (_hostregs)->purgetag = (_tag); \
+        (_hostregs)->purgecpus = 0; \
+        clock_gettime(CLOCK_MONOTONIC, &(_hostregs)->purgets); \
+    } \
+} while (0)
+#endif
+
 /*-------------------------------------------------------------------*/
 /* Purge the translation lookaside buffer for all CPUs               */
+/*                                                                   */
+/* Running CPUs purge at their next interrupt check; the caller      */
+/* waits for them with purge_wait before releasing the intlock.      */
 /*-------------------------------------------------------------------*/
-_DAT_C_STATIC void ARCH_DEP(purge_tlb_all) ()
+_DAT_C_STATIC void ARCH_DEP(purge_tlb_all) (REGS *regs)
 {
-int i;
+int cpus;                               /* CPUs purged or posted     */
 
-    for (i = 0; i < sysblk.maxcpu; i++)
-        if (IS_CPU_ONLINE(i)
-         && (sysblk.regs[i]->cpubit & sysblk.started_mask))
-            ARCH_DEP(purge_tlb) (sysblk.regs[i]);
+    PURGE_TIME_START(regs->hostregs, "purge_tlb ns", 0);
+
+    cpus = ARCH_DEP(post_purge) (regs, PURGE_REQ_TLB, 0);
+
+    if (regs->hostregs->purgemsg)
+        regs->hostregs->purgecpus += cpus;
 
 } /* end function purge_tlb_all */
 
 
+#if defined(FEATURE_ENHANCED_DAT_FACILITY)
+/*-------------------------------------------------------------------*/
+/* Purge large frame TLB entries for the segment frame of a page     */
+/*-------------------------------------------------------------------*/
+static __inline__ void ARCH_DEP(purge_tlbe_large) (REGS *regs, RADR pfra)
+{
+int     i;                              /* Large frame TLB index     */
+
+    for (i = 0; i < TLB_LARGEN; i++)
+        if (regs->tlb.lsfaa[i].D == (pfra & ZSEGTAB_SFAA))
+            regs->tlb.lvaddr[i].D &= TLBID_PAGEMASK;
+
+} /* end function purge_tlbe_large */
+#endif /*defined(FEATURE_ENHANCED_DAT_FACILITY)*/
+
+
 /*-------------------------------------------------------------------*/
 /* Purge translation lookaside buffer entries                        */
 /*-------------------------------------------------------------------*/
 _DAT_C_STATIC void ARCH_DEP(purge_tlbe) (REGS *regs, RADR pfra)
 {
-int  i;
+int  i;                                 /* TLB entry index + 1       */
+int  b;                                 /* Reverse map bucket        */
+#if defined(OPTION_TLB_WAYS) && defined(_FEATURE_SIE)
+int  w;                                 /* Guest TLB way             */
+#endif
 RADR pte;
 RADR ptemask;
 
@@ -1797,17 +1871,28 @@ RADR ptemask;
     pte = pfra & ptemask;
 #endif /* defined(FEATURE_ESAME) */
 
+    /* Only the entries in the reverse map bucket of the page frame
+       can match, visit those rather than the whole TLB */
+    b = TLB_RHASH(pte);
+
     INVALIDATE_AIA(regs);
-    for (i = 0; i < TLBN; i++)
-        if ((regs->tlb.TLB_PTE(i) & ptemask) == pte)
-            regs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
+    INVALIDATE_BTC(regs);
+#if defined(FEATURE_ENHANCED_DAT_FACILITY)
+    ARCH_DEP(purge_tlbe_large) (regs, pfra);
+#endif /*defined(FEATURE_ENHANCED_DAT_FACILITY)*/
+    for (i = regs->tlb.rhead[b]; i; i = regs->tlb.rnext[i - 1])
+        if ((regs->tlb.TLB_PTE(i - 1) & ptemask) == pte)
+            regs->tlb.TLB_VADDR(i - 1) &= TLBID_PAGEMASK;
 
 #if defined(_FEATURE_SIE)
     /* Also clear the guest registers in the SIE copy */
     if (regs->host && regs->guestregs)
     {
         INVALIDATE_AIA(regs->guestregs);
-        for (i = 0; i < TLBN; i++)
+        INVALIDATE_BTC(regs->guestregs);
+#if defined(FEATURE_ENHANCED_DAT_FACILITY)
+        ARCH_DEP(purge_tlbe_large) (regs->guestregs, pfra);
+#endif /*defined(FEATURE_ENHANCED_DAT_FACILITY)*/
 /************************************************************************** @PJJ */
 /* The guest registers in the SIE copy TLB PTE entries for DAT-OFF guests * @PJJ */
 /* like CMS do NOT actually contain the PTE (but rather the host primary  * @PJJ */
@@ -1822,18 +1907,36 @@ RADR ptemask;
 /*                                                                        * @PJJ */
 /*                                        (Peter J. Jansen, 29-Jul-2016)  * @PJJ */
 /************************************************************************** @PJJ */
-            if ((regs->guestregs->tlb.TLB_PTE(i) & ptemask) == pte ||    /* @PJJ */
-                 (regs->hostregs->tlb.TLB_PTE(i) & ptemask) == pte)      /* @PJJ */
-                regs->guestregs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
+/* With the reverse map the two tests are two walks, one of the guest     */
+/* bucket and one of the parallel host bucket.                            */
+/**************************************************************************/
+        for (i = regs->guestregs->tlb.rhead[b]; i; i = regs->guestregs->tlb.rnext[i - 1])
+            if ((regs->guestregs->tlb.TLB_PTE(i - 1) & ptemask) == pte)
+                regs->guestregs->tlb.TLB_VADDR(i - 1) &= TLBID_PAGEMASK;
+        for (i = regs->hostregs->tlb.rhead[b]; i; i = regs->hostregs->tlb.rnext[i - 1])
+            if ((regs->hostregs->tlb.TLB_PTE(i - 1) & ptemask) == pte)
+#if defined(OPTION_TLB_WAYS)
+                /* The guest and host ways of a set are reordered
+                   independently, purge every guest way of the set */
+                for (w = 0; w < sysblk.tlbways; w++)
+                    regs->guestregs->tlb.TLB_VADDR(((i - 1) & TLB_MASK)
+                                                   + w * TLB_SETS) &= TLBID_PAGEMASK;
+#else
+                regs->guestregs->tlb.TLB_VADDR(i - 1) &= TLBID_PAGEMASK;
+#endif
     }
     else
     /* For guests, clear any host entries */
     if (regs->guest)
     {
         INVALIDATE_AIA(regs->hostregs);
-        for (i = 0; i < TLBN; i++)
-            if ((regs->hostregs->tlb.TLB_PTE(i) & ptemask) == pte)
-                regs->hostregs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
+        INVALIDATE_BTC(regs->hostregs);
+#if defined(FEATURE_ENHANCED_DAT_FACILITY)
+        ARCH_DEP(purge_tlbe_large) (regs->hostregs, pfra);
+#endif /*defined(FEATURE_ENHANCED_DAT_FACILITY)*/
+        for (i = regs->hostregs->tlb.rhead[b]; i; i = regs->hostregs->tlb.rnext[i - 1])
+            if ((regs->hostregs->tlb.TLB_PTE(i - 1) & ptemask) == pte)
+                regs->hostregs->tlb.TLB_VADDR(i - 1) &= TLBID_PAGEMASK;
     }
 #endif /*defined(_FEATURE_SIE)*/
 
@@ -1842,19 +1945,199 @@ RADR ptemask;
 
 /*-------------------------------------------------------------------*/
 /* Purge translation lookaside buffer entries for all CPUs           */
+/*                                                                   */
+/* Running CPUs purge at their next interrupt check; the caller      */
+/* waits for them with purge_wait before releasing the intlock.      */
 /*-------------------------------------------------------------------*/
-_DAT_C_STATIC void ARCH_DEP(purge_tlbe_all) (RADR pfra)
+_DAT_C_STATIC void ARCH_DEP(purge_tlbe_all) (REGS *regs, RADR pfra)
 {
-int i;
+int cpus;                               /* CPUs purged or posted     */
 
-    for (i = 0; i < sysblk.maxcpu; i++)
-        if (IS_CPU_ONLINE(i)
-         && (sysblk.regs[i]->cpubit & sysblk.started_mask))
-            ARCH_DEP(purge_tlbe) (sysblk.regs[i], pfra);
+    PURGE_TIME_START(regs->hostregs, "purge_tlbe ns", pfra);
+
+    cpus = ARCH_DEP(post_purge) (regs, PURGE_REQ_TLBE, pfra);
+
+    if (regs->hostregs->purgemsg)
+        regs->hostregs->purgecpus += cpus;
 
 } /* end function purge_tlbe_all */
 
 
+/*-------------------------------------------------------------------*/
+/* Post a broadcast purge to all started CPUs                        */
+/*                                                                   */
+/* Input:                                                            */
+/*      regs    Register context of the initiating CPU               */
+/*      req     PURGE_REQ_TLB, PURGE_REQ_TLBE or PURGE_REQ_ALB       */
+/*      pfra    Page frame real address for PURGE_REQ_TLBE           */
+/*                                                                   */
+/* The initiating CPU and CPUs in the wait state, which cannot leave */
+/* it without the intlock, are purged at once.  Other started CPUs   */
+/* keep running: the request is queued on the CPU, which performs it */
+/* at its next interrupt check, and the CPU is noted together with   */
+/* its purge epoch in the initiator's purgewait for purge_wait.      */
+/* Frames are queued up to PURGE_TLBE_MAX, after which the whole TLB */
+/* is purged, as it is for a frame posted by an SIE guest of another */
+/* architecture than the one the queue is processed in.              */
+/*                                                                   */
+/* Returns the number of CPUs purged or posted.                      */
+/* Called with the intlock held.                                     */
+/*-------------------------------------------------------------------*/
+_DAT_C_STATIC int ARCH_DEP(post_purge) (REGS *regs, BYTE req, RADR pfra)
+{
+REGS   *hostregs = regs->hostregs;      /* Initiator host registers  */
+REGS   *tregs;                          /* Target CPU registers      */
+int     cpus = 0;                       /* CPUs purged or posted     */
+int     i;                              /* CPU number                */
+
+    for (i = 0; i < sysblk.maxcpu; i++)
+    {
+        if (!IS_CPU_ONLINE(i)
+         || !(sysblk.regs[i]->cpubit & sysblk.started_mask))
+            continue;
+
+        tregs = sysblk.regs[i];
+        cpus++;
+
+        /* Purge this CPU and the waiting CPUs directly */
+        if (tregs == hostregs
+         || (tregs->cpubit & sysblk.waiting_mask))
+        {
+            switch (req) {
+            case PURGE_REQ_TLB:
+                ARCH_DEP(purge_tlb) (tregs);
+                break;
+            case PURGE_REQ_TLBE:
+                ARCH_DEP(purge_tlbe) (tregs, pfra);
+                break;
+#if defined(FEATURE_ACCESS_REGISTERS)
+            case PURGE_REQ_ALB:
+                ARCH_DEP(purge_alb) (tregs);
+                break;
+#endif /*defined(FEATURE_ACCESS_REGISTERS)*/
+            }
+            continue;
+        }
+
+        /* Queue the request for a running CPU */
+        if (req != PURGE_REQ_TLBE)
+            tregs->purgereq |= req;
+        else if (tregs->purgereq & PURGE_REQ_TLB)
+            ;   /* (the whole TLB is purged already) */
+        else if (tregs->purgen < PURGE_TLBE_MAX
+              && ARCH_MODE == sysblk.arch_mode)
+        {
+            tregs->purgepfra[tregs->purgen++] = pfra;
+            tregs->purgereq |= PURGE_REQ_TLBE;
+        }
+        else
+            tregs->purgereq |= PURGE_REQ_TLB;
+
+        /* (a CPU running an SIE guest exits to the host for this) */
+        ON_IC_INTERRUPT(tregs);
+
+        hostregs->purgewait |= tregs->cpubit;
+        hostregs->purgeseen[i] = tregs->purgeepoch;
+    }
+
+    /* Initiators waiting in purge_wait perform their own requests */
+    if (sysblk.purgewaiters)
+        broadcast_condition (&sysblk.purgecond);
+
+    return cpus;
+
+} /* end function post_purge */
+
+
+/*-------------------------------------------------------------------*/
+/* Perform the broadcast purges queued for a CPU                     */
+/*                                                                   */
+/* Called at the interrupt check of the CPU with the intlock held.   */
+/*-------------------------------------------------------------------*/
+_DAT_C_STATIC void ARCH_DEP(perform_purge) (REGS *regs)
+{
+int     i;                              /* Index into purgepfra      */
+
+    if (regs->purgereq & PURGE_REQ_TLB)
+        ARCH_DEP(purge_tlb) (regs);
+    else if (regs->purgereq & PURGE_REQ_TLBE)
+        for (i = 0; i < regs->purgen; i++)
+            ARCH_DEP(purge_tlbe) (regs, regs->purgepfra[i]);
+
+#if defined(FEATURE_ACCESS_REGISTERS)
+    if (regs->purgereq & PURGE_REQ_ALB)
+        ARCH_DEP(purge_alb) (regs);
+#endif /*defined(FEATURE_ACCESS_REGISTERS)*/
+
+    regs->purgereq = 0;
+    regs->purgen = 0;
+    regs->purgeepoch++;
+
+    if (sysblk.purgewaiters)
+        broadcast_condition (&sysblk.purgecond);
+
+} /* end function perform_purge */
+
+
+/*-------------------------------------------------------------------*/
+/* Wait until the CPUs have performed the purges posted to them      */
+/*                                                                   */
+/* A CPU is done once its purge epoch has moved on from the epoch    */
+/* noted when the request was posted.  The intlock is released while */
+/* waiting; purges which other initiators meanwhile queue for this   */
+/* CPU are performed here so that two initiators cannot deadlock.    */
+/* A CPU which stopped or went offline is no longer waited for.      */
+/*                                                                   */
+/* Called with the intlock held, which is held again on return.      */
+/*-------------------------------------------------------------------*/
+_DAT_C_STATIC void ARCH_DEP(purge_wait) (REGS *regs)
+{
+REGS   *hostregs = regs->hostregs;      /* Initiator host registers  */
+int     i;                              /* CPU number                */
+
+    for (;;)
+    {
+        for (i = 0; hostregs->purgewait && i < sysblk.maxcpu; i++)
+        {
+            if (!(hostregs->purgewait & CPU_BIT(i)))
+                continue;
+
+            if (!IS_CPU_ONLINE(i)
+             || !(sysblk.regs[i]->cpubit & sysblk.started_mask)
+             || sysblk.regs[i]->purgeepoch != hostregs->purgeseen[i])
+                hostregs->purgewait &= ~CPU_BIT(i);
+        }
+
+        if (!hostregs->purgewait)
+            break;
+
+        if (hostregs->purgereq)
+        {
+            ARCH_DEP(perform_purge) (hostregs);
+            continue;
+        }
+
+        sysblk.purgewaiters++;
+        sysblk.intowner = LOCK_OWNER_NONE;
+        wait_condition (&sysblk.purgecond, &sysblk.intlock);
+        sysblk.intowner = hostregs->cpuad;
+        sysblk.purgewaiters--;
+    }
+
+    /* Trace the time from the first post to the end of the wait */
+    if (hostregs->purgemsg)
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        PTT_INF(hostregs->purgemsg, hostregs->purgetag, hostregs->purgecpus,
+                (ts.tv_sec - hostregs->purgets.tv_sec) * 1000000000
+              + (ts.tv_nsec - hostregs->purgets.tv_nsec));
+        hostregs->purgemsg = NULL;
+    }
+
+} /* end function purge_wait */
+
+
 /*-------------------------------------------------------------------*/
 /* Invalidate all translation lookaside buffer entries               */
 /*-------------------------------------------------------------------*/
@@ -1863,10 +2146,11 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlb) (REGS *regs, BYTE mask)
 int  i;
 
     INVALIDATE_AIA(regs);
+    INVALIDATE_BTC(regs);
     if (mask == 0)
         memset(&regs->tlb.acc, 0, TLBN);
     else
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES; i++)
             if ((regs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->tlbID)
                 regs->tlb.acc[i] &= mask;
 
@@ -1875,10 +2159,11 @@ int  i;
     if(regs->host && regs->guestregs)
     {
         INVALIDATE_AIA(regs->guestregs);
+        INVALIDATE_BTC(regs->guestregs);
         if (mask == 0)
             memset(&regs->guestregs->tlb.acc, 0, TLBN);
         else
-            for (i = 0; i < TLBN; i++)
+            for (i = 0; i < TLB_ENTRIES; i++)
                 if ((regs->guestregs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->guestregs->tlbID)
                     regs->guestregs->tlb.acc[i] &= mask;
     }
@@ -1887,10 +2172,11 @@ int  i;
     if(regs->guest)
     {
         INVALIDATE_AIA(regs->hostregs);
+        INVALIDATE_BTC(regs->hostregs);
         if (mask == 0)
             memset(&regs->hostregs->tlb.acc, 0, TLBN);
         else
-            for (i = 0; i < TLBN; i++)
+            for (i = 0; i < TLB_ENTRIES; i++)
                 if ((regs->hostregs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->hostregs->tlbID)
                     regs->hostregs->tlb.acc[i] &= mask;
     }
@@ -1934,10 +2220,11 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
     mainwid = main + regs->tlbID;
 
     INVALIDATE_AIA_MAIN(regs, main);
+    INVALIDATE_BTC(regs);
     shift = regs->arch_mode == ARCH_370 ? 11 : 12;
-    for (i = 0; i < TLBN; i++)
+    for (i = 0; i < TLB_ENTRIES; i++)
         if (MAINADDR(regs->tlb.main[i],
-                     (regs->tlb.TLB_VADDR(i) | (i << shift)))
+                     (regs->tlb.TLB_VADDR(i) | ((i & TLB_MASK) << shift)))
                      == mainwid)
         {
             regs->tlb.acc[i] = 0;
@@ -1952,10 +2239,11 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
     if (regs->host && regs->guestregs)
     {
         INVALIDATE_AIA_MAIN(regs->guestregs, main);
+        INVALIDATE_BTC(regs->guestregs);
         shift = regs->guestregs->arch_mode == ARCH_370 ? 11 : 12;
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES; i++)
             if (MAINADDR(regs->guestregs->tlb.main[i],
-                         (regs->guestregs->tlb.TLB_VADDR(i) | (i << shift)))
+                         (regs->guestregs->tlb.TLB_VADDR(i) | ((i & TLB_MASK) << shift)))
                          == mainwid)
             {
                 regs->guestregs->tlb.acc[i] = 0;
@@ -1970,10 +2258,11 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
     if (regs->guest)
     {
         INVALIDATE_AIA_MAIN(regs->hostregs, main);
+        INVALIDATE_BTC(regs->hostregs);
         shift = regs->hostregs->arch_mode == ARCH_370 ? 11 : 12;
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES; i++)
             if (MAINADDR(regs->hostregs->tlb.main[i],
-                         (regs->hostregs->tlb.TLB_VADDR(i) | (i << shift)))
+                         (regs->hostregs->tlb.TLB_VADDR(i) | ((i & TLB_MASK) << shift)))
                          == mainwid)
             {
                 regs->hostregs->tlb.acc[i] = 0;
@@ -2005,8 +2294,8 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
 /*      the page index in the R2 register.  It clears the TLB of     */
 /*      all entries whose PFRA matches the page table entry.         */
 /*                                                                   */
-/* invalidate_pte should be called with the intlock held and         */
-/* SYNCHRONIZE_CPUS issued while intlock is held.                    */
+/* invalidate_pte should be called with the intlock held, followed  */
+/* by purge_wait before the intlock is released.                     */
 /*                                                                   */
 /*-------------------------------------------------------------------*/
 _DAT_C_STATIC void ARCH_DEP(invalidate_pte) (BYTE ibyte, RADR op1,
@@ -2121,7 +2410,7 @@ RADR    pfra;
 #endif /*defined(FEATURE_ESAME)*/
 
     /* Invalidate TLB entries */
-    ARCH_DEP(purge_tlbe_all) (pfra);
+    ARCH_DEP(purge_tlbe_all) (regs, pfra);
 
 } /* end function invalidate_pte */
 
@@ -2148,6 +2437,93 @@ static inline int ARCH_DEP(check_sa_per2) (int arn, int acctype, REGS *regs)
 
 
 #if defined(OPTION_INLINE_LOGICAL) || defined(_DAT_C)
+#if defined(OPTION_TLB_WAYS)
+/*-------------------------------------------------------------------*/
+/* Select the TLB way for a logical address                          */
+/*                                                                   */
+/* Input:                                                            */
+/*      addr    Logical address to be translated                     */
+/*      arn     Access register number                               */
+/*      regs    CPU register context                                 */
+/*                                                                   */
+/*      Called when the MADDR lookup of way 0 has failed.  If one    */
+/*      of the other ways of the set holds the page it is moved to   */
+/*      way 0, otherwise the least recently used way is moved to     */
+/*      way 0 to be replaced by translate_addr.  The ways in between */
+/*      are aged by one.  The hit, miss and conflict counts are      */
+/*      updated accordingly.                                         */
+/*-------------------------------------------------------------------*/
+static __inline__ void ARCH_DEP(tlb_select) (VADR addr, int arn,
+                                             REGS *regs)
+{
+int     ix = TLBIX(addr);               /* Way 0 TLB index           */
+int     ways = sysblk.tlbways;          /* Ways in use               */
+int     cr;                             /* Control register of ASD   */
+int     w;                              /* Way number                */
+VADR    tag;                            /* TLB_VADDR being searched  */
+U64     asd;                            /* ASD being searched        */
+
+    if ((cr = regs->AEA_AR(arn)) == 0)
+        return;
+
+    tag = (addr & TLBID_PAGEMASK) | regs->tlbID;
+    asd = regs->CR(cr);
+
+#define TLB_WAY_MATCH(_i) \
+    (regs->tlb.TLB_VADDR(_i) == tag \
+     && (regs->tlb.TLB_ASD(_i) == asd \
+      || (regs->AEA_COMMON(cr) & regs->tlb.common[_i])))
+
+#define TLB_WAY_SWAP(_a, _b) \
+do { \
+    DW    dw; \
+    BYTE *p, b; \
+    dw = regs->tlb.asd[_a];     regs->tlb.asd[_a] = regs->tlb.asd[_b];         regs->tlb.asd[_b] = dw; \
+    dw = regs->tlb.vaddr[_a];   regs->tlb.vaddr[_a] = regs->tlb.vaddr[_b];     regs->tlb.vaddr[_b] = dw; \
+    dw = regs->tlb.pte[_a];     regs->tlb.pte[_a] = regs->tlb.pte[_b];         regs->tlb.pte[_b] = dw; \
+    p = regs->tlb.main[_a];     regs->tlb.main[_a] = regs->tlb.main[_b];       regs->tlb.main[_b] = p; \
+    p = regs->tlb.storkey[_a];  regs->tlb.storkey[_a] = regs->tlb.storkey[_b]; regs->tlb.storkey[_b] = p; \
+    b = regs->tlb.skey[_a];     regs->tlb.skey[_a] = regs->tlb.skey[_b];       regs->tlb.skey[_b] = b; \
+    b = regs->tlb.common[_a];   regs->tlb.common[_a] = regs->tlb.common[_b];   regs->tlb.common[_b] = b; \
+    b = regs->tlb.protect[_a];  regs->tlb.protect[_a] = regs->tlb.protect[_b]; regs->tlb.protect[_b] = b; \
+    b = regs->tlb.acc[_a];      regs->tlb.acc[_a] = regs->tlb.acc[_b];         regs->tlb.acc[_b] = b; \
+} while (0)
+
+    /* Way 0 holds the page; only the access was insufficient */
+    if (TLB_WAY_MATCH(ix))
+        return;
+
+    for (w = 1; w < ways; w++)
+        if (TLB_WAY_MATCH(ix + w * TLB_SETS))
+            break;
+
+    if (w < ways)
+        regs->tlbwayhits++;
+    else
+    {
+        regs->tlbmisses++;
+        w = ways - 1;
+        if ((regs->tlb.TLB_VADDR(ix + w * TLB_SETS) & TLBID_BYTEMASK)
+            == regs->tlbID)
+            regs->tlbconflicts++;
+    }
+
+    /* Rotate way w to the front */
+    for ( ; w > 0; w--)
+    {
+        TLB_WAY_SWAP(ix + w * TLB_SETS, ix + (w - 1) * TLB_SETS);
+        TLB_RMAP_SET(&regs->tlb, ix + w * TLB_SETS,
+                     regs->tlb.TLB_PTE(ix + w * TLB_SETS));
+    }
+    TLB_RMAP_SET(&regs->tlb, ix, regs->tlb.TLB_PTE(ix));
+
+#undef TLB_WAY_MATCH
+#undef TLB_WAY_SWAP
+
+} /* end function tlb_select */
+#endif /*defined(OPTION_TLB_WAYS)*/
+
+
 /*-------------------------------------------------------------------*/
 /* Convert logical address to absolute address and check protection  */
 /*                                                                   */
@@ -2186,6 +2562,11 @@ RADR    aaddr;                          /* Absolute address          */
 RADR    apfra;                          /* Abs page frame address    */
 int     ix = TLBIX(addr);               /* TLB index                 */
 
+#if defined(OPTION_TLB_WAYS)
+    /* Bring the matching or least recently used way to way 0 */
+    ARCH_DEP(tlb_select) (addr, arn, regs);
+#endif
+
     /* Convert logical address to real address */
     if ( (REAL_MODE(&regs->psw) || arn == USE_REAL_ADDR)
 #if defined(FEATURE_INTERPRETIVE_EXECUTION)
@@ -2210,6 +2591,7 @@ int     ix = TLBIX(addr);               /* TLB index                 */
         regs->tlb.TLB_ASD(ix)   = TLB_REAL_ASD;
         regs->tlb.TLB_VADDR(ix) = (addr & TLBID_PAGEMASK) | regs->tlbID;
         regs->tlb.TLB_PTE(ix)   = addr & TLBID_PAGEMASK;
+        TLB_RMAP_SET(&regs->tlb, ix, regs->tlb.TLB_PTE(ix));
         regs->tlb.acc[ix]       =
         regs->tlb.common[ix]    =
         regs->tlb.protect[ix]   = 0;
@@ -2245,7 +2627,10 @@ int     ix = TLBIX(addr);               /* TLB index                 */
         regs->tlb.protect[ix] |= regs->hostregs->dat.protect;
 
         if ( REAL_MODE(&regs->psw) || (arn == USE_REAL_ADDR) )
+        {
             regs->tlb.TLB_PTE(ix)   = addr & TLBID_PAGEMASK;
+            TLB_RMAP_SET(&regs->tlb, ix, regs->tlb.TLB_PTE(ix));
+        }
 
         /* Indicate a host real space entry for a XC dataspace */
         if (arn > 0 && MULTIPLE_CONTROLLED_DATA_SPACE(regs))
@@ -295,6 +295,13 @@ U32   code;
         ARCH_DEP(pseudo_timer) (code, r1, r2, regs);
         break;
 
+    case 0x010:
+    /*---------------------------------------------------------------*/
+    /* Diagnose 010: Release Pages                                   */
+    /*---------------------------------------------------------------*/
+        ARCH_DEP(diag_release_pages) (r1, r2, regs);
+        break;
+
     case 0x024:
     /*---------------------------------------------------------------*/
     /* Diagnose 024: Device Type and Features                        */
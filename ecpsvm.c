@@ -452,7 +452,7 @@ VADR effective_addr1, effective_addr2; \
 #define SPT(_x) \
 { \
     set_cpu_timer(regs,EVM_LD(_x)); \
-    OBTAIN_INTLOCK(regs); \
+    OBTAIN_CPULOCK(regs); \
     if(CPU_TIMER(regs) < 0) \
     { \
         ON_IC_PTIMER(regs); \
@@ -461,7 +461,7 @@ VADR effective_addr1, effective_addr2; \
     { \
         OFF_IC_PTIMER(regs); \
     } \
-    RELEASE_INTLOCK(regs); \
+    RELEASE_CPULOCK(regs); \
 }
 
 #define CHARGE_STOP(_x) \
@@ -160,11 +160,28 @@ typedef struct  _PSW {
 #define SGMASK(p)             ( (p)->progmask & BIT(PSW_SGBIT) )
 
 /* Structure definition for translation-lookaside buffer entry */
-#define TLBN            1024            /* Number TLB entries        */
-#define TLB_MASK        0x3FF           /* Mask for 1024 entries     */
+/* With OPTION_TLB_WAYS the TLB is TLB_SETS sets of up to            */
+/* TLB_MAXWAYS entries each.  Entry (way * TLB_SETS + set) holds     */
+/* a given way, so that way 0 is the entry that MADDR checks.        */
+/* Every REGS embeds room for TLB_MAXWAYS ways, which makes the TLB */
+/* four times the direct mapped size, so the option is off by default*/
+#define TLB_SETS        1024            /* Number TLB sets           */
+#if defined(OPTION_TLB_WAYS)
+#define TLB_MAXWAYS     4               /* Maximum entries per set   */
+#define TLB_ENTRIES     (TLB_SETS * sysblk.tlbways) /* Entries in use*/
+#else
+#define TLB_MAXWAYS     1
+#define TLB_ENTRIES     TLBN
+#endif
+#define TLBN            (TLB_SETS * TLB_MAXWAYS) /* Number TLB entries*/
+#define TLB_MASK        0x3FF           /* Mask for 1024 sets        */
 #define TLB_REAL_ASD_L  0xFFFFFFFF      /* ASD values for real mode  */
 #define TLB_REAL_ASD_G  0xFFFFFFFFFFFFFFFFULL
 #define TLB_HOST_ASD    0x800           /* Host entry for XC guest   */
+#define TLB_RHASHN      1024            /* Reverse map hash buckets  */
+#define TLB_RHEAD       0xFFFF          /* rprev of first in bucket  */
+#define TLB_LARGEN      64              /* Number large frame entries*/
+#define TLB_LARGE_MASK  0x3F            /* Mask for 64 entries       */
 typedef struct _TLB  {
         DW              asd[TLBN];      /* Address space designator  */
 #define TLB_ASD_G(_n)   asd[(_n)].D
@@ -181,6 +198,20 @@ typedef struct _TLB  {
         BYTE            common[TLBN];   /* 1=Page in common segment  */
         BYTE            protect[TLBN];  /* 1=Page in protected segmnt*/
         BYTE            acc[TLBN];      /* Access type flags         */
+                                        /* Reverse map by page frame,
+                                           links are entry index + 1 */
+        U16             rhead[TLB_RHASHN]; /* First entry of bucket  */
+        U16             rnext[TLBN];    /* Next entry in bucket      */
+        U16             rprev[TLBN];    /* Previous entry, TLB_RHEAD
+                                           or 0 if not mapped        */
+        U16             rbucket[TLBN];  /* Bucket of the entry       */
+                                        /* EDAT segment frames, one
+                                           entry maps 1M (ESAME only)*/
+        DW              lasd[TLB_LARGEN];    /* Address space desig. */
+        DW              lvaddr[TLB_LARGEN];  /* Virtual address|tlbID*/
+        DW              lsfaa[TLB_LARGEN];   /* Segment frame address*/
+        BYTE            lcommon[TLB_LARGEN]; /* 1=Common segment     */
+        BYTE            lprotect[TLB_LARGEN];/* 1=Protected segment  */
     } TLB;
 
 /* TLB Notes -
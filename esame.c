@@ -980,15 +980,17 @@ U64     old;                            /* Old value                 */
 
     if (regs->psw.cc == 0)
     {
+        CS_BACKOFF_RESET(regs);
+
         /* Perform requested funtion specified as per request code in r2 */
         if (regs->GR_L(r2) & 3)
         {
             OBTAIN_INTLOCK(regs);
-            SYNCHRONIZE_CPUS(regs);
             if (regs->GR_L(r2) & 1)
-                ARCH_DEP(purge_tlb_all)();
+                ARCH_DEP(purge_tlb_all)(regs);
             if (regs->GR_L(r2) & 2)
-                ARCH_DEP(purge_alb_all)();
+                ARCH_DEP(purge_alb_all)(regs);
+            ARCH_DEP(purge_wait)(regs);
             RELEASE_INTLOCK(regs);
         }
     }
@@ -996,10 +998,9 @@ U64     old;                            /* Old value                 */
     {
         PTT_CSF("*CSPG",regs->GR_L(r1),regs->GR_L(r2),regs->psw.IA_L);
 
-        /* Otherwise yield */
+        /* Otherwise back off */
         regs->GR_G(r1) = CSWAP64(old);
-        if (sysblk.cpus > 1)
-            sched_yield();
+        CS_BACKOFF(regs);
     }
 
     /* Perform serialization after completing operation */
@@ -1107,8 +1108,8 @@ BYTE   *mn;                             /* Mainstor address of ASCE  */
            to the POP which only specifies the minimum set of entries
            which must be cleared from the TLB. */
         OBTAIN_INTLOCK(regs);
-        SYNCHRONIZE_CPUS(regs);
-        ARCH_DEP(purge_tlb_all)();
+        ARCH_DEP(purge_tlb_all)(regs);
+        ARCH_DEP(purge_wait)(regs);
         RELEASE_INTLOCK(regs);
 
     } /* end if(invalidation-and-clearing) */
@@ -1122,8 +1123,8 @@ BYTE   *mn;                             /* Mainstor address of ASCE  */
            to the POP which only specifies the minimum set of entries
            which must be cleared from the TLB. */
         OBTAIN_INTLOCK(regs);
-        SYNCHRONIZE_CPUS(regs);
-        ARCH_DEP(purge_tlb_all)();
+        ARCH_DEP(purge_tlb_all)(regs);
+        ARCH_DEP(purge_wait)(regs);
         RELEASE_INTLOCK(regs);
 
     } /* end else(clearing-by-ASCE) */
@@ -2171,7 +2172,7 @@ U64     gr0, gr1;                       /* Result register workareas */
         longjmp(regs->progjmp, SIE_INTERCEPT_INST);
 #endif /*defined(_FEATURE_SIE)*/
 
-    OBTAIN_INTLOCK(regs);
+    OBTAIN_CPULOCK(regs);
 
     /* Save the CPU timer value */
     dreg = cpu_timer(regs);
@@ -2186,7 +2187,7 @@ U64     gr0, gr1;                       /* Result register workareas */
            and we are enabled for such interrupts *JJ */
         if( OPEN_IC_PTIMER(regs) )
         {
-            RELEASE_INTLOCK(regs);
+            RELEASE_CPULOCK(regs);
             UPD_PSW_IA(regs, PSW_IA(regs, likely(!regs->execflag) ? -6 :
                                                 regs->exrl ? -6 : -4));
             RETURN_INTCHECK(regs);
@@ -2195,7 +2196,7 @@ U64     gr0, gr1;                       /* Result register workareas */
     else
         OFF_IC_PTIMER(regs);
 
-    RELEASE_INTLOCK(regs);
+    RELEASE_CPULOCK(regs);
 
     /* The value of the current CPU timer is subtracted from the first
        operand and the result is placed in general register 0 */
@@ -2453,9 +2454,10 @@ U64     old;                            /* old value                 */
         }
         else
 #endif /*defined(_FEATURE_ZSIE)*/
-            if (sysblk.cpus > 1)
-                sched_yield();
+            CS_BACKOFF(regs);
     }
+    else
+        CS_BACKOFF_RESET(regs);
 
 } /* end DEF_INST(compare_and_swap_long) */
 #endif /*defined(FEATURE_ESAME)*/
@@ -2517,9 +2519,10 @@ U64     old1, old2;                     /* old value                 */
         }
         else
 #endif /*defined(_FEATURE_ZSIE)*/
-            if (sysblk.cpus > 1)
-                sched_yield();
+            CS_BACKOFF(regs);
     }
+    else
+        CS_BACKOFF_RESET(regs);
 
 } /* end DEF_INST(compare_double_and_swap_long) */
 #endif /*defined(FEATURE_ESAME)*/
@@ -6887,9 +6890,10 @@ U32     old;                            /* old value                 */
         }
         else
 #endif /*defined(_FEATURE_SIE)*/
-            if (sysblk.cpus > 1)
-                sched_yield();
+            CS_BACKOFF(regs);
     }
+    else
+        CS_BACKOFF_RESET(regs);
 
 } /* end DEF_INST(compare_and_swap_y) */
 #endif /*defined(FEATURE_LONG_DISPLACEMENT)*/
@@ -6949,9 +6953,10 @@ U64     old, new;                       /* old, new values           */
         }
         else
 #endif /*defined(_FEATURE_SIE)*/
-            if (sysblk.cpus > 1)
-                sched_yield();
+            CS_BACKOFF(regs);
     }
+    else
+        CS_BACKOFF_RESET(regs);
 
 } /* end DEF_INST(compare_double_and_swap_y) */
 #endif /*defined(FEATURE_LONG_DISPLACEMENT)*/
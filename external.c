@@ -221,12 +221,16 @@ U16     servcode;      /* Service Signal or Block I/O Interrupt code */
     /* External interrupt if emergency signal is pending */
     if (OPEN_IC_EMERSIG(regs))
     {
+        /* Emergency signals are posted under the cpulock */
+        OBTAIN_CPULOCK(regs);
+
         /* Find first CPU which generated an emergency signal */
         for (cpuad = 0; regs->emercpu[cpuad] == 0; cpuad++)
         {
             if (cpuad >= sysblk.maxcpu)
             {
                 OFF_IC_EMERSIG(regs);
+                RELEASE_CPULOCK(regs);
                 return;
             }
         } /* end for(cpuad) */
@@ -253,6 +257,8 @@ U16     servcode;      /* Service Signal or Block I/O Interrupt code */
             }
         } /* end while */
 
+        RELEASE_CPULOCK(regs);
+
         /* Generate emergency signal interrupt */
         ARCH_DEP(external_interrupt) (EXT_EMERGENCY_SIGNAL_INTERRUPT, regs);
     }
@@ -263,12 +269,15 @@ U16     servcode;      /* Service Signal or Block I/O Interrupt code */
 //  /*debug*/logmsg (_("External interrupt: External Call from CPU %d\n"),
 //  /*debug*/       regs->extccpu);
 
-        /* Reset external call pending */
+        /* Reset external call pending, which is posted under
+           the cpulock together with the originating CPU address */
+        OBTAIN_CPULOCK(regs);
         OFF_IC_EXTCALL(regs);
 
         /* Store originating CPU address at PSA+X'84' */
         psa = (void*)(regs->mainstor + regs->PX);
         STORE_HW(psa->extcpad,regs->extccpu);
+        RELEASE_CPULOCK(regs);
 
         /* Generate external call interrupt */
         ARCH_DEP(external_interrupt) (EXT_EXTERNAL_CALL_INTERRUPT, regs);
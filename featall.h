@@ -95,6 +95,20 @@
 
 #undef  OPTION_FOOTPRINT_BUFFER /* 2048 ** Size must be a power of 2 */
 #undef  OPTION_INSTRUCTION_COUNTING     /* First use trace and count */
+#undef  OPTION_PREDECODE_CACHE          /* Per-page predecoded insts */
+#undef  OPTION_BLOCK_DISPATCH           /* Hot basic block dispatch  */
+#define OPTION_GUEST_PROFILER           /* Sampling PSW profiler     */
+#define OPTION_BRANCH_TARGET_CACHE      /* Recent instruction pages  */
+#undef  OPTION_TLB_WAYS                 /* Set associative TLB       */
+#undef  OPTION_TLB_HIT_COUNTING         /* Count MADDR TLB hits      */
+
+#if defined(OPTION_BLOCK_DISPATCH) && !defined(OPTION_PREDECODE_CACHE)
+  #error OPTION_BLOCK_DISPATCH requires OPTION_PREDECODE_CACHE
+#endif
+
+#if defined(__GNUC__) && !defined(NO_THREADED_DISPATCH)
+#define OPTION_THREADED_DISPATCH        /* Computed goto dispatch    */
+#endif
 #define OPTION_CKD_KEY_TRACING          /* Trace CKD search keys     */
 #undef  MODEL_DEPENDENT_STCM            /* STCM, STCMH always store  */
 #define OPTION_NOP_MODEL158_DIAGNOSE    /* NOP mod 158 specific diags*/
@@ -110,6 +110,7 @@
 #undef TLB_PAGEMASK
 #undef TLB_BYTEMASK
 #undef TLB_PAGESHIFT
+#undef TLB_RFRAME
 #undef TLBID_PAGEMASK
 #undef TLBID_BYTEMASK
 #undef ASD_PRIVATE
@@ -210,6 +211,7 @@ s370_ ## _name
 #define TLB_PAGEMASK  0x00FFF800
 #define TLB_BYTEMASK  0x000007FF
 #define TLB_PAGESHIFT 11
+#define TLB_RFRAME(_pte) (((U32)(_pte) & 0xFFF0) >> 4)
 #define TLBID_PAGEMASK  0x00E00000
 #define TLBID_BYTEMASK  0x001FFFFF
 #define ASD_PRIVATE   SEGTAB_370_CMN
@@ -345,6 +347,7 @@ s390_ ## _name
 #define TLB_PAGEMASK  0x7FFFF000
 #define TLB_BYTEMASK  0x00000FFF
 #define TLB_PAGESHIFT 12
+#define TLB_RFRAME(_pte) (((U32)(_pte) & 0x7FFFF000) >> 12)
 #define TLBID_PAGEMASK  0x7FC00000
 #define TLBID_BYTEMASK  0x003FFFFF
 #define ASD_PRIVATE   STD_PRIVATE
@@ -497,6 +500,7 @@ z900_ ## _name
 #define TLB_PAGEMASK  0xFFFFFFFFFFFFF000ULL
 #define TLB_BYTEMASK  0x0000000000000FFFULL
 #define TLB_PAGESHIFT 12
+#define TLB_RFRAME(_pte) ((U32)((U64)(_pte) >> 12))
 #define TLBID_PAGEMASK  0xFFFFFFFFFFC00000ULL
 #define TLBID_BYTEMASK  0x00000000003FFFFFULL
 #define ASD_PRIVATE   (ASCE_P|ASCE_R)
@@ -850,6 +854,7 @@ do { \
    &&  likely((((_addr) & TLBID_PAGEMASK) | (_regs)->tlbID) == (_regs)->tlb.TLB_VADDR(TLBIX(_addr))) \
    &&  likely((_acctype) & (_regs)->tlb.acc[TLBIX(_addr)]) \
    ? ( \
+       TLB_COUNT_HIT((_regs)), \
        ((_acctype) & ACC_CHECK) ? \
        (_regs)->dat.storkey = (_regs)->tlb.storkey[TLBIX(_addr)], \
        MAINADDR((_regs)->tlb.main[TLBIX(_addr)], (_addr)) : \
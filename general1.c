@@ -2095,11 +2095,11 @@ U32     old;                            /* old value                 */
         }
         else
 #endif /*defined(_FEATURE_SIE)*/
-            if (sysblk.cpus > 1)
-                sched_yield();
+            CS_BACKOFF(regs);
     }
     else
     {
+        CS_BACKOFF_RESET(regs);
         ITIMER_UPDATE(addr2,4-1,regs);
     }
 }
@@ -2160,11 +2160,11 @@ U64     old, new;                       /* old, new values           */
         }
         else
 #endif /*defined(_FEATURE_SIE)*/
-            if (sysblk.cpus > 1)
-                sched_yield();
+            CS_BACKOFF(regs);
     }
     else
     {
+        CS_BACKOFF_RESET(regs);
         ITIMER_UPDATE(addr2,8-1,regs);
     }
 }
@@ -320,6 +320,7 @@ int     r1, r3;                         /* Lenght values             */
 int     b2, b4;                         /* Values of base registers  */
 VADR    effective_addr2,
         effective_addr4;                /* Effective addresses       */
+int     ploix;                          /* PLO lock table index      */
 
     SS(inst, regs, r1, r3, b2, effective_addr2,
                                      b4, effective_addr4);
@@ -371,10 +372,17 @@ VADR    effective_addr2,
     {
         /* gpr1/ar1 indentify the program lock token, which is used
            to select a lock from the model dependent number of locks
-           in the configuration.  We simply use 1 lock which is the
-           main storage access lock which is also used by CS, CDS
-           and TS.                                               *JJ */
-        OBTAIN_MAINLOCK(regs);
+           in the configuration.  By default we simply use 1 lock
+           which is the main storage access lock which is also used
+           by CS, CDS and TS.  The compare and swap functions below
+           use plain fetches and stores, so they are only interlocked
+           with CS, CDS and TS because of that.  In "plolock striped"
+           mode we hash the PLT address into a table of PLO_LOCKS
+           locks instead, which serializes PLOs against each other
+           only.  The index is taken before the operation, which
+           replaces gpr1 when r1 or r3 is 1.                     *JJ */
+        ploix = PLO_LOCKIX(regs->GR(1));
+        OBTAIN_PLOLOCK(regs, ploix);
 
         switch(regs->GR_L(0) & PLO_GPR0_FC)
         {
@@ -483,14 +491,16 @@ VADR    effective_addr2,
 
         }
 
-        /* Release main-storage access lock */
-        RELEASE_MAINLOCK(regs);
+        /* Release the PLO lock or main-storage access lock */
+        RELEASE_PLOLOCK(regs, ploix);
 
-        if(regs->psw.cc && sysblk.cpus > 1)
+        if(regs->psw.cc)
         {
             PTT_CSF("*PLO",regs->GR_L(0),regs->GR_L(r1),regs->psw.IA_L);
-            sched_yield();
+            CS_BACKOFF(regs);
         }
+        else
+            CS_BACKOFF_RESET(regs);
 
     }
 }
@@ -1460,11 +1470,11 @@ BYTE    old;                            /* Old value                 */
         }
         else
 #endif /*defined(_FEATURE_SIE)*/
-            if (sysblk.cpus > 1)
-                sched_yield();
+            CS_BACKOFF(regs);
     }
     else
     {
+        CS_BACKOFF_RESET(regs);
         ITIMER_UPDATE(effective_addr2,0,regs);
     }
 }
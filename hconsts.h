@@ -358,6 +358,68 @@
 #define CTC_PTP        10               /* PTP link to TCP/IP stack  */
 #define CTC_CTCE       11               /* Enhanced CTC link via TCP */
 
+/*-------------------------------------------------------------------*/
+/* Host thread affinity classes and NUMA storage policies            */
+/*-------------------------------------------------------------------*/
+
+#define AFFINITY_CPU    0               /* Emulated CPU threads      */
+#define AFFINITY_TOD    1               /* Timer (TOD clock) thread  */
+#define AFFINITY_DEV    2               /* Device threads            */
+#define AFFINITY_CCKD   3               /* cckd readahead and writer */
+#define AFFINITY_QETH   4               /* QETH Activate Queues loop */
+#define AFFINITY_LCS    5               /* LCS port threads          */
+#define AFFINITY_CLASSES 6              /* Number of affinity classes*/
+
+#define MAX_HOST_CPUS   1024            /* Highest host CPU + 1      */
+#define MAX_HOST_NODES  64              /* Highest NUMA node + 1     */
+
+#define NUMA_NONE       0               /* Host default placement    */
+#define NUMA_INTERLEAVE 1               /* Interleave across nodes   */
+#define NUMA_BIND       2               /* Bind to nodes             */
+
+/*-------------------------------------------------------------------*/
+/* Host page backing of main and expanded storage                    */
+/*-------------------------------------------------------------------*/
+
+#define HUGEPG_NONE     0               /* Normal host pages (heap)  */
+#define HUGEPG_THP      1               /* Transparent huge pages    */
+#define HUGEPG_2M       2               /* hugetlbfs 2M pages        */
+#define HUGEPG_1G       3               /* hugetlbfs 1G pages        */
+#define HUGEPG_FILE     4               /* Shared file (FILE=)       */
+
+/*-------------------------------------------------------------------*/
+/* Shared main storage file (STORFILE header identification)         */
+/*-------------------------------------------------------------------*/
+
+#define STORFILE_ID       "HERCSTOR"    /* STORFILE id field         */
+#define STORFILE_VERSION  1             /* STORFILE version field    */
+
+/*-------------------------------------------------------------------*/
+/* Core image loading and saving (loadmem.c)                         */
+/*-------------------------------------------------------------------*/
+
+#define LOADMEM_MAP_MIN   (64 * ONE_MEGABYTE)   /* Map larger files  */
+#define LOADMEM_SLICE     (16 * ONE_MEGABYTE)   /* Unit of work      */
+#define LOADMEM_THREADS   16                    /* Most threads      */
+
+/*-------------------------------------------------------------------*/
+/* Sparse core image (savecore ... sparse).  A SPARSECORE_HDRLEN     */
+/* byte header is followed by an index of SPARSECORE_COUNT extents,  */
+/* each a U64 offset from the start of the range saved and a U64     */
+/* length, in ascending order, and then by the data of the extents.  */
+/* Storage in the range but in no extent is zero.  All fields are    */
+/* big-endian.                                                       */
+/*-------------------------------------------------------------------*/
+
+#define SPARSECORE_ID       "HERCSPRS"  /* Identifier, 8 bytes       */
+#define SPARSECORE_VER      8           /* U32 version...            */
+#define SPARSECORE_VERSION  1           /* ...current version        */
+#define SPARSECORE_START    16          /* U64 address of range      */
+#define SPARSECORE_LENGTH   24          /* U64 bytes in range        */
+#define SPARSECORE_COUNT    32          /* U64 number of extents     */
+#define SPARSECORE_HDRLEN   40
+#define SPARSECORE_EXTLEN   16          /* Index entry length        */
+
 /*-------------------------------------------------------------------*/
 /* Minimum, maximum and default scripting timeout values             */
 /*-------------------------------------------------------------------*/
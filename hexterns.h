@@ -298,6 +298,13 @@ int  configure_cpu_priority(int prio);
 int  configure_dev_priority(int prio);
 int  configure_tod_priority(int prio);
 int  configure_srv_priority(int prio);
+int  configure_affinity(int aclass, int cpu, const char *cpulist);
+CONF_DLL_IMPORT void apply_thread_affinity(int aclass, int cpu);
+int  configure_numa(int policy, const char *nodes);
+CONF_DLL_IMPORT const char *hugepg_name(int back);
+CONF_DLL_IMPORT void storage_release(BYTE *addr, size_t len, int back);
+CONF_DLL_IMPORT int  storage_resident(BYTE *addr, size_t len, U64 *resident);
+CONF_DLL_IMPORT int  storage_sync();
 
 int  configure_shrdport(U16 shrdport);
 #define MAX_ARGS  1024                  /* Max argv[] array size     */
@@ -329,6 +336,9 @@ BYTE als_update_pending(void);
 /* Global data areas and functions in module cpu.c                   */
 extern const char* arch_name[];
 extern const char* get_arch_mode_string(REGS* regs);
+#if defined(OPTION_INSTRUCTION_COUNTING)
+void icount_sample(REGS *regs, U64 *cnt);
+#endif
 
 /* Functions in module panel.c */
 void expire_kept_msgs(int unconditional);
@@ -471,6 +481,18 @@ void set_cpmid(BYTE *name);
 LOADPARM_DLL_IMPORT char *str_cpid();
 void get_mpfactors(BYTE *dest);
 
+/* Functions in module loadmem.c */
+typedef struct _LOADMEM_EXT {           /* Extent of storage to copy */
+    BYTE   *dst;                        /* Destination               */
+    BYTE   *src;                        /* Source                    */
+    U64     len;                        /* Length                    */
+} LOADMEM_EXT;
+void loadmem_copy(LOADMEM_EXT *ext, int count, const char *what);
+void loadmem_scan(BYTE *stor, U64 len, BYTE *map);
+int  loadmem_map_file(int fd, U64 off, U64 len, BYTE *dst, const char *what);
+int  loadmem_save_file(int fd, U64 off, BYTE *src, U64 len, const char *what);
+int  loadmem_save_sparse(int fd, RADR aaddr, RADR aaddr2);
+
 /* Functions in module impl.c */
 IMPL_DLL_IMPORT int impl(int,char **);
 int quit_cmd(int argc, char *argv[],char *cmdline);
@@ -595,6 +617,7 @@ int exec_cmd(int argc, char *argv[],char *cmdline);
 
 /* Functions in module sr.c */
 int suspend_cmd(int argc, char *argv[],char *cmdline);
+int checkpoint_cmd(int argc, char *argv[],char *cmdline);
 int resume_cmd(int argc, char *argv[],char *cmdline);
 
 /* Functions in ecpsvm.c that are not *direct* instructions */
@@ -646,6 +669,8 @@ CHAN_DLL_IMPORT int  Dequeue_IO_Interrupt         (IOINT* io);
 CHAN_DLL_IMPORT int  Dequeue_IO_Interrupt_QLocked (IOINT* io);
 CHAN_DLL_IMPORT void Update_IC_IOPENDING          ();
 CHAN_DLL_IMPORT void Update_IC_IOPENDING_QLocked  ();
+CHAN_DLL_IMPORT void Wakeup_IO_CPU                ();
+CHAN_DLL_IMPORT void Wakeup_IO_CPU_QLocked        ();
 
 #define QUEUE_IO_INTERRUPT              Queue_IO_Interrupt
 #define QUEUE_IO_INTERRUPT_QLOCKED      Queue_IO_Interrupt_QLocked
@@ -653,5 +678,7 @@ CHAN_DLL_IMPORT void Update_IC_IOPENDING_QLocked  ();
 #define DEQUEUE_IO_INTERRUPT_QLOCKED    Dequeue_IO_Interrupt_QLocked
 #define UPDATE_IC_IOPENDING             Update_IC_IOPENDING
 #define UPDATE_IC_IOPENDING_QLOCKED     Update_IC_IOPENDING_QLocked
+#define WAKEUP_IO_CPU                   Wakeup_IO_CPU
+#define WAKEUP_IO_CPU_QLOCKED           Wakeup_IO_CPU_QLocked
 
 #endif // _HEXTERNS_H
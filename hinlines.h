@@ -496,12 +496,31 @@ synchronize_cpus(REGS* regs)
 #define WAKEUP_CPU_MASK     wakeup_cpu_mask
 #define WAKEUP_CPUS_MASK    wakeup_cpus_mask
 
+/*-------------------------------------------------------------------*/
+/*  Wake up a CPU                                                    */
+/*  CPU_Wait sleeps on the CPU's own wakeup event, which is posted   */
+/*  under the CPU's wakelock only, so waking a CPU needs no shared   */
+/*  lock.  The wakelock is never held while obtaining another lock.  */
+/*  Stepping and SIE waits still wait on intcond under intlock.      */
+/*-------------------------------------------------------------------*/
 static INLINE void wakeup_cpu( REGS* regs )
 {
+    int cpu = regs->cpuad;
+
     signal_condition( &regs->intcond );
+
+    obtain_lock( &sysblk.wakelock[ cpu ] );
+    sysblk.wakeset[ cpu ] = 1;
+    signal_condition( &sysblk.wakecond[ cpu ] );
+    release_lock( &sysblk.wakelock[ cpu ] );
 }
 
-static INLINE void wakeup_cpu_mask( CPU_BITMAP mask )
+/*-------------------------------------------------------------------*/
+/*  Wake up exactly one CPU of mask which is in the wait state       */
+/*  Returns 1 if a CPU was woken, 0 if none of them was waiting.     */
+/*  CPUs that are running will see the interrupt state themselves.   */
+/*-------------------------------------------------------------------*/
+static INLINE int wakeup_cpu_mask( CPU_BITMAP mask )
 {
     REGS   *current_regs;
     REGS   *lru_regs = NULL;
@@ -509,6 +528,8 @@ static INLINE void wakeup_cpu_mask( CPU_BITMAP mask )
     TOD     lru_waittod;
     int     i;
 
+    mask &= sysblk.waiting_mask;
+
     if (mask)
     {
         for (i=0; mask; mask >>= 1, ++i)
@@ -546,7 +567,9 @@ static INLINE void wakeup_cpu_mask( CPU_BITMAP mask )
 
         /* Wake up the least recently used CPU */
         wakeup_cpu( lru_regs );
+        return 1;
     }
+    return 0;
 }
 
 static INLINE void wakeup_cpus_mask( CPU_BITMAP mask )
@@ -602,6 +625,21 @@ static INLINE void Release_Interrupt_Lock( REGS* regs )
     release_lock( &sysblk.intlock );
 }
 
+/*-------------------------------------------------------------------*/
+/*  Wake up a CPU after an interrupt was posted to it without the    */
+/*  interrupt lock (see cpuint.h).  A CPU about to wait sets its     */
+/*  sysblk.waiting_mask bit before checking for pending interrupts,  */
+/*  so only a CPU whose bit is already on needs to be woken.  The    */
+/*  caller holds the target's cpulock, which keeps regs valid.       */
+/*-------------------------------------------------------------------*/
+static INLINE void wakeup_posted_cpu( REGS* regs )
+{
+    HOST_MB();
+
+    if (sysblk.waiting_mask & regs->hostregs->cpubit)
+        wakeup_cpu( regs->hostregs );
+}
+
 
 #undef asm
 
@@ -474,6 +474,91 @@ typedef int CMPFUNC(const void*, const void*);
    } \
  } while (0)
 
+/*-------------------------------------------------------------------*/
+/*      Obtain/Release cpulock                                       */
+/*      Serializes the timer and interrupt state of one CPU with     */
+/*      the timer thread and with SIGP orders targeting that CPU     */
+/*      Must not be held while obtaining intlock                     */
+/*-------------------------------------------------------------------*/
+
+#define OBTAIN_CPULOCK(_regs)   obtain_lock((_regs)->cpulock)
+#define RELEASE_CPULOCK(_regs)  release_lock((_regs)->cpulock)
+
+/*-------------------------------------------------------------------*/
+/*      Obtain/Release the PLO lock for a program lock token         */
+/*      The PLT address selects one of PLO_LOCKS locks, so that PLOs */
+/*      naming the same lock word serialize while PLOs on unrelated  */
+/*      lock words proceed in parallel.  In "plolock main" mode, the */
+/*      default, the mainlock is used instead so that PLO interlocks */
+/*      with CS, CDS and TS, which the lock table does not.          */
+/*-------------------------------------------------------------------*/
+
+#define PLO_LOCKIX(_plt) \
+ ((int)((((U64)(_plt)) >> 3) ^ (((U64)(_plt)) >> 11)) & (PLO_LOCKS-1))
+
+#define OBTAIN_PLOLOCK(_regs, _ix) \
+ do { \
+  if ((_regs)->sysblk->plomainlock) \
+   OBTAIN_MAINLOCK((_regs)); \
+  else if ((_regs)->hostregs->cpubit != (_regs)->sysblk->started_mask) { \
+   if (try_obtain_lock(&(_regs)->sysblk->plolock[(_ix)])) { \
+    (_regs)->hostregs->plowaits++; \
+    obtain_lock(&(_regs)->sysblk->plolock[(_ix)]); \
+   } \
+   (_regs)->sysblk->ploowner[(_ix)] = (_regs)->hostregs->cpuad; \
+   (_regs)->hostregs->plocount++; \
+  } \
+ } while (0)
+
+#define RELEASE_PLOLOCK(_regs, _ix) \
+ do { \
+   if ((_regs)->sysblk->ploowner[(_ix)] == (_regs)->hostregs->cpuad) { \
+     (_regs)->sysblk->ploowner[(_ix)] = LOCK_OWNER_NONE; \
+     release_lock(&(_regs)->sysblk->plolock[(_ix)]); \
+   } \
+   RELEASE_MAINLOCK((_regs)); \
+ } while (0)
+
+/* Release any PLO lock held by a CPU leaving an instruction early */
+#define RELEASE_PLOLOCKS(_regs) \
+ do { \
+  int _ix; \
+  for (_ix = 0; _ix < PLO_LOCKS; _ix++) \
+   if ((_regs)->sysblk->ploowner[_ix] == (_regs)->hostregs->cpuad) { \
+     (_regs)->sysblk->ploowner[_ix] = LOCK_OWNER_NONE; \
+     release_lock(&(_regs)->sysblk->plolock[_ix]); \
+   } \
+ } while (0)
+
+/*-------------------------------------------------------------------*/
+/*      Back off after a failed interlocked update                   */
+/*      Each consecutive failure spins twice as long as the last,    */
+/*      and the host CPU is only yielded once CS_SPIN_MAX is reached */
+/*      A successful update calls CS_BACKOFF_RESET to end the run    */
+/*-------------------------------------------------------------------*/
+
+#define CS_SPIN_MAX     1024            /* Longest spin in pauses    */
+
+#define CS_BACKOFF(_regs) \
+ do { \
+  if ((_regs)->sysblk->cpus > 1) { \
+   if ((_regs)->csspin < CS_SPIN_MAX) { \
+    U32 _n; \
+    (_regs)->csspin = (_regs)->csspin ? (_regs)->csspin << 1 : 1; \
+    for (_n = 0; _n < (_regs)->csspin; _n++) \
+     HOST_PAUSE(); \
+   } else { \
+    (_regs)->csspin = 0; \
+    sched_yield(); \
+   } \
+  } \
+ } while (0)
+
+#define CS_BACKOFF_RESET(_regs) \
+ do { \
+  (_regs)->csspin = 0; \
+ } while (0)
+
 /*-------------------------------------------------------------------*/
 /*      Obtain/Release crwlock                                       */
 /*      crwlock can be obtained by any thread                        */
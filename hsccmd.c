@@ -1457,6 +1457,390 @@ int iodelay_cmd(int argc, char *argv[], char *cmdline)
 }
 #endif /* #ifdef OPTION_IODELAY_KLUDGE */
 
+#if defined(OPTION_BLOCK_DISPATCH)
+/*-------------------------------------------------------------------*/
+/* bbdisp command - display or set basic block dispatch mode        */
+/*-------------------------------------------------------------------*/
+int bbdisp_cmd(int argc, char *argv[], char *cmdline)
+{
+    int     i;
+    BBC    *bbc;
+
+    UNREFERENCED(cmdline);
+
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if ( argc == 2 )
+    {
+        if ( CMD(argv[1],on,2) )
+            sysblk.bbdisp = TRUE;
+        else if ( CMD(argv[1],off,3) )
+            sysblk.bbdisp = FALSE;
+        else
+        {
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+        if ( MLVL(VERBOSE) )
+            WRMSG( HHC02204, "I", argv[0], sysblk.bbdisp ? "on" : "off" );
+        return 0;
+    }
+
+    WRMSG( HHC02203, "I", argv[0], sysblk.bbdisp ? "on" : "off" );
+
+    for (i = 0; i < sysblk.maxcpu; i++)
+    {
+        obtain_lock(&sysblk.cpulock[i]);
+        if (IS_CPU_ONLINE(i) && (bbc = sysblk.regs[i]->bbc) != NULL)
+            WRMSG( HHC02350, "I", PTYPSTR(i), i, bbc->builds, bbc->execs,
+                   bbc->insts, bbc->exits, bbc->stale );
+        release_lock(&sysblk.cpulock[i]);
+    }
+
+    return 0;
+}
+#endif /* defined(OPTION_BLOCK_DISPATCH) */
+
+#if defined(OPTION_THREADED_DISPATCH)
+/*-------------------------------------------------------------------*/
+/* threaded command - display or set threaded dispatch mode          */
+/*-------------------------------------------------------------------*/
+int threaded_cmd(int argc, char *argv[], char *cmdline)
+{
+    UNREFERENCED(cmdline);
+
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if ( argc == 2 )
+    {
+        if ( CMD(argv[1],on,2) )
+            sysblk.threaded = TRUE;
+        else if ( CMD(argv[1],off,3) )
+            sysblk.threaded = FALSE;
+        else
+        {
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+        if ( MLVL(VERBOSE) )
+            WRMSG( HHC02204, "I", argv[0], sysblk.threaded ? "on" : "off" );
+    }
+    else
+        WRMSG( HHC02203, "I", argv[0], sysblk.threaded ? "on" : "off" );
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* fusion command - display or set instruction pair fusion           */
+/*-------------------------------------------------------------------*/
+int fusion_cmd(int argc, char *argv[], char *cmdline)
+{
+    static const char *pairname[FUSE_PAIRS] = {
+        "C*+BRC", "C*+BC", "LTR+BRC", "L+ST", "LA+BRCT", "ICM+BRC" };
+    U64     count[FUSE_PAIRS];
+    int     i, j;
+
+    UNREFERENCED(cmdline);
+
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if ( argc == 2 )
+    {
+        if ( CMD(argv[1],on,2) )
+            sysblk.nofusion = FALSE;
+        else if ( CMD(argv[1],off,3) )
+            sysblk.nofusion = TRUE;
+        else if ( CMD(argv[1],reset,5) )
+        {
+            for (i = 0; i < sysblk.maxcpu; i++)
+            {
+                obtain_lock(&sysblk.cpulock[i]);
+                if (IS_CPU_ONLINE(i))
+                    memset(sysblk.regs[i]->fusecnt, 0,
+                           sizeof(sysblk.regs[i]->fusecnt));
+                release_lock(&sysblk.cpulock[i]);
+            }
+            return 0;
+        }
+        else
+        {
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+        if ( MLVL(VERBOSE) )
+            WRMSG( HHC02204, "I", argv[0], sysblk.nofusion ? "off" : "on" );
+        return 0;
+    }
+
+    WRMSG( HHC02203, "I", argv[0], sysblk.nofusion ? "off" : "on" );
+
+    memset(count, 0, sizeof(count));
+    for (i = 0; i < sysblk.maxcpu; i++)
+    {
+        obtain_lock(&sysblk.cpulock[i]);
+        if (IS_CPU_ONLINE(i))
+            for (j = 0; j < FUSE_PAIRS; j++)
+                count[j] += sysblk.regs[i]->fusecnt[j];
+        release_lock(&sysblk.cpulock[i]);
+    }
+    for (j = 0; j < FUSE_PAIRS; j++)
+        WRMSG( HHC02351, "I", pairname[j], count[j] );
+
+    return 0;
+}
+#endif /* defined(OPTION_THREADED_DISPATCH) */
+
+#if defined(OPTION_TLB_WAYS)
+/*-------------------------------------------------------------------*/
+/* tlbways_cmd - display or set the TLB associativity               */
+/*-------------------------------------------------------------------*/
+int tlbways_cmd(int argc, char *argv[], char *cmdline)
+{
+    REGS   *regs;
+    char    buf[8];
+    int     ways;
+    int     i;
+
+    UNREFERENCED(cmdline);
+
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if ( argc == 2 && CMD(argv[1],reset,5) )
+    {
+        for (i = 0; i < sysblk.maxcpu; i++)
+        {
+            obtain_lock(&sysblk.cpulock[i]);
+            if (IS_CPU_ONLINE(i))
+            {
+                regs = sysblk.regs[i];
+                regs->tlbhits = regs->tlbwayhits =
+                regs->tlbmisses = regs->tlbconflicts = 0;
+            }
+            release_lock(&sysblk.cpulock[i]);
+        }
+        return 0;
+    }
+
+    if ( argc == 2 )
+    {
+        if ( sscanf(argv[1], "%d%c", &ways, buf) != 1
+          || (ways != 1 && ways != 2 && ways != 4) )
+        {
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+
+        OBTAIN_INTLOCK(NULL);
+
+        if (are_any_cpus_started_intlock_held())
+        {
+            RELEASE_INTLOCK(NULL);
+            WRMSG( HHC02389, "E" );
+            return -1;
+        }
+
+        /* Entries beyond the old setting are stale, purge them all */
+        sysblk.tlbways = ways;
+        for (i = 0; i < sysblk.maxcpu; i++)
+            if (IS_CPU_ONLINE(i))
+            {
+                regs = sysblk.regs[i];
+                memset(&regs->tlb.vaddr, 0, TLBN * sizeof(DW));
+                if (regs->guestregs)
+                    memset(&regs->guestregs->tlb.vaddr, 0, TLBN * sizeof(DW));
+            }
+
+        RELEASE_INTLOCK(NULL);
+
+        if ( MLVL(VERBOSE) )
+        {
+            MSGBUF( buf, "%d", ways );
+            WRMSG( HHC02204, "I", argv[0], buf );
+        }
+        return 0;
+    }
+
+    MSGBUF( buf, "%d", sysblk.tlbways );
+    WRMSG( HHC02203, "I", argv[0], buf );
+
+    for (i = 0; i < sysblk.maxcpu; i++)
+    {
+        obtain_lock(&sysblk.cpulock[i]);
+        if (IS_CPU_ONLINE(i))
+        {
+            regs = sysblk.regs[i];
+            WRMSG( HHC02355, "I", PTYPSTR(i), i, regs->tlbhits,
+                   regs->tlbwayhits, regs->tlbmisses, regs->tlbconflicts );
+        }
+        release_lock(&sysblk.cpulock[i]);
+    }
+
+    return 0;
+}
+#endif /* defined(OPTION_TLB_WAYS) */
+
+/*-------------------------------------------------------------------*/
+/* plolock_cmd - display or set PERFORM LOCKED OPERATION locking     */
+/*-------------------------------------------------------------------*/
+int plolock_cmd(int argc, char *argv[], char *cmdline)
+{
+    REGS   *regs;
+    BYTE    plomainlock;
+    int     i;
+
+    UNREFERENCED(cmdline);
+
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if ( argc == 2 && CMD(argv[1],reset,5) )
+    {
+        for (i = 0; i < sysblk.maxcpu; i++)
+        {
+            obtain_lock(&sysblk.cpulock[i]);
+            if (IS_CPU_ONLINE(i))
+            {
+                regs = sysblk.regs[i];
+                regs->plocount = regs->plowaits = 0;
+            }
+            release_lock(&sysblk.cpulock[i]);
+        }
+        return 0;
+    }
+
+    if ( argc == 2 )
+    {
+        if ( CMD(argv[1],main,4) )
+            plomainlock = TRUE;
+        else if ( CMD(argv[1],striped,7) )
+            plomainlock = FALSE;
+        else
+        {
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+
+        /* A PLO in flight must release the lock it obtained */
+        OBTAIN_INTLOCK(NULL);
+
+        if (are_any_cpus_started_intlock_held())
+        {
+            RELEASE_INTLOCK(NULL);
+            WRMSG( HHC02389, "E" );
+            return -1;
+        }
+
+        sysblk.plomainlock = plomainlock;
+
+        RELEASE_INTLOCK(NULL);
+
+        if ( MLVL(VERBOSE) )
+            WRMSG( HHC02204, "I", argv[0], sysblk.plomainlock ? "main" : "striped" );
+        return 0;
+    }
+
+    WRMSG( HHC02203, "I", argv[0], sysblk.plomainlock ? "main" : "striped" );
+
+    for (i = 0; i < sysblk.maxcpu; i++)
+    {
+        obtain_lock(&sysblk.cpulock[i]);
+        if (IS_CPU_ONLINE(i))
+        {
+            regs = sysblk.regs[i];
+            WRMSG( HHC02356, "I", PTYPSTR(i), i,
+                   regs->plocount, regs->plowaits );
+        }
+        release_lock(&sysblk.cpulock[i]);
+    }
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* wakestats_cmd - display or reset CPU wakeup statistics            */
+/*-------------------------------------------------------------------*/
+int wakestats_cmd(int argc, char *argv[], char *cmdline)
+{
+    REGS   *regs;
+    char    ratio[16];
+    int     i;
+
+    UNREFERENCED(cmdline);
+
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if ( argc == 2 )
+    {
+        if ( !CMD(argv[1],reset,5) )
+        {
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+
+        obtain_lock(&sysblk.iointqlk);
+        sysblk.iointcount = sysblk.iowakeups = 0;
+        release_lock(&sysblk.iointqlk);
+
+        for (i = 0; i < sysblk.maxcpu; i++)
+        {
+            obtain_lock(&sysblk.cpulock[i]);
+            if (IS_CPU_ONLINE(i))
+            {
+                regs = sysblk.regs[i];
+                regs->wakeups = regs->rewaits = 0;
+            }
+            release_lock(&sysblk.cpulock[i]);
+        }
+        return 0;
+    }
+
+    if (sysblk.iointcount)
+        MSGBUF( ratio, "%.2f",
+                (double)sysblk.iowakeups / (double)sysblk.iointcount );
+    else
+        MSGBUF( ratio, "n/a" );
+
+    WRMSG( HHC02357, "I", sysblk.iointcount, sysblk.iowakeups, ratio );
+
+    for (i = 0; i < sysblk.maxcpu; i++)
+    {
+        obtain_lock(&sysblk.cpulock[i]);
+        if (IS_CPU_ONLINE(i))
+        {
+            regs = sysblk.regs[i];
+            WRMSG( HHC02358, "I", PTYPSTR(i), i,
+                   regs->wakeups, regs->rewaits );
+        }
+        release_lock(&sysblk.cpulock[i]);
+    }
+
+    return 0;
+}
+
 /*-------------------------------------------------------------------*/
 /* autoinit_cmd - show or set AUTOINIT switch                        */
 /*-------------------------------------------------------------------*/
@@ -3395,6 +3779,9 @@ int     rc;
 u_int   i;
 u_int   lockreq = 0;
 u_int   locktype = 0;
+int     hugereq = -1;
+char   *filereq = NULL;
+int     nofile = 0;
 U64     mainsize;
 char    check[16];
 BYTE    f = ' ', c = '\0';
@@ -3512,6 +3899,19 @@ BYTE    f = ' ', c = '\0';
             lockreq = 1;
             locktype = 0;
         }
+        else if (strncmp(check, "FILE=", 5) == 0 && argv[i][5])
+            filereq = argv[i] + 5;
+        else if (strcmp(check, "NOFILE") == 0)
+            nofile = 1;
+        else if (strcmp(check, "HUGE") == 0)
+            hugereq = HUGEPG_THP;
+        else if (strcmp(check, "HUGETLB") == 0 ||
+                 strcmp(check, "HUGETLB=2M") == 0)
+            hugereq = HUGEPG_2M;
+        else if (strcmp(check, "HUGETLB=1G") == 0)
+            hugereq = HUGEPG_1G;
+        else if (strcmp(check, "NOHUGE") == 0)
+            hugereq = HUGEPG_NONE;
         else
         {
             WRMSG( HHC01451, "E", argv[i], argv[0] );
@@ -3525,6 +3925,17 @@ BYTE    f = ' ', c = '\0';
     else if (lockreq)
         sysblk.lock_mainstor = locktype;
 
+    /* Set huge page request */
+    if (hugereq >= 0)
+        sysblk.mainhuge = (BYTE)hugereq;
+
+    /* Set shared file request */
+    if (filereq || nofile)
+    {
+        free(sysblk.mainfile);
+        sysblk.mainfile = filereq ? strdup(filereq) : NULL;
+    }
+
     /* Update main storage size */
     rc = configure_storage(mainsize);
     if ( rc >= 0 )
@@ -3558,6 +3969,7 @@ char    check[16];
 char   *q_argv[2] = { "qstor", "xpnd" };
 u_int   lockreq = 0;
 u_int   locktype = 0;
+int     hugereq = -1;
 
     UNREFERENCED(cmdline);
 
@@ -3654,6 +4066,15 @@ u_int   locktype = 0;
             lockreq = 1;
             locktype = 0;
         }
+        else if (strcmp(check, "HUGE") == 0)
+            hugereq = HUGEPG_THP;
+        else if (strcmp(check, "HUGETLB") == 0 ||
+                 strcmp(check, "HUGETLB=2M") == 0)
+            hugereq = HUGEPG_2M;
+        else if (strcmp(check, "HUGETLB=1G") == 0)
+            hugereq = HUGEPG_1G;
+        else if (strcmp(check, "NOHUGE") == 0)
+            hugereq = HUGEPG_NONE;
         else
         {
             // "Invalid value %s specified for %s"
@@ -3665,6 +4086,8 @@ u_int   locktype = 0;
         sysblk.lock_xpndstor = 0;
     else if (lockreq)
         sysblk.lock_xpndstor = locktype;
+    if (hugereq >= 0)
+        sysblk.xpndhuge = (BYTE)hugereq;
 
     rc = configure_xstorage(xpndsize);
     if ( rc >= 0 )
@@ -3996,6 +4419,135 @@ BYTE c;
     return 0;
 }
 
+/*-------------------------------------------------------------------*/
+/* Display the host CPUs a CPU thread is running on                  */
+/*-------------------------------------------------------------------*/
+static void display_cpu_placement(int cpu)
+{
+char cpulist[256];
+
+    if (sysblk.cputid[cpu]
+     && get_thread_affinity( sysblk.cputid[cpu], cpulist, sizeof(cpulist) ))
+        WRMSG( HHC17018, "I", PTYPSTR(cpu), cpu, cpulist );
+}
+
+/*-------------------------------------------------------------------*/
+/* affinity command - host CPUs of threads, NUMA nodes of storage    */
+/*-------------------------------------------------------------------*/
+int affinity_cmd(int argc, char *argv[], char *cmdline)
+{
+static const char *aclass[AFFINITY_CLASSES] =
+    { "CPU", "TOD", "DEV", "CCKD", "QETH", "LCS" };
+U64   mask[MAX_HOST_CPUS / 64];
+char  label[32];
+char *list;
+int   i, cpu = -1;
+BYTE  c;
+
+    UNREFERENCED(cmdline);
+
+    /* Display current placement */
+    if (argc == 1)
+    {
+        for (i = 0; i < AFFINITY_CLASSES; i++)
+            WRMSG( HHC17016, "I", aclass[i],
+                   sysblk.affinity[i] ? sysblk.affinity[i] : "any" );
+        for (i = 0; i < sysblk.maxcpu; i++)
+        {
+            if (sysblk.cpuaffinity[i])
+            {
+                MSGBUF( label, "CPU %s%02X", PTYPSTR(i), i );
+                WRMSG( HHC17016, "I", label, sysblk.cpuaffinity[i] );
+            }
+        }
+        for (i = 0; i < sysblk.maxcpu; i++)
+            if (IS_CPU_ONLINE(i))
+                display_cpu_placement(i);
+        WRMSG( HHC17017, "I",
+               sysblk.numapolicy == NUMA_BIND       ? "bind" :
+               sysblk.numapolicy == NUMA_INTERLEAVE ? "interleave" : "default",
+               sysblk.numapolicy == NUMA_NONE       ? "" : " nodes ",
+               sysblk.numapolicy == NUMA_NONE       ? "" : sysblk.numanodes );
+        return 0;
+    }
+
+    /* affinity NUMA { INTERLEAVE | BIND } nodes | NONE */
+    if (CMD( argv[1], NUMA, 4 ))
+    {
+        int policy, rc;
+
+        if (argc == 3 && CMD( argv[2], NONE, 4 ))
+            policy = NUMA_NONE, list = NULL;
+        else if (argc == 4 && CMD( argv[2], INTERLEAVE, 5 ))
+            policy = NUMA_INTERLEAVE, list = argv[3];
+        else if (argc == 4 && CMD( argv[2], BIND, 4 ))
+            policy = NUMA_BIND, list = argv[3];
+        else
+        {
+            WRMSG( HHC17000, "E" );
+            return -1;
+        }
+        if (list && parse_numlist( list, mask, MAX_HOST_NODES ) <= 0)
+        {
+            WRMSG( HHC02205, "E", list, "" );
+            return -1;
+        }
+        if ((rc = configure_numa( policy, list )) != 0)
+        {
+            if (rc == ENOTSUP)
+                WRMSG( HHC17015, "E", "NUMA" );
+            else
+                WRMSG( HHC17019, "W", strerror(rc) );
+            return -1;
+        }
+        if (MLVL(VERBOSE))
+            WRMSG( HHC02204, "I", "NUMA", list ? list : "NONE" );
+        return 0;
+    }
+
+    /* affinity class [cpu] cpulist | NONE */
+    for (i = 0; i < AFFINITY_CLASSES; i++)
+        if (strcasecmp( argv[1], aclass[i] ) == 0)
+            break;
+    if (i >= AFFINITY_CLASSES
+     || argc < 3 || argc > (i == AFFINITY_CPU ? 4 : 3))
+    {
+        WRMSG( HHC17000, "E" );
+        return -1;
+    }
+
+    if (argc == 4)
+    {
+        if (sscanf( argv[2], "%x%c", &cpu, &c ) != 1
+         || cpu < 0 || cpu >= sysblk.maxcpu)
+        {
+            WRMSG( HHC02205, "E", argv[2], "" );
+            return -1;
+        }
+    }
+
+    list = argv[argc-1];
+    if (CMD( list, NONE, 4 ))
+        list = NULL;
+    else if (parse_numlist( list, mask, MAX_HOST_CPUS ) <= 0)
+    {
+        WRMSG( HHC02205, "E", list, "" );
+        return -1;
+    }
+
+    configure_affinity( i, cpu, list );
+
+    if (MLVL(VERBOSE))
+    {
+        if (cpu >= 0)
+            MSGBUF( label, "CPU %s%02X", PTYPSTR(cpu), cpu );
+        else
+            MSGBUF( label, "%s", aclass[i] );
+        WRMSG( HHC02204, "I", label, list ? list : "NONE" );
+    }
+    return 0;
+}
+
 
 /*-------------------------------------------------------------------*/
 /* numvec command                                                    */
@@ -7270,9 +7822,17 @@ REGS *regs;
     char    pathname[MAX_PATH];         /* fname in host path format */
     time_t  begtime, curtime;           /* progress messages times   */
     char    fmt_mem[8];                 /* #of M/G/etc. saved so far */
+    int     sparse = 0;                 /* Leave out zero pages      */
 
     UNREFERENCED(cmdline);
 
+    /* A trailing 'sparse' asks for a sparse core image */
+    if (argc > 2 && strcasecmp(argv[argc-1], "sparse") == 0)
+    {
+        sparse = 1;
+        argc--;
+    }
+
     if (argc < 2)
     {
         // "Missing argument(s). Type 'help %s' for assistance."
@@ -7375,7 +7935,7 @@ REGS *regs;
 
     hostpath(pathname, fname, sizeof(pathname));
 
-    if ((fd = HOPEN(pathname, O_CREAT|O_WRONLY|O_EXCL|O_BINARY, S_IREAD|S_IWRITE|S_IRGRP)) < 0)
+    if ((fd = HOPEN(pathname, O_CREAT|O_RDWR|O_EXCL|O_BINARY, S_IREAD|S_IWRITE|S_IRGRP)) < 0)
     {
         int saved_errno = errno;
         release_lock(&sysblk.cpulock[sysblk.pcpu]);
@@ -7388,6 +7948,21 @@ REGS *regs;
     total = ((U64)aaddr2 - (U64)aaddr) + 1;
     saved = 0;
 
+    /* Save only the pages that are not zero, or save large ranges
+       through a mapping of the file with several threads */
+    if (sparse
+     || (total >= LOADMEM_MAP_MIN
+      && loadmem_save_file(fd, 0, regs->mainstor + aaddr, total, "saved") == 0))
+    {
+        int rc = sparse ? loadmem_save_sparse(fd, aaddr, aaddr2) : 0;
+        close(fd);
+        release_lock(&sysblk.cpulock[sysblk.pcpu]);
+        if (rc == 0)
+            // "Operation complete"
+            WRMSG(HHC02249, "I");
+        return rc;
+    }
+
     /* Save start time */
     time( &begtime );
 
@@ -8713,6 +9288,8 @@ int qproc_cmd(int argc, char *argv[], char *cmdline)
                                 ( mipsrate % 1000000 ) / 10000,
                                   sysblk.regs[i]->siosrate,
                                   pmsg );
+            if (sysblk.cpuaffinity[i] || sysblk.affinity[AFFINITY_CPU])
+                display_cpu_placement(i);
         }
     }
 
@@ -8728,6 +9305,8 @@ int qstor_cmd(int argc, char *argv[], char *cmdline)
 {
     BYTE    display_main = FALSE;
     BYTE    display_xpnd = FALSE;
+    U64     resident;
+    char    buf[32];
 
     UNREFERENCED(cmdline);
 
@@ -8757,6 +9336,17 @@ int qstor_cmd(int argc, char *argv[], char *cmdline)
     {
         WRMSG( HHC17003, "I", "MAIN", fmt_memsize_KB((U64)sysblk.mainsize >> SHIFT_KIBIBYTE),
                               "main", sysblk.mainstor_locked ? "":"not " );
+        if (sysblk.mainfhdr && sysblk.mainsize)
+            // "Main storage is shared with file %s%s"
+            WRMSG( HHC17022, "I", sysblk.mainfile, "" );
+        else if (sysblk.mainhuge != HUGEPG_NONE && sysblk.mainsize)
+            // "%s storage is backed by %s%s"
+            WRMSG( HHC17020, "I", "Main", hugepg_name(sysblk.mainback), "" );
+        if (sysblk.mainstor && sysblk.mainsize &&
+            storage_resident( sysblk.mainstor, sysblk.mainsize, &resident ) == 0)
+            // "%-8s storage has %s resident in host memory (%d%%)"
+            WRMSG( HHC17021, "I", "MAIN", fmt_memsize_rounded( resident, buf, sizeof(buf) ),
+                   (int)((resident * 100) / sysblk.mainsize) );
     }
 
     if ( display_xpnd )
@@ -8764,6 +9354,15 @@ int qstor_cmd(int argc, char *argv[], char *cmdline)
         WRMSG( HHC17003, "I", "EXPANDED",
                          fmt_memsize_MB((U64)sysblk.xpndsize >> (SHIFT_MEBIBYTE - XSTORE_PAGESHIFT)),
                          "xpnd", sysblk.xpndstor_locked ? "":"not "  );
+        if (sysblk.xpndhuge != HUGEPG_NONE && sysblk.xpndsize)
+            // "%s storage is backed by %s%s"
+            WRMSG( HHC17020, "I", "Expanded", hugepg_name(sysblk.xpndback), "" );
+        if (sysblk.xpndstor && sysblk.xpndsize &&
+            storage_resident( sysblk.xpndstor, (size_t)sysblk.xpndsize * XSTORE_PAGESIZE,
+                              &resident ) == 0)
+            // "%-8s storage has %s resident in host memory (%d%%)"
+            WRMSG( HHC17021, "I", "EXPANDED", fmt_memsize_rounded( resident, buf, sizeof(buf) ),
+                   (int)((resident * 100) / ((U64)sysblk.xpndsize * XSTORE_PAGESIZE)) );
     }
     return 0;
 }
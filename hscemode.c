@@ -311,6 +311,18 @@ DLL_EXPORT int aia_cmd(int argc, char *argv[], char *cmdline)
             regs->AIV_G,regs->aip,regs->ip,regs->aie,(BYTE *)regs->aim);
     WRMSG(HHC02283, "I", buf);
 
+#if defined(OPTION_PREDECODE_CACHE)
+    MSGBUF( buf, "PDC page %p decodes %"PRIu64" resets %"PRIu64,
+            regs->pdcpage,regs->pdc->decodes,regs->pdc->resets);
+    WRMSG(HHC02283, "I", buf);
+#endif /*defined(OPTION_PREDECODE_CACHE)*/
+
+#if defined(OPTION_BRANCH_TARGET_CACHE)
+    MSGBUF( buf, "BTC hits %"PRIu64" fills %"PRIu64,
+            regs->btchits,regs->btcfills);
+    WRMSG(HHC02283, "I", buf);
+#endif /*defined(OPTION_BRANCH_TARGET_CACHE)*/
+
     if (regs->sie_active)
     {
         regs = regs->guestregs;
@@ -333,9 +345,10 @@ DLL_EXPORT int aia_cmd(int argc, char *argv[], char *cmdline)
 /*   The "tlbid" field is part of TLB_VADDR so it must be extracted  */
 /*   whenever it's used or displayed. The TLB_VADDR does not contain */
 /*   all of the effective address bits so they are created on-the-fly*/
-/*   with (i << shift) The "main" field of the tlb contains an XOR   */
-/*   hash of effective address. So MAINADDR() macro is used to remove*/
-/*   the hash before it's displayed.                                 */
+/*   with (i << shift), i being the set index of the TLB entry.      */
+/*   The "main" field of the tlb contains an XOR hash of effective   */
+/*   address. So MAINADDR() macro is used to remove the hash before  */
+/*   it's displayed.                                                 */
 /*                                                                   */
 int tlb_cmd(int argc, char *argv[], char *cmdline)
 {
@@ -370,18 +383,18 @@ int tlb_cmd(int argc, char *argv[], char *cmdline)
     MSGBUF( buf, "tlbID 0x%6.6X mainstor %p",regs->tlbID,regs->mainstor);
     WRMSG(HHC02284, "I", buf);
     WRMSG(HHC02284, "I", "  ix              asd            vaddr              pte   id c p r w ky     main");
-    for (i = 0; i < TLBN; i++)
+    for (i = 0; i < TLB_ENTRIES; i++)
     {
         MSGBUF( buf, "%s%3.3X %16.16"PRIX64" %16.16"PRIX64" %16.16"PRIX64" %4.4X %1d %1d %1d %1d %2.2X %8.8X",
          ((regs->tlb.TLB_VADDR_G(i) & bytemask) == regs->tlbID ? "*" : " "),
          i,regs->tlb.TLB_ASD_G(i),
-         ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)),
+         ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & TLB_MASK) << shift)),
          regs->tlb.TLB_PTE_G(i),(int)(regs->tlb.TLB_VADDR_G(i) & bytemask),
          regs->tlb.common[i],regs->tlb.protect[i],
          (regs->tlb.acc[i] & ACC_READ) != 0,(regs->tlb.acc[i] & ACC_WRITE) != 0,
          regs->tlb.skey[i],
          (unsigned int)(MAINADDR(regs->tlb.main[i],
-                  ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)(i << shift)))
+                  ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)((i & TLB_MASK) << shift)))
                   - regs->mainstor));
         matches += ((regs->tlb.TLB_VADDR(i) & bytemask) == regs->tlbID);
        WRMSG(HHC02284, "I", buf);
@@ -401,18 +414,18 @@ int tlb_cmd(int argc, char *argv[], char *cmdline)
         MSGBUF( buf, "SIE: tlbID 0x%4.4x mainstor %p",regs->tlbID,regs->mainstor);
         WRMSG(HHC02284, "I", buf);
         WRMSG(HHC02284, "I", "  ix              asd            vaddr              pte   id c p r w ky       main");
-        for (i = matches = 0; i < TLBN; i++)
+        for (i = matches = 0; i < TLB_ENTRIES; i++)
         {
             MSGBUF( buf, "%s%3.3X %16.16"PRIX64" %16.16"PRIX64" %16.16"PRIX64" %4.4X %1d %1d %1d %1d %2.2X %8.8X",
              ((regs->tlb.TLB_VADDR_G(i) & bytemask) == regs->tlbID ? "*" : " "),
              i,regs->tlb.TLB_ASD_G(i),
-             ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)),
+             ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & TLB_MASK) << shift)),
              regs->tlb.TLB_PTE_G(i),(int)(regs->tlb.TLB_VADDR_G(i) & bytemask),
              regs->tlb.common[i],regs->tlb.protect[i],
              (regs->tlb.acc[i] & ACC_READ) != 0,(regs->tlb.acc[i] & ACC_WRITE) != 0,
              regs->tlb.skey[i],
              (unsigned int) (MAINADDR(regs->tlb.main[i],
-                     ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)(i << shift)))
+                     ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)((i & TLB_MASK) << shift)))
                     - regs->mainstor));
             matches += ((regs->tlb.TLB_VADDR(i) & bytemask) == regs->tlbID);
            WRMSG(HHC02284, "I", buf);
@@ -1587,13 +1600,261 @@ int count_cmd(int argc, char *argv[], char *cmdline)
 #endif
 
 
+#if defined(OPTION_GUEST_PROFILER)
+/*-------------------------------------------------------------------*/
+/* Profiler sample ordering: by state, address space and address     */
+/*-------------------------------------------------------------------*/
+static int profile_sample_cmp(const void *a, const void *b)
+{
+const PROFSAMP *x = a, *y = b;
+BYTE    xf = x->flags & (PROF_PROB|PROF_SIE|PROF_WAIT);
+BYTE    yf = y->flags & (PROF_PROB|PROF_SIE|PROF_WAIT);
+
+    if (xf != yf)           return xf < yf ? -1 : 1;
+    if (x->asn != y->asn)   return x->asn < y->asn ? -1 : 1;
+    if (x->asce != y->asce) return x->asce < y->asce ? -1 : 1;
+    if (x->ia != y->ia)     return x->ia < y->ia ? -1 : 1;
+    return 0;
+}
+
+/* Aggregated samples: one per distinct state/space/address */
+typedef struct PROFHIT {
+        PROFSAMP samp;                  /* Representative sample     */
+        U32     count;                  /* Number of samples         */
+} PROFHIT;
+
+static int profile_hit_cmp(const void *a, const void *b)
+{
+const PROFHIT *x = a, *y = b;
+
+    return x->count > y->count ? -1 : x->count < y->count ? 1 : 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Collect and aggregate the samples held for all CPUs               */
+/*-------------------------------------------------------------------*/
+static PROFHIT *profile_collect(U32 *nhits, U32 *nsamp)
+{
+PROFSAMP *all;                          /* Samples from all CPUs     */
+PROFHIT *hit;                           /* Aggregated samples        */
+PROFBUF *pb;                            /* -> CPU sample ring        */
+U32     n = 0, h = 0, i, first;         /* Counts and indexes        */
+int     cpu;                            /* CPU index                 */
+int     ncpu = 0;                       /* CPUs with samples         */
+
+    *nhits = *nsamp = 0;
+    for (cpu = 0; cpu < sysblk.maxcpu; cpu++)
+        if (sysblk.profbuf[cpu])
+            ncpu++;
+    if (!ncpu || !(all = malloc(sizeof(PROFSAMP) * PROF_SAMPLES * ncpu)))
+        return NULL;
+
+    for (cpu = 0; cpu < sysblk.maxcpu && ncpu; cpu++)
+    {
+        obtain_lock(&sysblk.cpulock[cpu]);
+        if ((pb = sysblk.profbuf[cpu]) != NULL)
+        {
+            first = pb->head - pb->tail > PROF_SAMPLES ?
+                    pb->head - PROF_SAMPLES : pb->tail;
+            for (i = first; i != pb->head; i++)
+                all[n++] = pb->samp[i % PROF_SAMPLES];
+            ncpu--;
+        }
+        release_lock(&sysblk.cpulock[cpu]);
+    }
+
+    if (n == 0 || !(hit = malloc(sizeof(PROFHIT) * n)))
+    {
+        free(all);
+        return NULL;
+    }
+
+    qsort(all, n, sizeof(PROFSAMP), profile_sample_cmp);
+    for (i = 0; i < n; i++)
+    {
+        if (h && profile_sample_cmp(&hit[h-1].samp, &all[i]) == 0)
+            hit[h-1].count++;
+        else
+        {
+            hit[h].samp = all[i];
+            hit[h++].count = 1;
+        }
+    }
+    free(all);
+
+    *nhits = h;
+    *nsamp = n;
+    return hit;
+}
+
+/*-------------------------------------------------------------------*/
+/* profile command - sample guest PSWs                               */
+/*-------------------------------------------------------------------*/
+int profile_cmd(int argc, char *argv[], char *cmdline)
+{
+PROFHIT *hit;                           /* Aggregated samples        */
+PROFSAMP *ps;                           /* -> Sample                 */
+U32     nhits, nsamp, i, held;          /* Counts and index          */
+int     cpu, top, hz;                   /* Work                      */
+FILE   *f;                              /* Folded stack file         */
+char    c;                              /* sscanf trailing character */
+
+    UNREFERENCED(cmdline);
+
+    if (argc < 2)
+    {
+        for (held = cpu = 0; cpu < sysblk.maxcpu; cpu++)
+        {
+            obtain_lock(&sysblk.cpulock[cpu]);
+            if (sysblk.profbuf[cpu])
+                held += min(sysblk.profbuf[cpu]->head
+                          - sysblk.profbuf[cpu]->tail, PROF_SAMPLES);
+            release_lock(&sysblk.cpulock[cpu]);
+        }
+        WRMSG(HHC02352, "I", sysblk.profhz ? "on" : "off",
+              sysblk.profhz, held);
+        return 0;
+    }
+
+    if (CMD(argv[1],on,2))
+    {
+        hz = PROF_DEFHZ;
+        if (argc > 3
+         || (argc == 3 && (sscanf(argv[2], "%d%c", &hz, &c) != 1
+                           || hz < 1 || hz > PROF_MAXHZ)))
+        {
+            WRMSG(HHC02205, "E", argc > 2 ? argv[2] : "", "");
+            return -1;
+        }
+        sysblk.profhz = hz;
+        if (MLVL(VERBOSE))
+            WRMSG(HHC02204, "I", argv[0], "on");
+        return 0;
+    }
+
+    if (CMD(argv[1],off,3) || CMD(argv[1],reset,5))
+    {
+        if (CMD(argv[1],off,3))
+            sysblk.profhz = 0;
+        for (cpu = 0; cpu < sysblk.maxcpu; cpu++)
+        {
+            obtain_lock(&sysblk.cpulock[cpu]);
+            if (sysblk.profbuf[cpu])
+            {
+                if (!sysblk.profhz)
+                {
+                    free(sysblk.profbuf[cpu]);
+                    sysblk.profbuf[cpu] = NULL;
+                }
+                else
+                    sysblk.profbuf[cpu]->tail = sysblk.profbuf[cpu]->head;
+            }
+            release_lock(&sysblk.cpulock[cpu]);
+        }
+        if (MLVL(VERBOSE))
+            WRMSG(HHC02204, "I", argv[0], sysblk.profhz ? "reset" : "off");
+        return 0;
+    }
+
+    if (CMD(argv[1],top,3))
+    {
+        top = 20;
+        if (argc > 3
+         || (argc == 3 && (sscanf(argv[2], "%d%c", &top, &c) != 1 || top < 1)))
+        {
+            WRMSG(HHC02205, "E", argc > 2 ? argv[2] : "", "");
+            return -1;
+        }
+        if ((hit = profile_collect(&nhits, &nsamp)) == NULL)
+        {
+            WRMSG(HHC02352, "I", sysblk.profhz ? "on" : "off",
+                  sysblk.profhz, 0);
+            return 0;
+        }
+        qsort(hit, nhits, sizeof(PROFHIT), profile_hit_cmp);
+        for (i = 0; i < nhits && i < (U32)top; i++)
+        {
+            ps = &hit[i].samp;
+            WRMSG(HHC02353, "I", (double)hit[i].count * 100 / nsamp,
+                  hit[i].count, (ps->flags & PROF_SIE) ? "guest" : "host",
+                  (ps->flags & PROF_WAIT) ? "wait" :
+                  (ps->flags & PROF_PROB) ? "prob" : "sup",
+                  ps->asn, ps->asce, ps->ia);
+        }
+        free(hit);
+        return 0;
+    }
+
+    if (CMD(argv[1],fold,4))
+    {
+        if (argc != 3)
+        {
+            WRMSG(HHC01455, "E", argv[0]);
+            return -1;
+        }
+        if (!(f = fopen(argv[2], "w")))
+        {
+            WRMSG(HHC02219, "E", "fopen()", strerror(errno));
+            return -1;
+        }
+        hit = profile_collect(&nhits, &nsamp);
+        /* One line per distinct sample in the folded stack format
+           read by flamegraph.pl: frames separated by semicolons,
+           outermost first, followed by the sample count         */
+        for (i = 0; i < nhits; i++)
+        {
+            ps = &hit[i].samp;
+            if (ps->flags & PROF_WAIT)
+                fprintf(f, "%s;wait %u\n",
+                        (ps->flags & PROF_SIE) ? "guest" : "host",
+                        hit[i].count);
+            else
+                fprintf(f, "%s;%s;ASN_%4.4X;PAGE_%"PRIX64";IA_%"PRIX64" %u\n",
+                        (ps->flags & PROF_SIE) ? "guest" : "host",
+                        (ps->flags & PROF_PROB) ? "prob" : "sup",
+                        ps->asn, ps->ia & ~(U64)0xFFF, ps->ia,
+                        hit[i].count);
+        }
+        fclose(f);
+        free(hit);
+        WRMSG(HHC02354, "I", nhits, argv[2]);
+        return 0;
+    }
+
+    WRMSG(HHC02205, "E", argv[1], "");
+    return -1;
+}
+#endif /*defined(OPTION_GUEST_PROFILER)*/
+
 #if defined(OPTION_INSTRUCTION_COUNTING)
+/*-------------------------------------------------------------------*/
+/* Add one processor's instruction map into a total                  */
+/*-------------------------------------------------------------------*/
+static void icount_add(IMAP *sum, IMAP *map)
+{
+    U64    *s = (U64 *)sum, *m = (U64 *)map;
+    size_t  n;
+
+    for (n = 0; n < IMAP_SLOTS; n++)
+        s[n] += m[n];
+}
+
+/* Processor and, once it has used SIE, its guest */
+#define ICOUNT_NEXT_REGS(_regs) \
+    ((_regs)->guestregs != (_regs) ? (_regs)->guestregs : NULL)
+
+/* Estimated host nanoseconds spent in one instruction map slot */
+#define ICOUNT_NS(_map, _i) \
+    ( smp->_map[(_i)] == 0 ? 0 : \
+      (U64)((double)ns->_map[(_i)] / smp->_map[(_i)] * imap->_map[(_i)]) )
+
 /*-------------------------------------------------------------------*/
 /* icount command - display instruction counts                       */
 /*-------------------------------------------------------------------*/
 int icount_cmd(int argc, char *argv[], char *cmdline)
 {
     int i, i1, i2, i3;
+    int bytime;
 
 #define  MAX_ICOUNT_INSTR   1000    /* Maximum number of instructions
                                      in architecture instruction set */
@@ -1601,23 +1862,64 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
     unsigned char opcode1[MAX_ICOUNT_INSTR];
     unsigned char opcode2[MAX_ICOUNT_INSTR];
     U64 count[MAX_ICOUNT_INSTR];
+    U64 nsec[MAX_ICOUNT_INSTR];
+    U64 *key;
     U64 total;
     char buf[128];
+    IMAP *imap, *ns, *smp;
+    REGS *regs;
 
     UNREFERENCED(cmdline);
 
     if ( argc > 1 && CMD(argv[1],clear,5) )
     {
-        memset(IMAP_FIRST, 0, IMAP_SIZE);
+        for (i = 0; i < sysblk.maxcpu; i++)
+        {
+            obtain_lock(&sysblk.cpulock[i]);
+            if (IS_CPU_ONLINE(i))
+                for (regs = sysblk.regs[i]; regs; regs = ICOUNT_NEXT_REGS(regs))
+                {
+                    memset(&regs->imap, 0, sizeof(regs->imap));
+                    memset(&regs->imapns, 0, sizeof(regs->imapns));
+                    memset(&regs->imapsmp, 0, sizeof(regs->imapsmp));
+                    regs->icslot = 0;
+                }
+            release_lock(&sysblk.cpulock[i]);
+        }
+        memset(sysblk.imapused, 0, sizeof(sysblk.imapused));
         WRMSG(HHC02204, "I", "instruction counts", "zero");
         return 0;
     }
 
-    if ( argc > 1 && CMD(argv[1],sort,4) )
+    /* Sum the counts kept by each processor */
+    if (!(imap = calloc(3, sizeof(IMAP))))
+    {
+        WRMSG(HHC02219, "E", "calloc()", strerror(errno));
+        return -1;
+    }
+    ns = imap + 1;
+    smp = imap + 2;
+    for (i = 0; i < sysblk.maxcpu; i++)
+    {
+        obtain_lock(&sysblk.cpulock[i]);
+        if (IS_CPU_ONLINE(i))
+            for (regs = sysblk.regs[i]; regs; regs = ICOUNT_NEXT_REGS(regs))
+            {
+                icount_add(imap, &regs->imap);
+                icount_add(ns, &regs->imapns);
+                icount_add(smp, &regs->imapsmp);
+            }
+        release_lock(&sysblk.cpulock[i]);
+    }
+
+    bytime = argc > 1 && CMD(argv[1],time,4);
+    if ( bytime || (argc > 1 && CMD(argv[1],sort,4)) )
     {
       memset(opcode1,0x00,sizeof(opcode1));
       memset(opcode2,0x00,sizeof(opcode2));
       memset(count,0x00,sizeof(count));
+      memset(nsec,0x00,sizeof(nsec));
+      key = bytime ? nsec : count;
 
       /* Collect */
       i = 0;
@@ -1630,16 +1932,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for ( i2 = 0; i2 < 256; i2++ )
             {
-              if (sysblk.imap01[i2])
+              if (imap->imap01[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imap01[i2];
-                total += sysblk.imap01[i2];
+                nsec[i] = ICOUNT_NS(imap01, i2);
+                count[i++] = imap->imap01[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1) )
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1649,16 +1952,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for ( i2 = 0; i2 < 256; i2++ )
             {
-              if (sysblk.imapa4[i2])
+              if (imap->imapa4[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapa4[i2];
-                total += sysblk.imapa4[i2];
+                nsec[i] = ICOUNT_NS(imapa4, i2);
+                count[i++] = imap->imapa4[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1668,16 +1972,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for ( i2 = 0; i2 < 16; i2++ )
             {
-              if (sysblk.imapa5[i2])
+              if (imap->imapa5[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapa5[i2];
-                total += sysblk.imapa5[i2];
+                nsec[i] = ICOUNT_NS(imapa5, i2);
+                count[i++] = imap->imapa5[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1687,16 +1992,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imapa6[i2])
+              if (imap->imapa6[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapa6[i2];
-                total += sysblk.imapa6[i2];
+                nsec[i] = ICOUNT_NS(imapa6, i2);
+                count[i++] = imap->imapa6[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1706,16 +2012,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 16; i2++)
             {
-              if (sysblk.imapa7[i2])
+              if (imap->imapa7[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapa7[i2];
-                total += sysblk.imapa7[i2];
+                nsec[i] = ICOUNT_NS(imapa7, i2);
+                count[i++] = imap->imapa7[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1725,16 +2032,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imapb2[i2])
+              if (imap->imapb2[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapb2[i2];
-                total += sysblk.imapb2[i2];
+                nsec[i] = ICOUNT_NS(imapb2, i2);
+                count[i++] = imap->imapb2[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1744,16 +2052,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imapb3[i2])
+              if (imap->imapb3[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapb3[i2];
-                total += sysblk.imapb3[i2];
+                nsec[i] = ICOUNT_NS(imapb3, i2);
+                count[i++] = imap->imapb3[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1763,16 +2072,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imapb9[i2])
+              if (imap->imapb9[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapb9[i2];
-                total += sysblk.imapb9[i2];
+                nsec[i] = ICOUNT_NS(imapb9, i2);
+                count[i++] = imap->imapb9[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1782,16 +2092,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 16; i2++)
             {
-              if (sysblk.imapc0[i2])
+              if (imap->imapc0[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapc0[i2];
-                total += sysblk.imapc0[i2];
+                nsec[i] = ICOUNT_NS(imapc0, i2);
+                count[i++] = imap->imapc0[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1801,16 +2112,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 16; i2++)
             {
-              if (sysblk.imapc2[i2])
+              if (imap->imapc2[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapc2[i2];
-                total += sysblk.imapc2[i2];
+                nsec[i] = ICOUNT_NS(imapc2, i2);
+                count[i++] = imap->imapc2[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1820,16 +2132,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 16; i2++)
             {
-              if (sysblk.imapc4[i2])
+              if (imap->imapc4[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapc4[i2];
-                total += sysblk.imapc4[i2];
+                nsec[i] = ICOUNT_NS(imapc4, i2);
+                count[i++] = imap->imapc4[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1839,16 +2152,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 16; i2++)
             {
-              if (sysblk.imapc6[i2])
+              if (imap->imapc6[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapc6[i2];
-                total += sysblk.imapc6[i2];
+                nsec[i] = ICOUNT_NS(imapc6, i2);
+                count[i++] = imap->imapc6[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1858,16 +2172,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 16; i2++)
             {
-              if (sysblk.imapc8[i2])
+              if (imap->imapc8[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapc8[i2];
-                total += sysblk.imapc8[i2];
+                nsec[i] = ICOUNT_NS(imapc8, i2);
+                count[i++] = imap->imapc8[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252, "E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1877,16 +2192,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imape3[i2])
+              if (imap->imape3[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imape3[i2];
-                total += sysblk.imape3[i2];
+                nsec[i] = ICOUNT_NS(imape3, i2);
+                count[i++] = imap->imape3[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1896,16 +2212,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imape4[i2])
+              if (imap->imape4[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imape4[i2];
-                total += sysblk.imape4[i2];
+                nsec[i] = ICOUNT_NS(imape4, i2);
+                count[i++] = imap->imape4[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1915,16 +2232,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imape5[i2])
+              if (imap->imape5[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imape5[i2];
-                total += sysblk.imape5[i2];
+                nsec[i] = ICOUNT_NS(imape5, i2);
+                count[i++] = imap->imape5[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1934,16 +2252,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imapeb[i2])
+              if (imap->imapeb[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapeb[i2];
-                total += sysblk.imapeb[i2];
+                nsec[i] = ICOUNT_NS(imapeb, i2);
+                count[i++] = imap->imapeb[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1953,16 +2272,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imapec[i2])
+              if (imap->imapec[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imapec[i2];
-                total += sysblk.imapec[i2];
+                nsec[i] = ICOUNT_NS(imapec, i2);
+                count[i++] = imap->imapec[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1972,16 +2292,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           {
             for (i2 = 0; i2 < 256; i2++)
             {
-              if (sysblk.imaped[i2])
+              if (imap->imaped[i2])
               {
                 opcode1[i] = i1;
                 opcode2[i] = i2;
-                count[i++] = sysblk.imaped[i2];
-                total += sysblk.imaped[i2];
+                nsec[i] = ICOUNT_NS(imaped, i2);
+                count[i++] = imap->imaped[i2];
+                total += key[i-1];
                 if (i == (MAX_ICOUNT_INSTR-1))
                 {
                   WRMSG(HHC02252,"E");
-                  return 0;
+                  goto icount_done;
                 }
               }
             }
@@ -1989,16 +2310,17 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
           }
           default:
           {
-            if (sysblk.imapxx[i1])
+            if (imap->imapxx[i1])
             {
               opcode1[i] = i1;
               opcode2[i] = 0;
-              count[i++] = sysblk.imapxx[i1];
-              total += sysblk.imapxx[i1];
+              nsec[i] = ICOUNT_NS(imapxx, i1);
+              count[i++] = imap->imapxx[i1];
+              total += key[i-1];
               if (i == (MAX_ICOUNT_INSTR-1))
               {
                 WRMSG(HHC02252,"E");
-                return 0;
+                goto icount_done;
               }
             }
             break;
@@ -2012,21 +2334,24 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
         /* Find Highest */
         for (i2 = i1, i3 = i1; i2 < i; i2++)
         {
-          if (count[i2] > count[i3])
+          if (key[i2] > key[i3])
             i3 = i2;
         }
         /* Exchange */
         opcode1[(MAX_ICOUNT_INSTR-1)] = opcode1[i1];
         opcode2[(MAX_ICOUNT_INSTR-1)] = opcode2[i1];
         count  [(MAX_ICOUNT_INSTR-1)] = count  [i1];
+        nsec   [(MAX_ICOUNT_INSTR-1)] = nsec   [i1];
 
         opcode1[i1] = opcode1[i3];
         opcode2[i1] = opcode2[i3];
         count  [i1] = count  [i3];
+        nsec   [i1] = nsec   [i3];
 
         opcode1[i3] = opcode1[(MAX_ICOUNT_INSTR-1)];
         opcode2[i3] = opcode2[(MAX_ICOUNT_INSTR-1)];
         count  [i3] = count  [(MAX_ICOUNT_INSTR-1)];
+        nsec   [i3] = nsec   [(MAX_ICOUNT_INSTR-1)];
       }
 
 #define  ICOUNT_WIDTH  "12"     /* Print field width */
@@ -2039,127 +2364,127 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
         {
           case 0x01:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xA4:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xA5:
           {
-            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xA6:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xA7:
           {
-            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xB2:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xB3:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xB9:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xC0:
           {
-            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xC2:
           {
-            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xC4:
           {
-            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xC6:
           {
-            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xC8:
           {
-            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xE3:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xE4:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xE5:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xEB:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xEC:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           case 0xED:
           {
-            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], opcode2[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
           default:
           {
-            MSGBUF( buf, "Inst '%2.2X'   count %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], count[i1], (int) (count[i1] * 100 / total));
+            MSGBUF( buf, "Inst '%2.2X'   count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64" (%2d%%)", opcode1[i1], count[i1], nsec[i1], (int) (total ? key[i1] * 100 / total : 0));
             WRMSG(HHC02292, "I", buf);
             break;
           }
         }
       }
-      return 0;
+      goto icount_done;
     }
 
     WRMSG(HHC02292, "I", "Instruction count display:");
@@ -2169,188 +2494,194 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
         {
             case 0x01:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imap01[i2])
+                    if (imap->imap01[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imap01[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imap01[i2], ICOUNT_NS(imap01, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xA4:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imapa4[i2])
+                    if (imap->imapa4[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapa4[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapa4[i2], ICOUNT_NS(imapa4, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xA5:
                 for (i2 = 0; i2 < 16; i2++)
-                    if (sysblk.imapa5[i2])
+                    if (imap->imapa5[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapa5[i2]);
+                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapa5[i2], ICOUNT_NS(imapa5, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xA6:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imapa6[i2])
+                    if (imap->imapa6[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapa6[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapa6[i2], ICOUNT_NS(imapa6, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xA7:
                 for (i2 = 0; i2 < 16; i2++)
-                    if (sysblk.imapa7[i2])
+                    if (imap->imapa7[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapa7[i2]);
+                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapa7[i2], ICOUNT_NS(imapa7, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xB2:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imapb2[i2])
+                    if (imap->imapb2[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapb2[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapb2[i2], ICOUNT_NS(imapb2, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xB3:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imapb3[i2])
+                    if (imap->imapb3[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapb3[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapb3[i2], ICOUNT_NS(imapb3, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xB9:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imapb9[i2])
+                    if (imap->imapb9[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapb9[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapb9[i2], ICOUNT_NS(imapb9, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xC0:
                 for (i2 = 0; i2 < 16; i2++)
-                    if (sysblk.imapc0[i2])
+                    if (imap->imapc0[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapc0[i2]);
+                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapc0[i2], ICOUNT_NS(imapc0, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xC2:                                                      /*@Z9*/
                 for (i2 = 0; i2 < 16; i2++)                                  /*@Z9*/
-                    if (sysblk.imapc2[i2])                                   /*@Z9*/
+                    if (imap->imapc2[i2])                                   /*@Z9*/
                     {
-                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64,  /*@Z9*/
-                            i1, i2, sysblk.imapc2[i2]);                     /*@Z9*/
+                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,  /*@Z9*/
+                            i1, i2, imap->imapc2[i2], ICOUNT_NS(imapc2, i2));                     /*@Z9*/
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;                                                      /*@Z9*/
             case 0xC4:
                 for (i2 = 0; i2 < 16; i2++)
-                    if (sysblk.imapc4[i2])
+                    if (imap->imapc4[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapc4[i2]);
+                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapc4[i2], ICOUNT_NS(imapc4, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xC6:
                 for (i2 = 0; i2 < 16; i2++)
-                    if (sysblk.imapc6[i2])
+                    if (imap->imapc6[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapc6[i2]);
+                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapc6[i2], ICOUNT_NS(imapc6, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xC8:
                 for (i2 = 0; i2 < 16; i2++)
-                    if (sysblk.imapc8[i2])
+                    if (imap->imapc8[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapc8[i2]);
+                        MSGBUF( buf, "Inst '%2.2Xx%1.1X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapc8[i2], ICOUNT_NS(imapc8, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xE3:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imape3[i2])
+                    if (imap->imape3[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imape3[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imape3[i2], ICOUNT_NS(imape3, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xE4:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imape4[i2])
+                    if (imap->imape4[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imape4[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imape4[i2], ICOUNT_NS(imape4, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xE5:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imape5[i2])
+                    if (imap->imape5[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imape5[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imape5[i2], ICOUNT_NS(imape5, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xEB:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imapeb[i2])
+                    if (imap->imapeb[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapeb[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapeb[i2], ICOUNT_NS(imapeb, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xEC:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imapec[i2])
+                    if (imap->imapec[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imapec[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imapec[i2], ICOUNT_NS(imapec, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             case 0xED:
                 for (i2 = 0; i2 < 256; i2++)
-                    if (sysblk.imaped[i2])
+                    if (imap->imaped[i2])
                     {
-                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64,
-                            i1, i2, sysblk.imaped[i2]);
+                        MSGBUF( buf, "Inst '%2.2X%2.2X' count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                            i1, i2, imap->imaped[i2], ICOUNT_NS(imaped, i2));
                         WRMSG(HHC02292, "I", buf);
                     }
                 break;
             default:
-                if (sysblk.imapxx[i1])
+                if (imap->imapxx[i1])
                 {
-                    MSGBUF( buf, "Inst '%2.2X'   count %" ICOUNT_WIDTH PRIu64,
-                        i1, sysblk.imapxx[i1]);
+                    MSGBUF( buf, "Inst '%2.2X'   count %" ICOUNT_WIDTH PRIu64" ns %" ICOUNT_WIDTH PRIu64,
+                        i1, imap->imapxx[i1], ICOUNT_NS(imapxx, i1));
                     WRMSG(HHC02292, "I", buf);
                 }
                 break;
         }
     }
+
+icount_done:
+    free(imap);
     return 0;
 }
 
+#undef ICOUNT_NEXT_REGS
+#undef ICOUNT_NS
+
 #endif /*defined(OPTION_INSTRUCTION_COUNTING)*/
 
 #endif // !defined(_GEN_ARCH)
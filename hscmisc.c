@@ -932,7 +932,10 @@ static REGS  *copy_regs (REGS *regs)
     /* Perform partial copy and clear the TLB */
     memcpy(newregs, regs, sysblk.regs_copy_len);
     memset(&newregs->tlb.vaddr, 0, TLBN * sizeof(DW));
+    memset(&newregs->tlb.lvaddr, 0, TLB_LARGEN * sizeof(DW));
+    TLB_RMAP_RESET(&newregs->tlb);
     newregs->tlbID = 1;
+    INVALIDATE_BTC(newregs);
     newregs->ghostregs = 1;
     newregs->hostregs = newregs;
     newregs->guestregs = NULL;
@@ -945,7 +948,10 @@ static REGS  *copy_regs (REGS *regs)
         hostregs = newregs + 1;
         memcpy(hostregs, regs->hostregs, sysblk.regs_copy_len);
         memset(&hostregs->tlb.vaddr, 0, TLBN * sizeof(DW));
+        memset(&hostregs->tlb.lvaddr, 0, TLB_LARGEN * sizeof(DW));
+        TLB_RMAP_RESET(&hostregs->tlb);
         hostregs->tlbID = 1;
+        INVALIDATE_BTC(hostregs);
         hostregs->ghostregs = 1;
         hostregs->hostregs = hostregs;
         hostregs->guestregs = newregs;
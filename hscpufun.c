@@ -103,7 +103,7 @@ int startall_cmd(int argc, char *argv[], char *cmdline)
                 REGS *regs = sysblk.regs[i];
                 regs->opinterv = 0;
                 regs->cpustate = CPUSTATE_STARTED;
-                signal_condition(&regs->intcond);
+                WAKEUP_CPU(regs);
             }
             mask >>= 1;
         }
@@ -142,7 +142,7 @@ DLL_EXPORT int stopall_cmd(int argc, char *argv[], char *cmdline)
                 regs->opinterv = 1;
                 regs->cpustate = CPUSTATE_STOPPING;
                 ON_IC_INTERRUPT(regs);
-                signal_condition(&regs->intcond);
+                WAKEUP_CPU(regs);
             }
             mask >>= 1;
         }
@@ -283,6 +283,7 @@ static int reset_cmd(int ac,char *av[],char *cmdline,int clear)
     /*  p. 12-5, System-Reset-Clear Key                              */
     /*  p. 12-5, System-Reset-Normal Key                             */
     /*  p. 4-36 -- 4-37, CPU Reset                                   */
+    storage_clear_kept();
     rc = system_reset (sysblk.pcpu, clear, sysblk.arch_mode);
 
     RELEASE_INTLOCK(NULL);
@@ -1267,6 +1267,81 @@ DLL_EXPORT char* FormatTIMEVAL( const TIMEVAL* pTV, char* buf, int bufsz )
 }
 
 
+/*-------------------------------------------------------------------*/
+/* parse_numlist:  "0-3,8,10-11" into a bitmap of maxnum bits        */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int parse_numlist( const char* list, U64* mask, int maxnum )
+{
+    const char* p = list;
+    char*       end;
+    long        lo, hi, i;
+    int         count = 0;
+
+    memset( mask, 0, ((maxnum + 63) / 64) * sizeof( U64 ));
+
+    if (!p || !*p)
+        return -1;
+
+    for (;;)
+    {
+        if (!isdigit( (unsigned char)*p ))
+            return -1;
+        lo = hi = strtol( p, &end, 10 );
+        p = end;
+        if (*p == '-')
+        {
+            if (!isdigit( (unsigned char)*++p ))
+                return -1;
+            hi = strtol( p, &end, 10 );
+            p = end;
+        }
+        if (lo > hi || hi >= maxnum)
+            return -1;
+        for (i = lo; i <= hi; i++)
+        {
+            if (!(mask[ i / 64 ] & (1ULL << (i % 64))))
+            {
+                mask[ i / 64 ] |= (1ULL << (i % 64));
+                count++;
+            }
+        }
+        if (!*p)
+            break;
+        if (*p++ != ',')
+            return -1;
+    }
+    return count;
+}
+
+/*-------------------------------------------------------------------*/
+/* format_numlist: bitmap of maxnum bits as "0-3,8,10-11"            */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT char* format_numlist( const U64* mask, int maxnum, char* buf, size_t bufsz )
+{
+    char item[32];
+    int  i, j;
+
+#define NUMLIST_BIT( n )  (mask[ (n) / 64 ] & (1ULL << ((n) % 64)))
+
+    buf[0] = 0;
+    for (i = 0; i < maxnum; i++)
+    {
+        if (!NUMLIST_BIT( i ))
+            continue;
+        for (j = i; j + 1 < maxnum && NUMLIST_BIT( j + 1 ); j++)
+            ;
+        if (j > i)
+            MSGBUF( item, "%s%d-%d", *buf ? "," : "", i, j );
+        else
+            MSGBUF( item, "%s%d", *buf ? "," : "", i );
+        strlcat( buf, item, bufsz );
+        i = j;
+    }
+    return buf;
+
+#undef NUMLIST_BIT
+}
+
 /*-------------------------------------------------------------------*/
 /* fmt_memsize_rounded:   128K,  64M,  8G,  etc...                   */
 /*-------------------------------------------------------------------*/
@@ -282,6 +282,15 @@ HUT_DLL_IMPORT char* FormatTIMEVAL( const TIMEVAL* pTV, char* buf, int bufsz );
 /*-------------------------------------------------------------------*/
 HUT_DLL_IMPORT char *fmt_memsize_rounded( const U64 memsize, char* buf, const size_t bufsz );
 
+/*-------------------------------------------------------------------*/
+/* parse_numlist:  "0-3,8,10-11" into a bitmap of maxnum bits held   */
+/* in an array of U64.  Returns the number of bits set or -1 if the  */
+/* list is invalid or names a number not less than maxnum.           */
+/* format_numlist: the reverse; returns buf.                         */
+/*-------------------------------------------------------------------*/
+HUT_DLL_IMPORT int   parse_numlist( const char* list, U64* mask, int maxnum );
+HUT_DLL_IMPORT char* format_numlist( const U64* mask, int maxnum, char* buf, size_t bufsz );
+
 /*-------------------------------------------------------------------*/
 /* Standard Utility Initialization                                   */
 /*-------------------------------------------------------------------*/
@@ -54,6 +54,173 @@
 #endif
 
 
+#if defined(OPTION_PREDECODE_CACHE)
+/*-------------------------------------------------------------------*/
+/* Predecoded instruction cache                                      */
+/*                                                                   */
+/* One slot per halfword of a host mainstor page, holding the fully  */
+/* resolved instruction handler (including the second level E3/EB/   */
+/* EC/ED dispatch).  Each entry is tagged with the opcode halfword   */
+/* (and byte 5 for the six byte formats) it was decoded from, so     */
+/* that modified storage is detected on use and simply re-decoded.   */
+/*-------------------------------------------------------------------*/
+#define PDC_PAGES       64              /* Pages cached per CPU      */
+#define PDC_PAGESIZE    4096            /* Host bytes per cache page */
+#define PDC_BYTEMASK    (PDC_PAGESIZE-1)
+#define PDC_ENTRIES     (PDC_PAGESIZE/2)
+#define PDC_HASH(_aip)  (((uintptr_t)(_aip) >> 12) & (PDC_PAGES-1))
+
+struct PDCENT {                         /* Predecoded instruction    */
+        zz_func func;                   /* Resolved handler          */
+        U16     hw;                     /* Opcode halfword (tag)     */
+        BYTE    b5;                     /* Inst byte 5 (tag if ex5)  */
+        BYTE    ex5;                    /* 1=byte 5 selects handler  */
+};
+
+struct PDCPAGE {                        /* One cached mainstor page  */
+        PDCENT  ent[PDC_ENTRIES];       /* Entry per halfword        */
+};
+
+struct PDC {                            /* Per-CPU predecode cache   */
+        const zz_func *oct;             /* Opcode table decoded from */
+        U32     gen;                    /* sysblk.pdcgen at reset    */
+        U64     decodes;                /* Entries (re)decoded       */
+        U64     resets;                 /* Whole cache resets        */
+        PDCPAGE page[PDC_PAGES];        /* Cached pages              */
+};
+#endif /*defined(OPTION_PREDECODE_CACHE)*/
+
+#if defined(OPTION_BLOCK_DISPATCH)
+/*-------------------------------------------------------------------*/
+/* Basic block dispatch cache                                        */
+/*                                                                   */
+/* Straight line runs of general instructions which are entered      */
+/* often are built into a list of resolved handlers which run_cpu    */
+/* calls back to back.  No host code is generated.  A block is keyed */
+/* by its mainstor address and is revalidated against a copy of its  */
+/* instruction bytes.  Each slot counts the entries at its address;  */
+/* the count is halved on a collision and at regular intervals, so   */
+/* only code which is hot now gets built.                            */
+/*-------------------------------------------------------------------*/
+#define BB_BLOCKS       1024            /* Blocks cached per CPU     */
+#define BB_MAXINST      16              /* Max instructions in block */
+#define BB_MAXBYTES     64              /* Max bytes in block        */
+#define BB_HOT          16              /* Entries before a block is
+                                           built                     */
+#define BB_MAXHEAT      1024            /* Heat limit of a slot      */
+#define BB_DECAY        65536           /* Entries between halvings  */
+#define BB_NOBUILD      0xFFFF          /* Heat of unbuildable block */
+#define BB_HASH(_ip)    (((uintptr_t)(_ip) >> 1) & (BB_BLOCKS-1))
+
+struct BBLK {                           /* Basic block               */
+        BYTE   *ip;                     /* Mainstor address of block */
+        const zz_func *oct;             /* Opcode table built from   */
+        U32     gen;                    /* sysblk.pdcgen at build    */
+        U16     stmask;                 /* 1 bit per storing inst    */
+        U16     heat;                   /* Decaying entry count      */
+        BYTE    ninst;                  /* Number of instructions;
+                                           0=not built               */
+        BYTE    nbytes;                 /* Number of bytes           */
+        BYTE    lastoff;                /* Offset of last inst       */
+        zz_func func[BB_MAXINST];       /* Resolved handlers         */
+        BYTE    src[BB_MAXBYTES];       /* Copy of instruction bytes */
+};
+
+struct BBC {                            /* Per-CPU block cache       */
+        U64     builds;                 /* Blocks built              */
+        U64     execs;                  /* Block executions          */
+        U64     insts;                  /* Insts executed in blocks  */
+        U64     exits;                  /* Blocks left early         */
+        U64     stale;                  /* Blocks found modified     */
+        U32     ticks;                  /* Entries since last decay  */
+        BBLK    blk[BB_BLOCKS];         /* Blocks                    */
+};
+#endif /*defined(OPTION_BLOCK_DISPATCH)*/
+
+#if defined(OPTION_INSTRUCTION_COUNTING)
+/*-------------------------------------------------------------------*/
+/* Per-CPU instruction counts, one slot per opcode                   */
+/*-------------------------------------------------------------------*/
+#define ICOUNT_SAMPLE   1024            /* Insts between timings     */
+#define ICOUNT_MAXNS    1000000         /* Longer samples discarded  */
+
+struct IMAP {                           /* Instruction map           */
+        U64 imap01[256];
+        U64 imapa4[256];
+        U64 imapa5[16];
+        U64 imapa6[256];
+        U64 imapa7[16];
+        U64 imapb2[256];
+        U64 imapb3[256];
+        U64 imapb9[256];
+        U64 imapc0[16];
+        U64 imapc2[16];                                         /*@Z9*/
+        U64 imapc4[16];                                         /*208*/
+        U64 imapc6[16];                                         /*208*/
+        U64 imapc8[16];
+        U64 imape3[256];
+        U64 imape4[256];
+        U64 imape5[256];
+        U64 imapeb[256];
+        U64 imapec[256];
+        U64 imaped[256];
+        U64 imapxx[256];
+};
+#define IMAP_SLOTS      (sizeof(IMAP) / sizeof(U64))
+#define IMAP_SLOT(_map, _cnt) ((int)((_cnt) - (_map).imap01))
+#endif /*defined(OPTION_INSTRUCTION_COUNTING)*/
+
+#if defined(OPTION_GUEST_PROFILER)
+/*-------------------------------------------------------------------*/
+/* Guest PSW profiler samples                                        */
+/*                                                                   */
+/* Samples are taken by the timer thread and kept in a ring per      */
+/* CPU; the oldest are overwritten once PROF_SAMPLES have been taken */
+/* since the last reset.  The CPU threads never touch the buffers.   */
+/*-------------------------------------------------------------------*/
+#define PROF_SAMPLES    65536           /* Samples kept per CPU      */
+#define PROF_DEFHZ      100             /* Default samples/second    */
+#define PROF_MAXHZ      10000           /* Maximum samples/second    */
+
+struct PROFSAMP {                       /* One PSW sample            */
+        U64     ia;                     /* Instruction address       */
+        U64     asce;                   /* Primary ASCE or STD       */
+        U16     asn;                    /* Primary ASN               */
+        BYTE    flags;                  /* Sample flags...           */
+#define PROF_PROB       0x01            /* ...problem state          */
+#define PROF_SIE        0x02            /* ...SIE guest              */
+#define PROF_WAIT       0x04            /* ...waiting or stopped     */
+        BYTE    cpuad;                  /* CPU address               */
+};
+
+struct PROFBUF {                        /* Per-CPU sample ring       */
+        U32     head;                   /* Samples taken             */
+        U32     tail;                   /* Samples at last reset     */
+        PROFSAMP samp[PROF_SAMPLES];    /* Sample ring               */
+};
+#endif /*defined(OPTION_GUEST_PROFILER)*/
+
+#if defined(OPTION_BRANCH_TARGET_CACHE)
+/*-------------------------------------------------------------------*/
+/* Branch target cache entry                                         */
+/*                                                                   */
+/* Remembers the host address of a recently executed instruction     */
+/* page so that instfetch can re-establish the AIA for it without a  */
+/* TLB lookup.  An entry is only used while the TLB it was filled    */
+/* from is unchanged and the instruction space and key still match.  */
+/*-------------------------------------------------------------------*/
+#define BTC_ENTRIES     16              /* Entries per CPU           */
+
+struct BTCENT {
+        U64     vaddr;                  /* Virtual page address      */
+        U64     asd;                    /* Instruction space ASD     */
+        BYTE   *aip;                    /* Host page address         */
+        unsigned int tlbID;             /* TLB validation identifier */
+        BYTE    pkey;                   /* PSW key                   */
+};
+#endif /*defined(OPTION_BRANCH_TARGET_CACHE)*/
+
+
 /*-------------------------------------------------------------------*/
 /* Structure definition for CPU register context                     */
 /*                                                                   */
@@ -114,7 +281,18 @@ struct REGS {                           /* Processor registers       */
 /*220*/ U64     bear;                   /* Breaking event address reg*/
 /*228*/ BYTE   *bear_ip;                /* Breaking event inst ptr   */
 
+#if defined(OPTION_PREDECODE_CACHE)
+/*230*/ PDCPAGE *pdcpage;               /* -> Predecoded AIA page    */
+/*238*/ PDC    *pdc;                    /* -> Predecode cache        */
+#if defined(OPTION_BLOCK_DISPATCH)
+/*240*/ BBC    *bbc;                    /* -> Basic block cache      */
+/*248-27F*/                             /* Available...              */
+#else
+/*240-27F*/                             /* Available...              */
+#endif
+#else
 /*230-27F*/                             /* Available...              */
+#endif
 
 
 /*280*/ ALIGN_128
@@ -365,6 +543,69 @@ struct REGS {                           /* Processor registers       */
         U64     regs_copy_end;          /* Copy regs to here         */
      /* ------------------------------------------------------------ */
 
+#if defined(OPTION_THREADED_DISPATCH)
+     /* Fused instruction pair counts, see threaded_execute */
+#define FUSE_COMPARE_BRC        0       /* CR/CLR/C/CHI + BRC        */
+#define FUSE_COMPARE_BC         1       /* CR/CLR/C/CHI + BC         */
+#define FUSE_LTR_BRC            2       /* LTR + BRC                 */
+#define FUSE_L_ST               3       /* L + ST                    */
+#define FUSE_LA_BRCT            4       /* LA + BRCT                 */
+#define FUSE_ICM_BRC            5       /* ICM + BRC                 */
+#define FUSE_PAIRS              6
+        U64     fusecnt[FUSE_PAIRS];
+#endif /*defined(OPTION_THREADED_DISPATCH)*/
+
+#if defined(OPTION_INSTRUCTION_COUNTING)
+     /* Instruction counts, see COUNT_INST and icount_cmd */
+        IMAP    imap;                   /* Executions per opcode     */
+        IMAP    imapns;                 /* Sampled host nanoseconds  */
+        IMAP    imapsmp;                /* Timing samples taken      */
+        U64     icstart;                /* Host ns at sample start   */
+        int     icslot;                 /* Slot being timed + 1      */
+        int     icsample;               /* Insts to next sample      */
+#endif /*defined(OPTION_INSTRUCTION_COUNTING)*/
+
+#if defined(OPTION_BRANCH_TARGET_CACHE)
+        BTCENT  btc[BTC_ENTRIES];       /* Branch target cache       */
+        U64     btchits;                /* Pages found in the cache  */
+        U64     btcfills;               /* Pages added to the cache  */
+#endif /*defined(OPTION_BRANCH_TARGET_CACHE)*/
+
+#if defined(OPTION_TLB_WAYS)
+        U64     tlbhits;                /* MADDR way 0 hits (only if
+                                           OPTION_TLB_HIT_COUNTING)  */
+        U64     tlbwayhits;             /* Hits in ways 1 and above  */
+        U64     tlbmisses;              /* Misses in all ways        */
+        U64     tlbconflicts;           /* Misses evicting a valid
+                                           entry of this tlbID       */
+#endif /*defined(OPTION_TLB_WAYS)*/
+
+        U32     csspin;                 /* Pauses of the last failed
+                                           interlocked update        */
+        U64     plocount;               /* PLO lock-word locks taken */
+        U64     plowaits;               /* ...of which were contended*/
+        U64     wakeups;                /* Waits ended by a wakeup   */
+        U64     rewaits;                /* ...which waited again     */
+        BYTE    woken;                  /* 1=Woken, not yet resumed  */
+
+     /* Broadcast purge requests posted by other CPUs (intlock)      */
+        BYTE    purgereq;               /* Purges pending            */
+#define PURGE_REQ_TLB   0x01            /* Purge the whole TLB       */
+#define PURGE_REQ_TLBE  0x02            /* Purge the TLB entries of
+                                           the frames in purgepfra   */
+#define PURGE_REQ_ALB   0x04            /* Purge the ALB             */
+#define PURGE_TLBE_MAX  16              /* Frames before whole purge */
+        int     purgen;                 /* Entries used in purgepfra */
+        RADR    purgepfra[PURGE_TLBE_MAX]; /* Frames to be purged    */
+        U32     purgeepoch;             /* Purge requests processed  */
+        CPU_BITMAP purgewait;           /* CPUs whose purges we await*/
+        U32     purgeseen[MAX_CPU_ENGINES]; /* Their epochs at post  */
+        const char *purgemsg;           /* ptt 'inf' message of the
+                                           purge being timed or NULL */
+        RADR    purgetag;               /* ...its first frame        */
+        int     purgecpus;              /* ...CPUs purged or posted  */
+        struct timespec purgets;        /* ...host time of first post*/
+
      /* Runtime opcode tables, use replace_opcode to modify */
         const zz_func *s370_runtime_opcode_xxxx,
                *s370_runtime_opcode_e3________xx,
@@ -445,6 +686,24 @@ struct GSYSINFO {
 };
 
 
+/*-------------------------------------------------------------------*/
+/* Shared main storage file header (mainsize FILE=).  The file holds */
+/* this header in its first 4K page, followed by the storage key     */
+/* array at skeyoff and main storage at mainoff, so that another     */
+/* process can map it to inspect the storage of a running system.    */
+/* Fields are in host byte order.                                    */
+/*-------------------------------------------------------------------*/
+struct STORFILE {
+        char    id[8];                  /* STORFILE_ID               */
+        U32     version;                /* STORFILE_VERSION          */
+        U32     keyunit;                /* Bytes per storage key     */
+        U64     mainsize;               /* Main storage size (bytes) */
+        U64     skeyoff;                /* Offset of storage keys    */
+        U64     mainoff;                /* Offset of main storage    */
+        U64     suspended;              /* Stamp of the suspend image*/
+                                        /* written with this storage */
+};
+
 /*-------------------------------------------------------------------*/
 /* Operation Modes                                                   */
 /*-------------------------------------------------------------------*/
@@ -479,10 +738,16 @@ struct SYSBLK {
         BYTE   *storkeys;               /* -> Main storage key array */
         u_int   lock_mainstor:1;        /* Request mainstor to lock  */
         u_int   mainstor_locked:1;      /* Main storage locked       */
+        BYTE    mainhuge;               /* Requested HUGEPG_xxx      */
+        BYTE    mainback;               /* ...and obtained HUGEPG_xxx*/
+        char   *mainfile;               /* Shared main storage file  */
+        STORFILE *mainfhdr;             /* ...and its header         */
         U32     xpndsize;               /* Expanded size in 4K pages */
         BYTE   *xpndstor;               /* -> Expanded storage       */
         u_int   lock_xpndstor:1;        /* Request xpndstor to lock  */
         u_int   xpndstor_locked:1;      /* Expanded storage locked   */
+        BYTE    xpndhuge;               /* Requested HUGEPG_xxx      */
+        BYTE    xpndback;               /* ...and obtained HUGEPG_xxx*/
         U64     todstart;               /* Time of initialisation    */
         U64     cpuid;                  /* CPU identifier for STIDP  */
         U32     cpuserial;              /* CPU serial number         */
@@ -520,6 +785,11 @@ struct SYSBLK {
         U8      cpcai;                  /* Dynamic CP capacity adj.  */
         COND    cpucond;                /* CPU config/deconfig cond  */
         LOCK    cpulock[MAX_CPU_ENGINES];  /* CPU lock               */
+        LOCK    wakelock[MAX_CPU_ENGINES]; /* CPU wakeup event lock  */
+        COND    wakecond[MAX_CPU_ENGINES]; /* CPU wakeup event       */
+        BYTE    wakeset[MAX_CPU_ENGINES];  /* 1=Wakeup event posted  */
+        U64     iointcount;             /* I/O interrupts queued     */
+        U64     iowakeups;              /* CPUs woken for I/O ints   */
         TOD     cpucreateTOD[MAX_CPU_ENGINES];  /* CPU creation time */
         TID     cputid[MAX_CPU_ENGINES];   /* CPU thread identifiers */
         clockid_t                              /* CPU clock     @PJJ */
@@ -574,6 +844,9 @@ struct SYSBLK {
         U16     intowner;               /* Intlock owner             */
 
         LOCK    mainlock;               /* Main storage lock         */
+#define PLO_LOCKS        64             /* PLO lock table entries    */
+        LOCK    plolock[PLO_LOCKS];     /* PLO lock-word locks       */
+        U16     ploowner[PLO_LOCKS];    /* PLO lock owners           */
         LOCK    intlock;                /* Interrupt lock            */
         LOCK    iointqlk;               /* I/O Interrupt Queue lock  */
         LOCK    sigplock;               /* Signal processor lock     */
@@ -770,6 +1043,10 @@ struct SYSBLK {
         int     cpuprio;                /* CPU thread priority       */
         int     devprio;                /* Device thread priority    */
         int     srvprio;                /* Listeners thread priority */
+        char   *affinity[AFFINITY_CLASSES]; /* Host CPU list by class */
+        char   *cpuaffinity[MAX_CPU_ENGINES]; /* ...and by CPU       */
+        int     numapolicy;             /* Mainstor NUMA_xxx policy  */
+        char   *numanodes;              /* ...and host node list     */
         TID     httptid;                /* HTTP listener thread id   */
 
      /* Fields used by SYNCHRONIZE_CPUS */
@@ -777,6 +1054,10 @@ struct SYSBLK {
         CPU_BITMAP sync_mask;           /* CPU mask for syncing CPUs */
         COND    sync_cond;              /* COND for syncing CPU      */
         COND    sync_bc_cond;           /* COND for other CPUs       */
+
+     /* Fields used by broadcast purges */
+        COND    purgecond;              /* COND for purge initiators */
+        int     purgewaiters;           /* Initiators awaiting CPUs  */
 #if defined(OPTION_SHARED_DEVICES)
         TID     shrdtid;                /* Shared device listener    */
         U16     shrdport;               /* Shared device server port */
@@ -803,48 +1084,7 @@ struct SYSBLK {
 #endif
 
 #if defined(OPTION_INSTRUCTION_COUNTING)
-#define IMAP_FIRST sysblk.imap01
-        U64 imap01[256];
-        U64 imapa4[256];
-        U64 imapa5[16];
-        U64 imapa6[256];
-        U64 imapa7[16];
-        U64 imapb2[256];
-        U64 imapb3[256];
-        U64 imapb9[256];
-        U64 imapc0[16];
-        U64 imapc2[16];                                         /*@Z9*/
-        U64 imapc4[16];                                         /*208*/
-        U64 imapc6[16];                                         /*208*/
-        U64 imapc8[16];
-        U64 imape3[256];
-        U64 imape4[256];
-        U64 imape5[256];
-        U64 imapeb[256];
-        U64 imapec[256];
-        U64 imaped[256];
-        U64 imapxx[256];
-#define IMAP_SIZE \
-            ( sizeof(sysblk.imap01) \
-            + sizeof(sysblk.imapa4) \
-            + sizeof(sysblk.imapa5) \
-            + sizeof(sysblk.imapa6) \
-            + sizeof(sysblk.imapa7) \
-            + sizeof(sysblk.imapb2) \
-            + sizeof(sysblk.imapb3) \
-            + sizeof(sysblk.imapb9) \
-            + sizeof(sysblk.imapc0) \
-            + sizeof(sysblk.imapc2) /*@Z9*/ \
-            + sizeof(sysblk.imapc4) /*208*/ \
-            + sizeof(sysblk.imapc6) /*208*/ \
-            + sizeof(sysblk.imapc8) \
-            + sizeof(sysblk.imape3) \
-            + sizeof(sysblk.imape4) \
-            + sizeof(sysblk.imape5) \
-            + sizeof(sysblk.imapeb) \
-            + sizeof(sysblk.imapec) \
-            + sizeof(sysblk.imaped) \
-            + sizeof(sysblk.imapxx) )
+        BYTE    imapused[IMAP_SLOTS];   /* 1=First use displayed     */
 #endif
 
         char    *cnslport;              /* console port string       */
@@ -858,6 +1098,31 @@ struct SYSBLK {
         U32     siosrate;               /* IOs per second            */
 #endif /*defined(OPTION_MIPS_COUNTING)*/
 
+#if defined(OPTION_PREDECODE_CACHE)
+        U32     pdcgen;                 /* Opcode table generation   */
+#endif
+#if defined(OPTION_BLOCK_DISPATCH)
+        BYTE    bbdisp;                 /* 1=Block dispatch active   */
+#endif
+#if defined(OPTION_THREADED_DISPATCH)
+        BYTE    threaded;               /* 1=Threaded dispatch mode  */
+        BYTE    nofusion;               /* 1=Instruction pair fusion
+                                           disabled                  */
+        BYTE    thrdrepl[GEN_ARCHCOUNT][256]; /* 1=Opcode replaced;
+                                           not executed inline       */
+#endif
+
+#if defined(OPTION_TLB_WAYS)
+        BYTE    tlbways;                /* TLB entries per set       */
+#endif
+        BYTE    plomainlock;            /* 1=PLO is serialized by
+                                           mainlock, not plolock     */
+
+#if defined(OPTION_GUEST_PROFILER)
+        U32     profhz;                 /* Profiler samples/sec, 0=off*/
+        PROFBUF *profbuf[MAX_CPU_ENGINES]; /* Samples, under cpulock */
+#endif
+
         int     regs_copy_len;          /* Length to copy for REGS   */
 
         REGS    dummyregs;              /* Regs for unconfigured CPU */
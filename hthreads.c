@@ -18,6 +18,30 @@
 
 #include "hercules.h"
 
+/*-------------------------------------------------------------------*/
+/* Lock contention statistics ("locks stats")                        */
+/*                                                                   */
+/* Times are in lockstat_clock ticks (the TSC where available) and   */
+/* are updated while the lock itself is held.  Read locks of R/W     */
+/* locks are shared and are not counted.                             */
+/*-------------------------------------------------------------------*/
+#define LOCKSTAT_BUCKETS  32    /* log2 histogram buckets            */
+
+struct LOCKSTAT                 /* Per-lock contention statistics    */
+{
+    U64          acquired;      /* Times the lock was obtained       */
+    U64          contended;     /* ...of which had to wait for it    */
+    U64          spun;          /* ...of which got it by spinning    */
+    U64          waittot;       /* Total ticks spent waiting         */
+    U64          waitmax;       /* Longest wait                      */
+    U64          holdtot;       /* Total ticks the lock was held     */
+    U64          holdmax;       /* Longest hold                      */
+    U64          holdstart;     /* Clock when obtained, 0=not timed  */
+    U32          waithist[ LOCKSTAT_BUCKETS ]; /* log2 wait ticks    */
+    U32          holdhist[ LOCKSTAT_BUCKETS ]; /* log2 hold ticks    */
+};
+typedef struct LOCKSTAT LOCKSTAT;
+
 /*-------------------------------------------------------------------*/
 /* Hercules Internal ILOCK structure                                 */
 /*-------------------------------------------------------------------*/
@@ -30,6 +54,9 @@ struct ILOCK                    /* Hercules internal ILOCK structure */
     TIMEVAL      time;          /* Time of day when it was obtained  */
     TID          tid;           /* Thread-Id of who obtained it      */
     HLOCK        locklock;      /* Internal ILOCK structure lock     */
+    int          adaptive;      /* 1=spin briefly before blocking    */
+    int          spins;         /* Self-tuned spin count estimate    */
+    LOCKSTAT     stat;          /* Contention statistics             */
     union      {
     HLOCK        lock;          /* The actual locking model mutex    */
     HRWLOCK      rwlock;        /* The actual locking model rwlock   */
@@ -104,6 +131,10 @@ static int         host_low_pri;    /* Host policy minimim priority  */
 static int         host_pri_amt;    /* Host policy priority range    */
 static int         host_pri_rvrsd;  /* More negative is higher prio  */
 
+static BYTE        lockstats;       /* 1=Collect lock statistics     */
+static U64         lockstat_tick0;  /* Clock when collection began   */
+static U64         lockstat_ns0;    /* ...and host nanoseconds then  */
+
 /*-------------------------------------------------------------------*/
 /* Internal macros to control access to our internal locks list      */
 /*-------------------------------------------------------------------*/
@@ -214,6 +245,8 @@ static ILOCK* hthreads_get_ILOCK( void* addr, const char* name )
     ilk->name = name;
     ilk->location = "null:0";
     ilk->tid = 0;
+    ilk->adaptive = 0;
+    ilk->spins = 0;
     ilk->time.tv_sec = 0;
     ilk->time.tv_usec = 0;
 
@@ -222,6 +255,127 @@ static ILOCK* hthreads_get_ILOCK( void* addr, const char* name )
     return ilk;
 }
 
+/*-------------------------------------------------------------------*/
+/* Lock statistics clock: the TSC if available, else nanoseconds     */
+/*-------------------------------------------------------------------*/
+static INLINE U64 lockstat_clock()
+{
+#if defined(_MSVC_) && (defined(_M_IX86) || defined(_M_X64))
+    return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((U64) ts.tv_sec * 1000000000) + ts.tv_nsec;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Host nanoseconds, to calibrate the lock statistics clock          */
+/*-------------------------------------------------------------------*/
+static U64 lockstat_ns()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((U64) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the log2 histogram bucket of a number of ticks             */
+/*-------------------------------------------------------------------*/
+static INLINE int lockstat_bucket( U64 ticks )
+{
+    int b;
+    for (b=0; ticks > 1 && b < LOCKSTAT_BUCKETS-1; ticks >>= 1, b++);
+    return b;
+}
+
+/*-------------------------------------------------------------------*/
+/* Account for a lock just obtained. 'start' is the clock before     */
+/* the thread blocked for the lock, or 0 if it did not have to wait. */
+/*-------------------------------------------------------------------*/
+static void lockstat_obtained( ILOCK* ilk, U64 start, int spun )
+{
+    U64 now  = lockstat_clock();
+    U64 wait;
+
+    ilk->stat.acquired++;
+    if (start)
+    {
+        wait = now - start;
+        ilk->stat.contended++;
+        if (spun)
+            ilk->stat.spun++;
+        ilk->stat.waittot += wait;
+        if (wait > ilk->stat.waitmax)
+            ilk->stat.waitmax = wait;
+        ilk->stat.waithist[ lockstat_bucket( wait ) ]++;
+    }
+    ilk->stat.holdstart = now;
+}
+
+/*-------------------------------------------------------------------*/
+/* Account for the hold time of a lock about to be released          */
+/*-------------------------------------------------------------------*/
+static void lockstat_release( ILOCK* ilk )
+{
+    U64 hold;
+
+    if (ilk->stat.holdstart)
+    {
+        hold = lockstat_clock() - ilk->stat.holdstart;
+        ilk->stat.holdstart = 0;
+        ilk->stat.holdtot += hold;
+        if (hold > ilk->stat.holdmax)
+            ilk->stat.holdmax = hold;
+        ilk->stat.holdhist[ lockstat_bucket( hold ) ]++;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Obtain the mutex of an adaptive lock that is currently busy.      */
+/*                                                                   */
+/* Spin for a while first in the hope the holder releases it soon,   */
+/* which it normally does for the short critical sections these      */
+/* locks protect, sparing us a trip through the kernel. The spin     */
+/* limit tracks a running average of the spins that were needed,     */
+/* the same heuristic as glibc's adaptive mutexes. The estimate is   */
+/* only updated while the lock is held so needs no protection.       */
+/* The spin only reads the owner; a trylock, which must own the      */
+/* mutex cache line, is attempted once the lock looks free.          */
+/* Returns the mutex return code; *spun is set if spinning won.      */
+/*-------------------------------------------------------------------*/
+static INLINE int hthread_adaptive_lock( ILOCK* ilk, int* spun )
+{
+    int rc, cnt, max;
+
+    *spun = 0;
+    if (hostinfo.num_procs <= 1)
+        return hthread_mutex_lock( &ilk->lock );
+
+    max = MIN( HTHREAD_SPIN_MAX, ilk->spins * 2 + 10 );
+    for (cnt=0;; cnt++)
+    {
+        if (cnt >= max)
+        {
+            rc = hthread_mutex_lock( &ilk->lock );
+            break;
+        }
+        HOST_PAUSE();
+        if (*(volatile TID*) &ilk->tid)
+            continue;
+        if ((rc = hthread_mutex_trylock( &ilk->lock )) != EBUSY)
+        {
+            *spun = 1;
+            break;
+        }
+    }
+    if (!rc || EOWNERDEAD == rc)
+        ilk->spins += (cnt - ilk->spins) / 8;
+    return rc;
+}
+
 /*-------------------------------------------------------------------*/
 /* Initialize a lock                                                 */
 /*-------------------------------------------------------------------*/
@@ -264,6 +418,23 @@ fatal:
     exit(1);
 }
 
+/*-------------------------------------------------------------------*/
+/* Initialize an adaptive lock: one which spins for a short, self-   */
+/* tuning period when busy before the thread blocks for it.  Meant   */
+/* for hot locks that are only ever held for very short periods.     */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int  hthread_initialize_adaptive_lock( LOCK* plk, const char* name,
+                                                  const char* location )
+{
+    int     rc;
+    ILOCK*  ilk;
+
+    rc = hthread_initialize_lock( plk, name, location );
+    ilk = (ILOCK*) plk->ilk;
+    ilk->adaptive = 1;
+    return rc;
+}
+
 /*-------------------------------------------------------------------*/
 /* Initialize a R/W lock                                             */
 /*-------------------------------------------------------------------*/
@@ -325,7 +496,9 @@ fatal:
 DLL_EXPORT int  hthread_obtain_lock( LOCK* plk, const char* location )
 {
     int rc;
+    int spun = 0;
     U64 waitdur;
+    U64 statclk = 0;
     ILOCK* ilk;
     TIMEVAL tv;
     ilk = (ILOCK*) plk->ilk;
@@ -334,7 +507,12 @@ DLL_EXPORT int  hthread_obtain_lock( LOCK* plk, const char* location )
     if (EBUSY == rc)
     {
         waitdur = host_tod();
-        rc = hthread_mutex_lock( &ilk->lock );
+        if (lockstats)
+            statclk = lockstat_clock();
+        if (ilk->adaptive)
+            rc = hthread_adaptive_lock( ilk, &spun );
+        else
+            rc = hthread_mutex_lock( &ilk->lock );
         gettimeofday( &tv, NULL );
         waitdur = host_tod() - waitdur;
     }
@@ -348,6 +526,8 @@ DLL_EXPORT int  hthread_obtain_lock( LOCK* plk, const char* location )
         loglock( ilk, rc, "obtain_lock", location );
     if (!rc || EOWNERDEAD == rc)
     {
+        if (lockstats)
+            lockstat_obtained( ilk, statclk, spun );
         hthread_mutex_lock( &ilk->locklock );
         ilk->location = location;
         ilk->tid = hthread_self();
@@ -365,6 +545,8 @@ DLL_EXPORT int  hthread_release_lock( LOCK* plk, const char* location )
     int rc;
     ILOCK* ilk;
     ilk = (ILOCK*) plk->ilk;
+    if (lockstats)
+        lockstat_release( ilk );
     rc = hthread_mutex_unlock( &ilk->lock );
     PTTRACE( "unlock", plk, NULL, location, rc );
     if (rc)
@@ -384,6 +566,8 @@ DLL_EXPORT int  hthread_release_rwlock( RWLOCK* plk, const char* location )
     int rc;
     ILOCK* ilk;
     ilk = (ILOCK*) plk->ilk;
+    if (lockstats)
+        lockstat_release( ilk );
     rc = hthread_rwlock_unlock( &ilk->rwlock );
     PTTRACE( "rwunlock", plk, NULL, location, rc );
     if (rc)
@@ -450,6 +634,8 @@ DLL_EXPORT int  hthread_try_obtain_lock( LOCK* plk, const char* location )
         loglock( ilk, rc, "try_obtain_lock", location );
     if (!rc || EOWNERDEAD == rc)
     {
+        if (lockstats)
+            lockstat_obtained( ilk, 0, 0 );
         hthread_mutex_lock( &ilk->locklock );
         ilk->location = location;
         ilk->tid = hthread_self();
@@ -507,6 +693,7 @@ DLL_EXPORT int  hthread_obtain_wrlock( RWLOCK* plk, const char* location )
 {
     int rc;
     U64 waitdur;
+    U64 statclk = 0;
     ILOCK* ilk;
     TIMEVAL tv;
     ilk = (ILOCK*) plk->ilk;
@@ -515,6 +702,8 @@ DLL_EXPORT int  hthread_obtain_wrlock( RWLOCK* plk, const char* location )
     if (EBUSY == rc)
     {
         waitdur = host_tod();
+        if (lockstats)
+            statclk = lockstat_clock();
         rc = hthread_rwlock_wrlock( &ilk->rwlock );
         gettimeofday( &tv, NULL );
         waitdur = host_tod() - waitdur;
@@ -529,6 +718,8 @@ DLL_EXPORT int  hthread_obtain_wrlock( RWLOCK* plk, const char* location )
         loglock( ilk, rc, "obtain_wrlock", location );
     if (!rc || EOWNERDEAD == rc)
     {
+        if (lockstats)
+            lockstat_obtained( ilk, statclk, 0 );
         hthread_mutex_lock( &ilk->locklock );
         ilk->location = location;
         ilk->tid = hthread_self();
@@ -571,6 +762,8 @@ DLL_EXPORT int  hthread_try_obtain_wrlock( RWLOCK* plk, const char* location )
         loglock( ilk, rc, "try_obtain_wrlock", location );
     if (!rc)
     {
+        if (lockstats)
+            lockstat_obtained( ilk, 0, 0 );
         hthread_mutex_lock( &ilk->locklock );
         ilk->location = location;
         ilk->tid = hthread_self();
@@ -665,7 +858,11 @@ DLL_EXPORT int  hthread_wait_condition( COND* plc, LOCK* plk, const char* locati
     ILOCK* ilk;
     ilk = (ILOCK*) plk->ilk;
     PTTRACE( "wait before", plk, plc, location, PTT_MAGIC );
+    if (lockstats)
+        lockstat_release( ilk );
     rc = hthread_cond_wait( plc, &ilk->lock );
+    if (lockstats)
+        ilk->stat.holdstart = lockstat_clock();
     PTTRACE( "wait after", plk, plc, location, rc );
     if (rc)
         loglock( ilk, rc, "wait_condition", location );
@@ -683,7 +880,11 @@ DLL_EXPORT int  hthread_timed_wait_condition( COND* plc, LOCK* plk,
     ILOCK* ilk;
     ilk = (ILOCK*) plk->ilk;
     PTTRACE( "tw before", plk, plc, location, PTT_MAGIC );
+    if (lockstats)
+        lockstat_release( ilk );
     rc = hthread_cond_timedwait( plc, &ilk->lock, tm );
+    if (lockstats)
+        ilk->stat.holdstart = lockstat_clock();
     PTTRACE( "tw after", plk, plc, location, rc );
     if (rc && ETIMEDOUT != rc)
         loglock( ilk, rc, "timed_wait_condition", location );
@@ -776,6 +977,7 @@ static void* hthread_func( void* arg2 )
     free( arg2 );
     rc = pfn( arg );
     hthread_list_abandoned_locks( tid, NULL );
+    ptt_thread_end();
     return rc;
 }
 
@@ -852,6 +1054,7 @@ DLL_EXPORT void hthread_exit_thread( void* rc, const char* location )
     TID tid;
     tid = hthread_self();
     hthread_list_abandoned_locks( tid, location );
+    ptt_thread_end();
     hthread_exit( rc );
 }
 
@@ -995,6 +1198,102 @@ DLL_EXPORT int  hthread_get_thread_prio( TID tid, const char* location )
     return herc_prio;
 }
 
+/*-------------------------------------------------------------------*/
+/* Restrict a thread to a list of host CPUs such as "0-3,8".  A NULL */
+/* or empty list lets the thread run on any host CPU again.  Returns */
+/* EINVAL if the list is invalid, ENOTSUP if the host can't do it.   */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int  hthread_set_thread_affinity( TID tid, const char* cpulist,
+                                             const char* location )
+{
+    U64  mask[ MAX_HOST_CPUS / 64 ];
+    int  rc, i;
+
+    if (cpulist && *cpulist)
+    {
+        if (parse_numlist( cpulist, mask, MAX_HOST_CPUS ) <= 0)
+            return EINVAL;
+    }
+    else
+        memset( mask, 0xFF, sizeof( mask ));
+
+    if (equal_threads(tid,0))
+        tid = thread_id();
+
+#if defined(_MSVC_)
+    {
+        DWORD_PTR am = 0, sm;
+        if (cpulist && *cpulist)
+        {
+            for (i=0; i < (int)(sizeof( DWORD_PTR ) * 8); i++)
+                if (mask[ i / 64 ] & (1ULL << (i % 64)))
+                    am |= ((DWORD_PTR) 1) << i;
+        }
+        else
+            GetProcessAffinityMask( GetCurrentProcess(), &am, &sm );
+        rc = SetThreadAffinityMask( hthread_win_thread_handle( tid ), am )
+            ? 0 : EINVAL;
+    }
+#elif defined(CPU_SETSIZE)
+    {
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        for (i=0; i < MAX_HOST_CPUS && i < CPU_SETSIZE; i++)
+            if (mask[ i / 64 ] & (1ULL << (i % 64)))
+                CPU_SET( i, &set );
+        rc = pthread_setaffinity_np( (hthread_t) tid, sizeof( set ), &set );
+    }
+#else
+    UNREFERENCED( i );
+    rc = ENOTSUP;
+#endif
+
+    if (rc && ENOTSUP != rc)
+        // "'%s' failed at loc=%s: rc=%d: %s"
+        WRMSG( HHC90020, "W", "set_thread_affinity",
+            TRIMLOC( location ), rc, strerror( rc ));
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Format the list of host CPUs a thread may run on.  Returns NULL   */
+/* if the host can't tell us.                                        */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT char* hthread_get_thread_affinity( TID tid, char* buf, size_t bufsz,
+                                              const char* location )
+{
+#if !defined(_MSVC_) && defined(CPU_SETSIZE)
+    U64       mask[ MAX_HOST_CPUS / 64 ];
+    cpu_set_t set;
+    int       rc, i;
+
+    if (equal_threads(tid,0))
+        tid = thread_id();
+
+    CPU_ZERO( &set );
+    if ((rc = pthread_getaffinity_np( (hthread_t) tid, sizeof( set ), &set )) != 0)
+    {
+        // "'%s' failed at loc=%s: rc=%d: %s"
+        WRMSG( HHC90020, "W", "get_thread_affinity",
+            TRIMLOC( location ), rc, strerror( rc ));
+        return NULL;
+    }
+
+    memset( mask, 0, sizeof( mask ));
+    for (i=0; i < MAX_HOST_CPUS && i < CPU_SETSIZE; i++)
+        if (CPU_ISSET( i, &set ))
+            mask[ i / 64 ] |= (1ULL << (i % 64));
+
+    return format_numlist( mask, MAX_HOST_CPUS, buf, bufsz );
+#else
+    UNREFERENCED( tid );
+    UNREFERENCED( buf );
+    UNREFERENCED( bufsz );
+    UNREFERENCED( location );
+    return NULL;
+#endif
+}
+
 /*-------------------------------------------------------------------*/
 /* locks_cmd helper function: save offline copy of all locks in list */
 /*-------------------------------------------------------------------*/
@@ -1046,6 +1345,146 @@ static int sortby_loc( const ILOCK* p1, const ILOCK* p2 )
 {
     return strcasecmp( p1->location, p2->location );
 }
+static int sortby_wait( const ILOCK* p1, const ILOCK* p2 )
+{
+    return (p1->stat.waittot == p2->stat.waittot) ? 0 :
+           (p1->stat.waittot <  p2->stat.waittot) ? 1 : -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* locks_cmd helper function: reset all lock statistics              */
+/*-------------------------------------------------------------------*/
+static void hthreads_reset_lock_stats()
+{
+    ILOCK*       ilk;               /* Pointer to ILOCK structure    */
+    LIST_ENTRY*  ple;               /* Ptr to LIST_ENTRY structure   */
+
+    LockLocksList();
+    for (ple = locklist.Flink; ple != &locklist; ple = ple->Flink)
+    {
+        ilk = CONTAINING_RECORD( ple, ILOCK, locklink );
+        memset( &ilk->stat, 0, sizeof( LOCKSTAT ));
+    }
+    lockstat_tick0 = lockstat_clock();
+    lockstat_ns0   = lockstat_ns();
+    UnlockLocksList();
+}
+
+/*-------------------------------------------------------------------*/
+/* locks_cmd helper function: format a log2 histogram                */
+/*-------------------------------------------------------------------*/
+static void hthreads_format_lock_hist( char* buf, size_t bufsz,
+                                       U32* hist, double tpns )
+{
+    char   bkt[32];                 /* One "bound:count" entry       */
+    double ns;                      /* Bucket lower bound in ns      */
+    int    b;
+
+    buf[0] = 0;
+    for (b=0; b < LOCKSTAT_BUCKETS; b++)
+    {
+        if (!hist[b])
+            continue;
+        ns = (double)((U64)1 << b) / tpns;
+        if (ns < 1000.0)
+            MSGBUF( bkt, " %.0fns:%u", ns, hist[b] );
+        else if (ns < 1000000.0)
+            MSGBUF( bkt, " %.0fus:%u", ns / 1000.0, hist[b] );
+        else
+            MSGBUF( bkt, " %.0fms:%u", ns / 1000000.0, hist[b] );
+        strlcat( buf, bkt, bufsz );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* locks_cmd helper function: "locks STATS [ON|OFF|RESET|name]"      */
+/*-------------------------------------------------------------------*/
+static int hthreads_lock_stats_cmd( int argc, char* argv[] )
+{
+    ILOCK*       ilk;               /* Pointer to ILOCK array        */
+    char         hist[512];         /* Formatted histogram           */
+    const char*  name = NULL;       /* Lock name for histograms      */
+    double       tpns;              /* Clock ticks per nanosecond    */
+    U64          ns;                /* Nanoseconds collected         */
+    int count, i;
+
+    if (argc > 3)
+        return -1;
+
+    if (argc == 3)
+    {
+        if (strcasecmp( argv[2], "ON" ) == 0)
+        {
+            if (!lockstats)
+            {
+                hthreads_reset_lock_stats();
+                lockstats = TRUE;
+            }
+        }
+        else if (strcasecmp( argv[2], "OFF" ) == 0)
+            lockstats = FALSE;
+        else if (strcasecmp( argv[2], "RESET" ) == 0)
+            hthreads_reset_lock_stats();
+        else
+            name = argv[2];
+
+        if (!name)
+        {
+            // "Lock statistics %s"
+            WRMSG( HHC90024, "I", lockstats ? "on" : "off" );
+            return 0;
+        }
+    }
+
+    // "Lock statistics %s"
+    WRMSG( HHC90024, "I", lockstats ? "on" : "off" );
+
+    /* Calibrate the statistics clock against host nanoseconds */
+
+    ns = lockstat_ns() - lockstat_ns0;
+    tpns = (lockstat_ns0 && ns) ?
+        (double)(lockstat_clock() - lockstat_tick0) / (double) ns : 1.0;
+    if (tpns <= 0.0)
+        tpns = 1.0;
+
+    /* Display the locks used, in descending order of total wait */
+
+    count = hthreads_copy_locks_list( &ilk );
+    if (!count)
+        return 0;
+
+    qsort( ilk, count, sizeof( ILOCK ), (CMPFUNC*) sortby_wait );
+
+    for (i=0; i < count; i++)
+    {
+        if (!ilk[i].stat.acquired)
+            continue;
+        if (name && strcasecmp( name, ilk[i].name ) != 0)
+            continue;
+
+        // "Lock=%s, acquired=%"PRIu64", contended=%"PRIu64", ..."
+        WRMSG( HHC90022, "I", ilk[i].name,
+            ilk[i].stat.acquired, ilk[i].stat.contended, ilk[i].stat.spun,
+            (U64)(ilk[i].stat.waittot / tpns / 1000.0),
+            (U64)(ilk[i].stat.waitmax / tpns / 1000.0),
+            (U64)(ilk[i].stat.holdtot / tpns / 1000.0),
+            (U64)(ilk[i].stat.holdmax / tpns / 1000.0));
+
+        if (name)
+        {
+            hthreads_format_lock_hist( hist, sizeof( hist ),
+                                       ilk[i].stat.waithist, tpns );
+            // "Lock=%s, %s histogram:%s"
+            WRMSG( HHC90023, "I", ilk[i].name, "wait", hist );
+            hthreads_format_lock_hist( hist, sizeof( hist ),
+                                       ilk[i].stat.holdhist, tpns );
+            WRMSG( HHC90023, "I", ilk[i].name, "hold", hist );
+        }
+    }
+
+    free( ilk );
+    return 0;
+}
 
 /*-------------------------------------------------------------------*/
 /* locks_cmd - list internal locks                                   */
@@ -1063,6 +1502,18 @@ DLL_EXPORT int locks_cmd( int argc, char* argv[], char* cmdline )
 
     /*  Format: "locks [ALL|tid|HELD] [SORT NAME|OWNER|TIME|LOC]"  */
     /*  Note:    TID is alias for OWNER,  TOD is alias for TIME.   */
+    /*  Format: "locks STATS [ON|OFF|RESET|name]"                  */
+
+    if (argc >= 2 && strcasecmp( argv[1], "STATS" ) == 0)
+    {
+        rc = hthreads_lock_stats_cmd( argc, argv );
+        if (rc)
+        {
+            // "Missing or invalid argument(s)"
+            WRMSG( HHC17000, "E" );
+        }
+        return rc;
+    }
 
     if (argc <= 1)
         tid = 0;
@@ -235,6 +235,11 @@ typedef void* (THREAD_FUNC)( void* );   /* Generic thread function   */
 #define HTHREAD_MIN_PRI     (+20)       /* (as in *nix "nice" value) */
 #define HTHREAD_MAX_PRI     (-20)       /* (as in *nix "nice" value) */
 
+/*-------------------------------------------------------------------*/
+/*  Maximum number of times an adaptive lock spins before blocking   */
+/*-------------------------------------------------------------------*/
+#define HTHREAD_SPIN_MAX        100
+
 /*-------------------------------------------------------------------*/
 /*                   Hercules lock structures                        */
 /*-------------------------------------------------------------------*/
@@ -256,6 +261,7 @@ typedef struct RWLOCK RWLOCK;
 HT_DLL_IMPORT int  locks_cmd( int argc, char* argv[], char* cmdline );
 
 HT_DLL_IMPORT int  hthread_initialize_lock        ( LOCK* plk, const char* name, const char* location );
+HT_DLL_IMPORT int  hthread_initialize_adaptive_lock( LOCK* plk, const char* name, const char* location );
 HT_DLL_IMPORT int  hthread_obtain_lock            ( LOCK* plk, const char* location );
 HT_DLL_IMPORT int  hthread_try_obtain_lock        ( LOCK* plk, const char* location );
 HT_DLL_IMPORT int  hthread_test_lock              ( LOCK* plk, const char* location );
@@ -293,11 +299,14 @@ HT_DLL_IMPORT HANDLE hthread_win_thread_handle    ( TID tid );
 #endif
 HT_DLL_IMPORT int  hthread_set_thread_prio        ( TID tid, int prio, const char* location );
 HT_DLL_IMPORT int  hthread_get_thread_prio        ( TID tid, const char* location );
+HT_DLL_IMPORT int  hthread_set_thread_affinity    ( TID tid, const char* cpulist, const char* location );
+HT_DLL_IMPORT char* hthread_get_thread_affinity   ( TID tid, char* buf, size_t bufsz, const char* location );
 
 /*-------------------------------------------------------------------*/
 /*               Hercules threading/locking macros                   */
 /*-------------------------------------------------------------------*/
 #define initialize_lock( plk )                  hthread_initialize_lock( plk, #plk, PTT_LOC )
+#define initialize_adaptive_lock( plk )         hthread_initialize_adaptive_lock( plk, #plk, PTT_LOC )
 #define obtain_lock( plk )                      hthread_obtain_lock( plk, PTT_LOC )
 #define try_obtain_lock( plk )                  hthread_try_obtain_lock( plk, PTT_LOC )
 #define test_lock( plk )                        hthread_test_lock( plk, PTT_LOC )
@@ -335,6 +344,8 @@ HT_DLL_IMPORT int  hthread_get_thread_prio        ( TID tid, const char* locatio
 #endif
 #define set_thread_priority( tid, prio )        hthread_set_thread_prio( (tid), (prio), PTT_LOC )
 #define get_thread_priority( tid )              hthread_get_thread_prio( (tid), PTT_LOC )
+#define set_thread_affinity( tid, list )        hthread_set_thread_affinity( (tid), (list), PTT_LOC )
+#define get_thread_affinity( tid, buf, sz )     hthread_get_thread_affinity( (tid), (buf), (sz), PTT_LOC )
 
 /*-------------------------------------------------------------------*/
 /*                         PTT Tracing                               */
@@ -124,6 +124,16 @@ typedef struct TELNET    TELNET;    // Telnet Control Block
 typedef struct DEVBLK    DEVBLK;    // Device configuration block
 typedef struct CHPBLK    CHPBLK;    // Channel Path config block
 typedef struct IOINT     IOINT;     // I/O interrupt queue
+typedef struct PDC       PDC;       // Predecoded instruction cache
+typedef struct PDCPAGE   PDCPAGE;   // Predecode cache page
+typedef struct PDCENT    PDCENT;    // Predecode cache entry
+typedef struct BBC       BBC;       // Basic block dispatch cache
+typedef struct BBLK      BBLK;      // Basic block
+typedef struct IMAP      IMAP;      // Instruction count map
+typedef struct PROFSAMP  PROFSAMP;  // Profiler PSW sample
+typedef struct PROFBUF   PROFBUF;   // Per-CPU profiler samples
+typedef struct BTCENT    BTCENT;    // Branch target cache entry
+typedef struct STORFILE  STORFILE;  // Shared main storage file header
 
 typedef struct GSYSINFO  GSYSINFO;  // Ebcdic machine information
 
@@ -700,6 +700,15 @@ int     rc;
 
     sysblk.timerint = DEF_TOD_UPDATE_USECS;
 
+#if defined(OPTION_TLB_WAYS)
+    /* Direct mapped TLB until configured otherwise */
+    sysblk.tlbways = 1;
+#endif
+
+    /* PLO serialized with CS, CDS and TS by mainlock until
+       configured otherwise                                          */
+    sysblk.plomainlock = 1;
+
     /* set default thread priorities */
     sysblk.hercprio = DEFAULT_HERCPRIO;
     sysblk.todprio  = DEFAULT_TOD_PRIO;
@@ -771,15 +780,23 @@ int     rc;
     initialize_lock (&sysblk.todlock);
     initialize_lock (&sysblk.mainlock);
     sysblk.mainowner = LOCK_OWNER_NONE;
-    initialize_lock (&sysblk.intlock);
-    initialize_lock (&sysblk.iointqlk);
+    {
+        int i;
+        for (i = 0; i < PLO_LOCKS; i++)
+        {
+            initialize_lock (&sysblk.plolock[i]);
+            sysblk.ploowner[i] = LOCK_OWNER_NONE;
+        }
+    }
+    initialize_adaptive_lock (&sysblk.intlock);
+    initialize_adaptive_lock (&sysblk.iointqlk);
     sysblk.intowner = LOCK_OWNER_NONE;
     initialize_lock (&sysblk.sigplock);
     initialize_lock (&sysblk.mntlock);
     initialize_lock (&sysblk.scrlock);
     initialize_condition (&sysblk.scrcond);
     initialize_lock (&sysblk.crwlock);
-    initialize_lock (&sysblk.ioqlock);
+    initialize_adaptive_lock (&sysblk.ioqlock);
     initialize_condition (&sysblk.ioqcond);
 
 #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_3
@@ -797,10 +814,15 @@ int     rc;
     {
         int i;
         for (i = 0; i < MAX_CPU_ENGINES; i++)
+        {
             initialize_lock (&sysblk.cpulock[i]);
+            initialize_lock (&sysblk.wakelock[i]);
+            initialize_condition (&sysblk.wakecond[i]);
+        }
     }
     initialize_condition (&sysblk.sync_cond);
     initialize_condition (&sysblk.sync_bc_cond);
+    initialize_condition (&sysblk.purgecond);
 
     /* Copy length for regs */
     sysblk.regs_copy_len = (int)((uintptr_t)&sysblk.dummyregs.regs_copy_end
@@ -332,6 +332,9 @@ int ARCH_DEP(common_load_begin) (int cpu, int clear)
     int capture;
     int rc;
 
+    /* Storage kept for resume is not resumed once the system loads */
+    storage_clear_kept();
+
     /* Save the original architecture mode for later */
     orig_arch_mode = sysblk.dummyregs.arch_mode = sysblk.arch_mode;
 
@@ -844,12 +847,26 @@ void storage_clear()
 {
     if (!sysblk.main_clear)
     {
-        if (sysblk.mainstor) memset( sysblk.mainstor, 0x00, sysblk.mainsize );
+        if (sysblk.mainstor) storage_release( sysblk.mainstor, sysblk.mainsize, sysblk.mainback );
         if (sysblk.storkeys) memset( sysblk.storkeys, 0x00, sysblk.mainsize / _STORKEY_ARRAY_UNITSIZE );
         sysblk.main_clear = 1;
     }
 }
 
+/*-------------------------------------------------------------------*/
+/* Function to give main storage kept in a shared file for resume    */
+/* the power-on clear it skipped, once it will not be resumed        */
+/*-------------------------------------------------------------------*/
+void storage_clear_kept()
+{
+    if (sysblk.mainfhdr && sysblk.mainfhdr->suspended)
+    {
+        sysblk.mainfhdr->suspended = 0;
+        sysblk.main_clear = 0;
+        storage_clear();
+    }
+}
+
 /*-------------------------------------------------------------------*/
 /* Function to clear expanded storage                                */
 /*-------------------------------------------------------------------*/
@@ -858,7 +875,8 @@ void xstorage_clear()
     if (!sysblk.xpnd_clear)
     {
         if (sysblk.xpndstor)
-            memset( sysblk.xpndstor, 0x00, (size_t)sysblk.xpndsize * XSTORE_PAGESIZE );
+            storage_release( sysblk.xpndstor, (size_t)sysblk.xpndsize * XSTORE_PAGESIZE,
+                             sysblk.xpndback );
 
         sysblk.xpnd_clear = 1;
     }
@@ -19,6 +19,512 @@
 
 #include "hercules.h"
 
+/*-------------------------------------------------------------------*/
+/* Copying and scanning storage images with several threads.         */
+/*                                                                   */
+/* Large image files are mapped rather than read, and the copying    */
+/* between the mapping and storage is shared out in LOADMEM_SLICE    */
+/* pieces among up to LOADMEM_THREADS threads, so that page cache    */
+/* misses and page faults on either side are taken in parallel.      */
+/* Storage is still copied into, rather than the file mapped over    */
+/* it, since released storage must read as zeros and not revert to   */
+/* the file's contents.                                              */
+/*-------------------------------------------------------------------*/
+#if !defined(_MSVC_)
+  #define LOADMEM_MMAP
+#endif
+
+typedef struct _LOADMEM_WORK {          /* Work shared by threads    */
+    LOCK         lock;                  /* Serializes this block     */
+    LOADMEM_EXT *ext;                   /* Extents to copy, or...    */
+    BYTE        *scan;                  /* ...storage to scan, and   */
+    BYTE        *map;                   /* ...its nonzero page map   */
+    int          next;                  /* Next extent to copy       */
+    U64          next_off;              /* ...and offset within it   */
+    int          count;                 /* Number of extents         */
+    U64          done;                  /* Bytes processed           */
+    const char  *what;                  /* Progress message verb     */
+    time_t       msgtime;               /* Last progress message     */
+} LOADMEM_WORK;
+
+/* Test whether a 4K page is all zero */
+static int loadmem_page_zero(BYTE *p)
+{
+U64    *q = (U64*)p;
+int     i;
+
+    for (i = 0; i < 4096 / 8; i++)
+        if (q[i])
+            return 0;
+    return 1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Worker: take slices of the work until there are none left         */
+/*-------------------------------------------------------------------*/
+static void *loadmem_thread(void *arg)
+{
+LOADMEM_WORK *w = arg;                  /* Shared work               */
+LOADMEM_EXT  *ext;                      /* Extent being processed    */
+U64     off, len, pg;                   /* Slice offset and length   */
+time_t  now;
+char    fmt_mem[8];
+
+    for (;;)
+    {
+        obtain_lock(&w->lock);
+        while (w->next < w->count && w->next_off >= w->ext[w->next].len)
+        {
+            w->next++;
+            w->next_off = 0;
+        }
+        if (w->next >= w->count)
+        {
+            release_lock(&w->lock);
+            break;
+        }
+        ext = &w->ext[w->next];
+        off = w->next_off;
+        len = MIN(LOADMEM_SLICE, ext->len - off);
+        w->next_off += len;
+        release_lock(&w->lock);
+
+        if (w->scan)
+        {
+            /* Note the pages of the slice that are not all zero */
+            for (pg = off / 4096; pg < (off + len) / 4096; pg++)
+                if (!loadmem_page_zero(w->scan + pg * 4096))
+                    w->map[pg / 8] |= 0x80 >> (pg % 8);
+        }
+        else
+            memcpy(ext->dst + off, ext->src + off, (size_t)len);
+
+        obtain_lock(&w->lock);
+        w->done += len;
+        if (w->what && time(&now) - w->msgtime > 2)
+        {
+            w->msgtime = now;
+            // "%s bytes %s so far..."
+            WRMSG(HHC02317, "I",
+                  fmt_memsize_rounded(w->done, fmt_mem, sizeof(fmt_mem)),
+                  w->what);
+        }
+        release_lock(&w->lock);
+    }
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Run the work on as many threads as are useful                     */
+/*-------------------------------------------------------------------*/
+static void loadmem_run(LOADMEM_WORK *w)
+{
+TID     tid[LOADMEM_THREADS];
+U64     total;
+int     i, n, nthreads = 0;
+
+    for (total = 0, i = 0; i < w->count; i++)
+        total += w->ext[i].len;
+    n = (int)MIN((U64)MIN(hostinfo.num_procs, LOADMEM_THREADS),
+                 (total + LOADMEM_SLICE - 1) / LOADMEM_SLICE);
+
+    initialize_lock(&w->lock);
+    time(&w->msgtime);
+
+    /* The calling thread takes its share as well */
+    for (i = 1; i < n; i++)
+        if (create_thread(&tid[nthreads], JOINABLE, loadmem_thread, w,
+                          "loadmem_thread") == 0)
+            nthreads++;
+    loadmem_thread(w);
+    for (i = 0; i < nthreads; i++)
+        join_thread(tid[i], NULL);
+
+    destroy_lock(&w->lock);
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy extents with several threads                                 */
+/*-------------------------------------------------------------------*/
+void loadmem_copy(LOADMEM_EXT *ext, int count, const char *what)
+{
+LOADMEM_WORK w;
+
+    memset(&w, 0, sizeof(w));
+    w.ext = ext;
+    w.count = count;
+    w.what = what;
+    loadmem_run(&w);
+}
+
+/*-------------------------------------------------------------------*/
+/* Map which 4K pages of len bytes of storage are not all zero,      */
+/* scanning with several threads; map must hold len / 4096 bits      */
+/* and be zero on entry                                              */
+/*-------------------------------------------------------------------*/
+void loadmem_scan(BYTE *stor, U64 len, BYTE *map)
+{
+LOADMEM_WORK w;
+LOADMEM_EXT  ext;
+
+    memset(&w, 0, sizeof(w));
+    ext.dst = ext.src = stor;
+    ext.len = len & ~0xFFFULL;
+    w.ext = &ext;
+    w.count = 1;
+    w.scan = stor;
+    w.map = map;
+    loadmem_run(&w);
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy len bytes at offset off of an open file to dst by mapping    */
+/* the file.  Returns 0, or -1 if the file could not be mapped and   */
+/* must be read instead.                                             */
+/*-------------------------------------------------------------------*/
+int loadmem_map_file(int fd, U64 off, U64 len, BYTE *dst, const char *what)
+{
+#if defined(LOADMEM_MMAP)
+LOADMEM_EXT ext;
+BYTE   *p;
+U64     pgoff;                          /* Offset within host page   */
+
+    pgoff = off % hostinfo.hostpagesz;
+    p = mmap(NULL, (size_t)(len + pgoff), PROT_READ, MAP_PRIVATE, fd,
+             (off_t)(off - pgoff));
+    if (p == MAP_FAILED)
+        return -1;
+#if defined(MADV_WILLNEED)
+    /* Start reading ahead of the threads */
+    madvise(p, (size_t)(len + pgoff), MADV_WILLNEED);
+#endif
+
+    ext.dst = dst;
+    ext.src = p + pgoff;
+    ext.len = len;
+    loadmem_copy(&ext, 1, what);
+
+    munmap(p, (size_t)(len + pgoff));
+    return 0;
+#else
+    UNREFERENCED(fd);
+    UNREFERENCED(off);
+    UNREFERENCED(len);
+    UNREFERENCED(dst);
+    UNREFERENCED(what);
+    return -1;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy len bytes from src to a new open file, at offset off, by     */
+/* mapping the file.  Returns 0, or -1 if the file could not be      */
+/* mapped and must be written instead.                               */
+/*-------------------------------------------------------------------*/
+int loadmem_save_file(int fd, U64 off, BYTE *src, U64 len, const char *what)
+{
+#if defined(LOADMEM_MMAP) && defined(HAVE_POSIX_FALLOCATE)
+LOADMEM_EXT ext;
+BYTE   *p;
+U64     pgoff;                          /* Offset within host page   */
+
+    pgoff = off % hostinfo.hostpagesz;
+    /* Allocate the file's blocks now; a mapped write that finds the
+       file system full would otherwise end in SIGBUS.  Hosts that
+       cannot allocate them ahead write the file instead */
+    if (posix_fallocate(fd, (off_t)off, (off_t)len) != 0)
+        return -1;
+    p = mmap(NULL, (size_t)(len + pgoff), PROT_READ | PROT_WRITE,
+             MAP_SHARED, fd, (off_t)(off - pgoff));
+    if (p == MAP_FAILED)
+        return -1;
+
+    ext.dst = p + pgoff;
+    ext.src = src;
+    ext.len = len;
+    loadmem_copy(&ext, 1, what);
+
+    munmap(p, (size_t)(len + pgoff));
+    return 0;
+#else
+    UNREFERENCED(fd);
+    UNREFERENCED(off);
+    UNREFERENCED(src);
+    UNREFERENCED(len);
+    UNREFERENCED(what);
+    return -1;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Read or write len bytes in pieces.  Return 0 or -1 with errno.    */
+/*-------------------------------------------------------------------*/
+static int loadmem_read(int fd, BYTE *p, U64 len)
+{
+int     n;
+
+    for (; len; p += n, len -= n)
+    {
+        n = read(fd, p, (size_t)MIN(len, 64 * ONE_MEGABYTE));
+        if (n <= 0)
+        {
+            if (n == 0)
+                errno = EIO;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int loadmem_write(int fd, BYTE *p, U64 len)
+{
+int     n;
+
+    for (; len; p += n, len -= n)
+    {
+        n = write(fd, p, (size_t)MIN(len, 64 * ONE_MEGABYTE));
+        if (n <= 0)
+        {
+            if (n == 0)
+                errno = ENOSPC;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Load a sparse core image whose header has been read, at aaddr or, */
+/* if no address was given, where it was saved from                  */
+/*-------------------------------------------------------------------*/
+static int loadmem_sparse(int fd, char *fname, BYTE *hdr,
+                          RADR aaddr, int given)
+{
+U64     start, length, count;           /* Header fields             */
+U64     i, off, len, prev, total;
+BYTE   *index;                          /* Extent index              */
+LOADMEM_EXT *ext;                       /* Extents to copy           */
+RADR    pageaddr;
+struct stat st;
+char    buf1[32];
+int     rc = -1;
+int     mapped = 0;                     /* Extents copied from a map */
+#if defined(LOADMEM_MMAP)
+BYTE   *p;
+U64     dataoff, pgoff;
+#endif
+
+    start  = fetch_dw(hdr + SPARSECORE_START);
+    length = fetch_dw(hdr + SPARSECORE_LENGTH);
+    count  = fetch_dw(hdr + SPARSECORE_COUNT);
+    if (fetch_fw(hdr + SPARSECORE_VER) != SPARSECORE_VERSION
+     || count > length / 4096 + 1)
+    {
+        // "Loadcore: file %s is not a valid sparse core image"
+        WRMSG(HHC02360, "E", fname);
+        return -1;
+    }
+    if (!given)
+        aaddr = (RADR)start;
+    if (aaddr >= sysblk.mainsize || length > sysblk.mainsize - aaddr)
+    {
+        // "Address exceeds main storage size"
+        WRMSG(HHC02251, "E");
+        return -1;
+    }
+
+    // "Loading file %s to location %s"
+    MSGBUF( buf1, "%"PRIX64, (U64) aaddr );
+    WRMSG(HHC02250, "I", fname, buf1 );
+
+    index = malloc((size_t)(count * SPARSECORE_EXTLEN) + 1);
+    ext = malloc((size_t)(count * sizeof(LOADMEM_EXT)) + 1);
+    if (index == NULL || ext == NULL)
+    {
+        // "Error in function %s: %s"
+        WRMSG(HHC02219, "E", "malloc()", strerror(errno));
+        goto sparse_exit;
+    }
+
+    /* A file too short for its index is not an image either */
+    if (fstat(fd, &st) != 0
+     || (U64)st.st_size < SPARSECORE_HDRLEN + count * SPARSECORE_EXTLEN)
+    {
+        // "Loadcore: file %s is not a valid sparse core image"
+        WRMSG(HHC02360, "E", fname);
+        goto sparse_exit;
+    }
+    if (loadmem_read(fd, index, count * SPARSECORE_EXTLEN) != 0)
+    {
+        // "Error in function %s: %s"
+        WRMSG(HHC02219, "E", "read()", strerror(errno));
+        goto sparse_exit;
+    }
+
+    /* The extents must be in order, within the range and present */
+    for (prev = total = i = 0; i < count; i++)
+    {
+        off = fetch_dw(index + i * SPARSECORE_EXTLEN);
+        len = fetch_dw(index + i * SPARSECORE_EXTLEN + 8);
+        if (off < prev || len == 0 || off > length || len > length - off)
+            break;
+        ext[i].dst = sysblk.mainstor + aaddr + off;
+        ext[i].len = len;
+        prev = off + len;
+        total += len;
+    }
+    if (i < count
+     || (U64)st.st_size < SPARSECORE_HDRLEN + count * SPARSECORE_EXTLEN + total)
+    {
+        // "Loadcore: file %s is not a valid sparse core image"
+        WRMSG(HHC02360, "E", fname);
+        goto sparse_exit;
+    }
+
+    /* Storage in the range but in no extent is zero */
+    for (prev = i = 0; i <= count; i++)
+    {
+        off = i < count ? (U64)(ext[i].dst - sysblk.mainstor) - aaddr
+                        : length;
+        if (off > prev)
+            storage_release(sysblk.mainstor + aaddr + prev,
+                            (size_t)(off - prev), sysblk.mainback);
+        if (i < count)
+            prev = off + ext[i].len;
+    }
+
+    /* Copy the extents from a mapping of the file if possible */
+#if defined(LOADMEM_MMAP)
+    dataoff = SPARSECORE_HDRLEN + count * SPARSECORE_EXTLEN;
+    pgoff = dataoff % hostinfo.hostpagesz;
+    if (total >= LOADMEM_MAP_MIN
+     && (p = mmap(NULL, (size_t)(total + pgoff), PROT_READ, MAP_PRIVATE,
+                  fd, (off_t)(dataoff - pgoff))) != MAP_FAILED)
+    {
+#if defined(MADV_WILLNEED)
+        madvise(p, (size_t)(total + pgoff), MADV_WILLNEED);
+#endif
+        for (off = pgoff, i = 0; i < count; off += ext[i].len, i++)
+            ext[i].src = p + off;
+        loadmem_copy(ext, (int)count, "loaded");
+        munmap(p, (size_t)(total + pgoff));
+        mapped = 1;
+    }
+#endif
+    for (i = 0; !mapped && i < count; i++)
+        if (loadmem_read(fd, ext[i].dst, ext[i].len) != 0)
+        {
+            // "Error in function %s: %s"
+            WRMSG(HHC02219, "E", "read()", strerror(errno));
+            goto sparse_exit;
+        }
+    rc = 0;
+
+    /* Update the storage keys of the pages loaded */
+    for (i = 0; i < count; i++)
+        for (pageaddr = (RADR)(ext[i].dst - sysblk.mainstor) & PAGEFRAME_PAGEMASK;
+             pageaddr < (RADR)(ext[i].dst - sysblk.mainstor) + ext[i].len;
+             pageaddr += PAGEFRAME_PAGESIZE)
+            STORAGE_KEY(pageaddr, &sysblk) |= STORKEY_REF|STORKEY_CHANGE;
+
+sparse_exit:
+    free(index);
+    free(ext);
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Save storage from aaddr to aaddr2 as a sparse core image, leaving */
+/* out the pages that are all zero, which includes those never used  */
+/*-------------------------------------------------------------------*/
+int loadmem_save_sparse(int fd, RADR aaddr, RADR aaddr2)
+{
+U64     pstart, npages, pg, end;        /* Pages in the range        */
+U64     count = 0, total = 0, off, len;
+BYTE   *map, *index;                    /* Nonzero pages, extents    */
+BYTE    hdr[SPARSECORE_HDRLEN];
+time_t  begtime, curtime;
+U64     saved = 0;
+char    fmt_mem[8], fmt_mem2[8];
+int     rc = -1;
+
+    pstart = aaddr & PAGEFRAME_PAGEMASK;
+    npages = (((U64)aaddr2 | PAGEFRAME_BYTEMASK) + 1 - pstart) / 4096;
+    map = calloc((size_t)((npages + 7) / 8), 1);
+    index = malloc((size_t)((npages + 1) / 2 * SPARSECORE_EXTLEN) + 1);
+    if (map == NULL || index == NULL)
+    {
+        // "Error in function %s: %s"
+        WRMSG(HHC02219, "E", "malloc()", strerror(errno));
+        goto save_exit;
+    }
+    loadmem_scan(sysblk.mainstor + pstart, npages * 4096, map);
+
+    /* Each run of nonzero pages, within the range, is an extent */
+    for (pg = 0; pg < npages; pg = end)
+    {
+        for (; pg < npages && !(map[pg / 8] & (0x80 >> (pg % 8))); pg++);
+        for (end = pg; end < npages && (map[end / 8] & (0x80 >> (end % 8))); end++);
+        if (pg == end)
+            break;
+        off = MAX(pstart + pg * 4096, (U64)aaddr) - aaddr;
+        len = MIN(pstart + end * 4096, (U64)aaddr2 + 1) - aaddr - off;
+        store_dw(index + count * SPARSECORE_EXTLEN, off);
+        store_dw(index + count * SPARSECORE_EXTLEN + 8, len);
+        count++;
+        total += len;
+    }
+
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, SPARSECORE_ID, 8);
+    store_fw(hdr + SPARSECORE_VER, SPARSECORE_VERSION);
+    store_dw(hdr + SPARSECORE_START, aaddr);
+    store_dw(hdr + SPARSECORE_LENGTH, (U64)aaddr2 - aaddr + 1);
+    store_dw(hdr + SPARSECORE_COUNT, count);
+    if (loadmem_write(fd, hdr, sizeof(hdr)) != 0
+     || loadmem_write(fd, index, count * SPARSECORE_EXTLEN) != 0)
+    {
+        // "Error in function %s: %s"
+        WRMSG(HHC02219, "E", "write()", strerror(errno));
+        goto save_exit;
+    }
+
+    /* Write the extents straight from storage */
+    time( &begtime );
+    for (pg = 0; pg < count; pg++)
+    {
+        off = fetch_dw(index + pg * SPARSECORE_EXTLEN);
+        len = fetch_dw(index + pg * SPARSECORE_EXTLEN + 8);
+        if (loadmem_write(fd, sysblk.mainstor + aaddr + off, len) != 0)
+        {
+            // "Error in function %s: %s"
+            WRMSG(HHC02219, "E", "write()", strerror(errno));
+            goto save_exit;
+        }
+        saved += len;
+        time( &curtime );
+        if (difftime( curtime, begtime ) > 2.0)
+        {
+            begtime = curtime;
+            // "%s bytes %s so far..."
+            WRMSG( HHC02317, "I",
+                fmt_memsize_rounded( saved, fmt_mem, sizeof( fmt_mem )),
+                    "saved" );
+        }
+    }
+
+    // "Savecore: %s saved in %"PRIu64" extents; %s of zero pages left out"
+    WRMSG(HHC02359, "I", fmt_memsize_rounded(total, fmt_mem, sizeof(fmt_mem)),
+          count, fmt_memsize_rounded((U64)aaddr2 - aaddr + 1 - total,
+                                     fmt_mem2, sizeof(fmt_mem2)));
+    rc = 0;
+
+save_exit:
+    free(map);
+    free(index);
+    return rc;
+}
+
 /*-------------------------------------------------------------------*/
 /* loadcore filename command - load a core image file                */
 /*-------------------------------------------------------------------*/
@@ -32,6 +538,9 @@ REGS *regs;
     U64     work64;                     /* 64-bit work variable      */
     RADR    aaddr;                      /* Absolute storage address  */
     char    pathname[MAX_PATH];         /* file in host path format  */
+    int     fd;                         /* File descriptor           */
+    BYTE    hdr[SPARSECORE_HDRLEN];     /* Sparse core image header  */
+    int     rc;
 
     UNREFERENCED(cmdline);
 
@@ -81,6 +590,23 @@ REGS *regs;
         return -1;
     }
 
+    /* A sparse core image is loaded by its index */
+    if ((fd = HOPEN(pathname, O_RDONLY|O_BINARY)) >= 0)
+    {
+        if (read(fd, hdr, sizeof(hdr)) == sizeof(hdr)
+         && memcmp(hdr, SPARSECORE_ID, 8) == 0)
+        {
+            rc = loadmem_sparse(fd, fname, hdr, aaddr, argc >= 3);
+            close(fd);
+            release_lock(&sysblk.cpulock[sysblk.pcpu]);
+            if (rc == 0)
+                // "Operation complete"
+                WRMSG(HHC02249, "I");
+            return rc;
+        }
+        close(fd);
+    }
+
     // "Loading file %s to location %s"
     {
         char buf1[32];
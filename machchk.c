@@ -350,6 +350,9 @@ RADR    fsta = 0;
     if (regs->cpuad == sysblk.mainowner)
         RELEASE_MAINLOCK(regs);
 
+    /* Release PLO locks if held */
+    RELEASE_PLOLOCKS(regs);
+
     /* Exit SIE when active */
 #if defined(FEATURE_INTERPRETIVE_EXECUTION)
     if(regs->sie_active)
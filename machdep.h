@@ -428,6 +428,25 @@ static __inline__ BYTE cmpxchg8_amd64(U64 *old, U64 new, void *ptr) {
  return code;
 }
 
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+/* (only when compiled for hosts with cmpxchg16b, e.g. -mcx16) */
+#define cmpxchg16(x1,x2,y1,y2,z) cmpxchg16_amd64(x1,x2,y1,y2,z)
+static __inline__ int cmpxchg16_amd64(U64 *old1, U64 *old2, U64 new1, U64 new2, volatile void *ptr) {
+/* returns zero on success otherwise returns 1 */
+ unsigned __int128 old, new, cur;
+ old = ((unsigned __int128)*old2 << 64) | *old1;
+ new = ((unsigned __int128)new2 << 64) | new1;
+ cur = __sync_val_compare_and_swap((unsigned __int128 *)ptr, old, new);
+ if (cur == old)
+     return 0;
+ *old1 = (U64)cur;
+ *old2 = (U64)(cur >> 64);
+ return 1;
+}
+#endif /* defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16) */
+
+#define HOST_PAUSE() __asm__ __volatile__ ("pause")
+
 #endif /* defined(_ext_amd64) */
 
 /*-------------------------------------------------------------------
@@ -560,6 +579,19 @@ U32  *ptr4, val4, old4, new4;
  #define ASSIST_CMPXCHG16
 #endif
 
+/*-------------------------------------------------------------------
+ * HOST_PAUSE - spin loop hint
+ *-------------------------------------------------------------------*/
+#if !defined(HOST_PAUSE)
+ #if defined(_MSVC_)
+  #define HOST_PAUSE()          YieldProcessor()
+ #elif defined(_ext_ia32)
+  #define HOST_PAUSE()          __asm__ __volatile__ ("rep; nop")
+ #else
+  #define HOST_PAUSE()          do {} while (0)
+ #endif
+#endif
+
 #if defined(fetch_dw) || defined(fetch_dw_noswap)
  #define ASSIST_FETCH_DW
 #endif
@@ -838,6 +870,32 @@ static __inline__ int cmpxchg16(U64 *old1, U64 *old2, U64 new1, U64 new2, volati
 }
 #endif
 
+/*-------------------------------------------------------------------
+ * atomic_or4, atomic_and4 - interlocked update of a host fullword
+ * HOST_MB - full memory barrier
+ * Used for CPU interrupt state bits which may be posted without the
+ * interrupt lock.  atomic_or4 and atomic_and4 also imply a barrier.
+ *-------------------------------------------------------------------*/
+#if defined(_MSVC_)
+ #define atomic_or4(p,v)  ((void)InterlockedOr((volatile LONG*)(p),(LONG)(v)))
+ #define atomic_and4(p,v) ((void)InterlockedAnd((volatile LONG*)(p),(LONG)(v)))
+ #define HOST_MB()        MemoryBarrier()
+#elif defined(__GNUC__)
+ #define atomic_or4(p,v)  ((void)__sync_fetch_and_or((U32*)(p),(U32)(v)))
+ #define atomic_and4(p,v) ((void)__sync_fetch_and_and((U32*)(p),(U32)(v)))
+ #define HOST_MB()        __sync_synchronize()
+#else
+static __inline__ void atomic_or4(volatile U32 *ptr, U32 bits) {
+ U32 old = *ptr;
+ while (cmpxchg4(&old, old | bits, ptr));
+}
+static __inline__ void atomic_and4(volatile U32 *ptr, U32 bits) {
+ U32 old = *ptr;
+ while (cmpxchg4(&old, old & bits, ptr));
+}
+ #define HOST_MB()        do {} while (0)
+#endif
+
 #ifndef BIT
 #define BIT(nr) (1<<(nr))
 #endif
@@ -1193,6 +1193,19 @@ Examples:
 #define HHC02020 "SR: value error, incorrect length"
 #define HHC02021 "SR: string error, incorrect length"
 #define HHC02022 "SR: error loading CRW queue: not enough memory for %d CRWs"
+#define HHC02023 "SR: %s storage: %"PRIu64" of %"PRIu64" chunks written in %s"
+#define HHC02024 "SR: file %s does not contain chunked storage"
+#define HHC02025 "SR: incremental and checkpoint images are not supported without zlib"
+#define HHC02026 "SR: invalid storage chunk at offset %16.16"PRIX64
+#define HHC02027 "SR: invalid argument %s"
+#define HHC02028 "SR: base images nested more than %d deep"
+#define HHC02029 "SR: restoring storage from base image %s"
+#define HHC02030 "SR: checkpoint pass %d: %"PRIu64" changed pages written"
+#define HHC02031 "SR: %s storage changes are not tracked; all of it is checked with the CPUs stopped"
+#define HHC02032 "SR: checkpoint written to %s; CPUs were stopped for %d.%3.3d seconds"
+#define HHC02033 "SR: main storage is not shared with a file"
+#define HHC02034 "SR: main storage was left in shared file %s"
+#define HHC02035 "SR: shared file %s does not hold the main storage of this image"
 
 // reserve 021xx for logger.c
 #define HHC02100 "Logger: log not active"
@@ -1356,7 +1369,19 @@ Examples:
 #define HHC02345 "%s device %1d:%04X group has registered IP address %s"
 #define HHC02346 "%s device %1d:%04X group has no registered MAC or IP addresses"
 
-// range 02350 - 02369 available
+#define HHC02350 "Processor %s%02X: blocks built %"PRIu64" executed %"PRIu64" instructions %"PRIu64" exits %"PRIu64" modified %"PRIu64
+#define HHC02351 "Fused %-8s %"PRIu64
+#define HHC02352 "Profiler %s at %u samples per second, %u samples held"
+#define HHC02353 "%6.2f%% %10u %-5s %-4s ASN %4.4X ASCE %16.16"PRIX64" IA %16.16"PRIX64
+#define HHC02354 "Profiler wrote %u folded stacks to file %s"
+#define HHC02355 "Processor %s%02X: TLB hits %"PRIu64" way hits %"PRIu64" misses %"PRIu64" conflicts %"PRIu64
+
+#define HHC02356 "Processor %s%02X: PLO locks %"PRIu64" contended %"PRIu64
+#define HHC02357 "I/O interrupts %"PRIu64" CPUs woken %"PRIu64" wakeups per interrupt %s"
+#define HHC02358 "Processor %s%02X: woken %"PRIu64" rewaited %"PRIu64
+#define HHC02359 "Savecore: %s saved in %"PRIu64" extents; %s of zero pages left out"
+#define HHC02360 "Loadcore: file %s is not a valid sparse core image"
+// range 02361 - 02369 available
 
 #define HHC02370 "%1d:%04X CU or LCU %s conflicts with existing CUNUM %04X SSID %04X CU/LCU %s"
 #define HHC02371 "%1d:%04X Adding device exceeds CU and/or LCU device limits"
@@ -2053,6 +2078,14 @@ Examples:
 #define HHC17013 "Process ID = %d"
 #define HHC17014 "Specified value is invalid or outside of range %d to %d"
 #define HHC17015 "%s support not included in this engine build"
+#define HHC17016 "%-10s threads run on host CPUs %s"
+#define HHC17017 "Main storage NUMA placement %s%s%s"
+#define HHC17018 "PROC %s%2.2X runs on host CPUs %s"
+#define HHC17019 "NUMA placement of main storage failed: %s"
+#define HHC17020 "%s storage is backed by %s%s"
+#define HHC17021 "%-8s storage has %s resident in host memory (%d%%)"
+#define HHC17022 "Main storage is shared with file %s%s"
+#define HHC17023 "Main storage file %s is in use by another process"
 
 #define HHC17100 "Timeout value for 'quit' and 'ssd' is %d seconds"
 #define HHC17199 "%.4s %s"
@@ -2114,6 +2147,12 @@ Examples:
 #define HHC90019 "No locks found for thread "TIDPAT"."
 #define HHC90020 "'%s' failed at loc=%s: rc=%d: %s"
 #define HHC90021 "%-18s %s "TIDPAT" %-18s "PTR_FMTx" "PTR_FMTx" %s"
+#define HHC90022 "Lock=%s, acquired=%"PRIu64", contended=%"PRIu64", spun=%"PRIu64", wait=%"PRIu64"us max=%"PRIu64"us, hold=%"PRIu64"us max=%"PRIu64"us"
+#define HHC90023 "Lock=%s, %s histogram:%s"
+#define HHC90024 "Lock statistics %s"
+#define HHC90025 "Pttrace: %d entries written to file %s"
+#define HHC90026 "Pttrace: error writing file %s: %s"
+#define HHC90027 "Pttrace: trace is not active"
 
 
 /* from crypto/dyncrypt.c when compiled with debug on */
@@ -1234,6 +1234,69 @@ DEF_INST(execute_opcode_ed________xx)
 }
 
 
+#if defined(OPTION_PREDECODE_CACHE)
+/*-------------------------------------------------------------------*/
+/* Decode an instruction into a predecode cache entry                */
+/*                                                                   */
+/* The second level execute_opcode_xx________xx dispatchers are      */
+/* resolved here so that the cached entry calls the final handler.   */
+/*-------------------------------------------------------------------*/
+void ARCH_DEP(pdc_decode) (const zz_func oct[], BYTE inst[], REGS *regs,
+                           PDCENT *pde)
+{
+U16            hw = fetch_hw(inst);     /* Opcode halfword           */
+zz_func        func = oct[hw];          /* First level handler       */
+const zz_func *oct2 = NULL;             /* Second level table        */
+
+    if (func == ARCH_DEP(execute_opcode_e3________xx))
+        oct2 = regs->ARCH_DEP(runtime_opcode_e3________xx);
+#ifdef OPTION_OPTINST
+    else if (func == ARCH_DEP(E3_0))
+        oct2 = regs->ARCH_DEP(runtime_opcode_e3_0______xx);
+#endif /* #ifdef OPTION_OPTINST */
+    else if (func == ARCH_DEP(execute_opcode_eb________xx))
+        oct2 = regs->ARCH_DEP(runtime_opcode_eb________xx);
+    else if (func == ARCH_DEP(execute_opcode_ec________xx))
+        oct2 = regs->ARCH_DEP(runtime_opcode_ec________xx);
+    else if (func == ARCH_DEP(execute_opcode_ed________xx))
+        oct2 = regs->ARCH_DEP(runtime_opcode_ed________xx);
+
+    pde->func = oct2 ? oct2[inst[5]] : func;
+    pde->hw   = hw;
+    pde->b5   = oct2 ? inst[5] : 0;
+    pde->ex5  = oct2 ? 1 : 0;
+
+    regs->pdc->decodes++;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Reset the predecode cache for the current opcode tables           */
+/*                                                                   */
+/* Every entry is set to the decoded form of halfword 0000 so that   */
+/* no entry is ever without a valid handler.                         */
+/*-------------------------------------------------------------------*/
+void ARCH_DEP(pdc_reset) (REGS *regs)
+{
+PDC    *pdc = regs->pdc;
+int     i, j;
+
+    pdc->oct = regs->ARCH_DEP(runtime_opcode_xxxx);
+    pdc->gen = sysblk.pdcgen;
+    pdc->resets++;
+
+    for (i = 0; i < PDC_PAGES; i++)
+        for (j = 0; j < PDC_ENTRIES; j++)
+        {
+            pdc->page[i].ent[j].func = pdc->oct[0x0000];
+            pdc->page[i].ent[j].hw   = 0x0000;
+            pdc->page[i].ent[j].b5   = 0;
+            pdc->page[i].ent[j].ex5  = 0;
+        }
+}
+#endif /*defined(OPTION_PREDECODE_CACHE)*/
+
+
 DEF_INST(operation_exception)
 {
     INST_UPDATE_PSW (regs, ILC(inst[0]), ILC(inst[0]));
@@ -1959,6 +2022,15 @@ void *replace_opcode(int arch, zz_func inst, int opcode1, int opcode2)
 #endif
 {
 //  logmsg("replace_opcode(%d, %02x, %02x)\n", arch, opcode1, opcode2);
+#if defined(OPTION_PREDECODE_CACHE)
+  /* Force the CPU predecode caches to be refilled */
+  sysblk.pdcgen++;
+#endif /*defined(OPTION_PREDECODE_CACHE)*/
+#if defined(OPTION_THREADED_DISPATCH)
+  /* The threaded dispatcher must no longer inline this opcode */
+  if(arch >= 0 && arch < GEN_ARCHCOUNT && opcode1 >= 0 && opcode1 <= 0xff && inst)
+    sysblk.thrdrepl[arch][opcode1] = 1;
+#endif /*defined(OPTION_THREADED_DISPATCH)*/
   switch(opcode1)
   {
     case 0x01:
@@ -148,70 +148,73 @@ extern int disasm_table (BYTE inst[], char mnemonic[], char *p);
 
 #define COUNT_INST(_inst, _regs) \
 do { \
-int used; \
+U64 *cnt; \
     switch((_inst)[0]) { \
     case 0x01: \
-        used = sysblk.imap01[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imap01[(_inst)[1]]; \
         break; \
     case 0xA4: \
-        used = sysblk.imapa4[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imapa4[(_inst)[1]]; \
         break; \
     case 0xA5: \
-        used = sysblk.imapa5[(_inst)[1] & 0x0F]++; \
+        cnt = &(_regs)->imap.imapa5[(_inst)[1] & 0x0F]; \
         break; \
     case 0xA6: \
-        used = sysblk.imapa6[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imapa6[(_inst)[1]]; \
         break; \
     case 0xA7: \
-        used = sysblk.imapa7[(_inst)[1] & 0x0F]++; \
+        cnt = &(_regs)->imap.imapa7[(_inst)[1] & 0x0F]; \
         break; \
     case 0xB2: \
-        used = sysblk.imapb2[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imapb2[(_inst)[1]]; \
         break; \
     case 0xB3: \
-        used = sysblk.imapb3[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imapb3[(_inst)[1]]; \
         break; \
     case 0xB9: \
-        used = sysblk.imapb9[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imapb9[(_inst)[1]]; \
         break; \
     case 0xC0: \
-        used = sysblk.imapc0[(_inst)[1] & 0x0F]++; \
+        cnt = &(_regs)->imap.imapc0[(_inst)[1] & 0x0F]; \
         break; \
     case 0xC2:                                     /*@Z9*/ \
-        used = sysblk.imapc2[(_inst)[1] & 0x0F]++; /*@Z9*/ \
+        cnt = &(_regs)->imap.imapc2[(_inst)[1] & 0x0F]; /*@Z9*/ \
         break;                                     /*@Z9*/ \
     case 0xC4:                                     /*208*/ \
-        used = sysblk.imapc4[(_inst)[1] & 0x0F]++; /*208*/ \
+        cnt = &(_regs)->imap.imapc4[(_inst)[1] & 0x0F]; /*208*/ \
         break;                                     /*208*/ \
     case 0xC6:                                     /*208*/ \
-        used = sysblk.imapc6[(_inst)[1] & 0x0F]++; /*208*/ \
+        cnt = &(_regs)->imap.imapc6[(_inst)[1] & 0x0F]; /*208*/ \
         break;                                     /*208*/ \
     case 0xC8: \
-        used = sysblk.imapc8[(_inst)[1] & 0x0F]++; \
+        cnt = &(_regs)->imap.imapc8[(_inst)[1] & 0x0F]; \
         break; \
     case 0xE3: \
-        used = sysblk.imape3[(_inst)[5]]++; \
+        cnt = &(_regs)->imap.imape3[(_inst)[5]]; \
         break; \
     case 0xE4: \
-        used = sysblk.imape4[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imape4[(_inst)[1]]; \
         break; \
     case 0xE5: \
-        used = sysblk.imape5[(_inst)[1]]++; \
+        cnt = &(_regs)->imap.imape5[(_inst)[1]]; \
         break; \
     case 0xEB: \
-        used = sysblk.imapeb[(_inst)[5]]++; \
+        cnt = &(_regs)->imap.imapeb[(_inst)[5]]; \
         break; \
     case 0xEC: \
-        used = sysblk.imapec[(_inst)[5]]++; \
+        cnt = &(_regs)->imap.imapec[(_inst)[5]]; \
         break; \
     case 0xED: \
-        used = sysblk.imaped[(_inst)[5]]++; \
+        cnt = &(_regs)->imap.imaped[(_inst)[5]]; \
         break; \
     default: \
-        used = sysblk.imapxx[(_inst)[0]]++; \
+        cnt = &(_regs)->imap.imapxx[(_inst)[0]]; \
     } \
-    if(!used) \
+    if (unlikely(--(_regs)->icsample <= 0)) \
+        icount_sample((_regs), cnt); \
+    if(!(*cnt)++ && !sysblk.imapused[IMAP_SLOT((_regs)->imap, cnt)]) \
     { \
+    sysblk.imapused[IMAP_SLOT((_regs)->imap, cnt)] = 1; \
     WRMSG(HHC02292, "I", "First use"); \
     ARCH_DEP(display_inst) ((_regs), (_inst)); \
     } \
@@ -310,6 +313,21 @@ do { \
   } \
 } while (0)
 
+/* Discard the recently used instruction pages along with the TLB */
+#if defined(OPTION_BRANCH_TARGET_CACHE)
+#define INVALIDATE_BTC(_regs) \
+    memset((_regs)->btc, 0, sizeof((_regs)->btc))
+#else
+#define INVALIDATE_BTC(_regs)
+#endif
+
+/* Count a TLB hit on the MADDR fast path */
+#if defined(OPTION_TLB_WAYS) && defined(OPTION_TLB_HIT_COUNTING)
+#define TLB_COUNT_HIT(_regs)    ((_regs)->tlbhits++)
+#else
+#define TLB_COUNT_HIT(_regs)    ((void)0)
+#endif
+
 #define INVALIDATE_AIA_MAIN(_regs, _main) \
 do { \
   if ((_main) == (_regs)->aip && (_regs)->aie) { \
@@ -351,10 +369,48 @@ do { \
     (_oct)[fetch_hw((_ip))]((_ip), (_regs)); \
 } while(0)
 
+#if defined(OPTION_PREDECODE_CACHE)
+
+/* Predecoded execution: the entry for the halfword at _ip holds the
+   resolved handler, re-decoded only if the opcode bytes changed.
+   Only valid while _ip < aie, which guarantees all six bytes of the
+   instruction are in the current page.                             */
+#define PDC_EXECUTE(_oct, _ip, _regs) \
+do { \
+    PDCENT *_pde = &(_regs)->pdcpage->ent[ \
+                        ((uintptr_t)(_ip) & PDC_BYTEMASK) >> 1]; \
+    FOOTPRINT ((_ip), (_regs)); \
+    COUNT_INST ((_ip), (_regs)); \
+    if (unlikely(_pde->hw != fetch_hw((_ip)) \
+              || (_pde->ex5 && _pde->b5 != (_ip)[5]))) \
+        ARCH_DEP(pdc_decode) ((_oct), (_ip), (_regs), _pde); \
+    _pde->func((_ip), (_regs)); \
+} while(0)
+
+/* Select the cache page for a newly established AIA page; the cache
+   is reset if the opcode tables changed since it was last filled    */
+#define PDC_SET_PAGE(_regs) \
+do { \
+    if (unlikely((_regs)->pdc->oct != (_regs)->ARCH_DEP(runtime_opcode_xxxx) \
+              || (_regs)->pdc->gen != sysblk.pdcgen)) \
+        ARCH_DEP(pdc_reset) ((_regs)); \
+    (_regs)->pdcpage = &(_regs)->pdc->page[PDC_HASH((_regs)->aip)]; \
+} while(0)
+
+#define UNROLLED_EXECUTE(_oct, _regs) \
+ if ((_regs)->ip >= (_regs)->aie) break; \
+ PDC_EXECUTE((_oct), (_regs)->ip, (_regs))
+
+#else /*!defined(OPTION_PREDECODE_CACHE)*/
+
+#define PDC_SET_PAGE(_regs)
+
 #define UNROLLED_EXECUTE(_oct, _regs) \
  if ((_regs)->ip >= (_regs)->aie) break; \
  EXECUTE_INSTRUCTION((_oct), (_regs)->ip, (_regs))
 
+#endif /*!defined(OPTION_PREDECODE_CACHE)*/
+
 /* Branching */
 
 #define SUCCESSFUL_BRANCH(_regs, _addr, _len) \
@@ -858,6 +914,53 @@ do { \
 
 #define TLBIX(_addr) (((VADR_L)(_addr) >> TLB_PAGESHIFT) & TLB_MASK)
 
+/* Reverse map of TLB entries by page frame.  Every store into
+   TLB_PTE is followed by TLB_RMAP_SET so that purge_tlbe need only
+   visit the entries in one bucket.  The bucket is selected by the
+   page frame number, which TLB_RFRAME takes from the PTE format of
+   the architecture; in S/370 the two halves of a 4K frame with 2K
+   pages share a bucket */
+#define TLB_RHASH(_pte) \
+    ((TLB_RFRAME(_pte) ^ (TLB_RFRAME(_pte) >> 10)) & (TLB_RHASHN - 1))
+
+#define TLB_RMAP_UNLINK(_tlb, _ix) \
+do { \
+  U16 _rn = (_tlb)->rnext[(_ix)], _rp = (_tlb)->rprev[(_ix)]; \
+  if (_rp) { \
+    if (_rp == TLB_RHEAD) \
+      (_tlb)->rhead[(_tlb)->rbucket[(_ix)]] = _rn; \
+    else \
+      (_tlb)->rnext[_rp - 1] = _rn; \
+    if (_rn) \
+      (_tlb)->rprev[_rn - 1] = _rp; \
+    (_tlb)->rprev[(_ix)] = 0; \
+  } \
+} while (0)
+
+#define TLB_RMAP_SET(_tlb, _ix, _pte) \
+do { \
+  U16 _rb = TLB_RHASH((_pte)); \
+  if (!(_tlb)->rprev[(_ix)] || (_tlb)->rbucket[(_ix)] != _rb) { \
+    TLB_RMAP_UNLINK((_tlb), (_ix)); \
+    (_tlb)->rbucket[(_ix)] = _rb; \
+    (_tlb)->rnext[(_ix)] = (_tlb)->rhead[_rb]; \
+    if ((_tlb)->rhead[_rb]) \
+      (_tlb)->rprev[(_tlb)->rhead[_rb] - 1] = (_ix) + 1; \
+    (_tlb)->rprev[(_ix)] = TLB_RHEAD; \
+    (_tlb)->rhead[_rb] = (_ix) + 1; \
+  } \
+} while (0)
+
+/* Empty the reverse map of a TLB whose entries are all invalid */
+#define TLB_RMAP_RESET(_tlb) \
+do { \
+  memset((_tlb)->rhead, 0, sizeof((_tlb)->rhead)); \
+  memset((_tlb)->rprev, 0, sizeof((_tlb)->rprev)); \
+} while (0)
+
+/* Index of the large frame TLB entry for a 1M segment */
+#define TLB_LARGEIX(_addr) (((VADR_L)(_addr) >> 20) & TLB_LARGE_MASK)
+
 #define MAINADDR(_main, _addr) \
    (BYTE*)((uintptr_t)(_main) ^ (uintptr_t)(_addr))
 
@@ -3002,6 +3105,7 @@ int  ARCH_DEP(cpcmd_call) (int r1, int r2, REGS *regs);
 void ARCH_DEP(pseudo_timer) (U32 code, int r1, int r2, REGS *regs);
 void ARCH_DEP(access_reipl_data) (int r1, int r2, REGS *regs);
 int  ARCH_DEP(diag_ppagerel) (int r1, int r2, REGS *regs);
+void ARCH_DEP(diag_release_pages) (int r1, int r2, REGS *regs);
 void ARCH_DEP(vm_info) (int r1, int r2, REGS *regs);
 int  ARCH_DEP(device_info) (int r1, int r2, REGS *regs);
 
@@ -3053,6 +3157,7 @@ int ARCH_DEP(initial_cpu_reset) (REGS *regs);
 int ARCH_DEP(common_load_begin)  (int cpu, int clear);
 int ARCH_DEP(common_load_finish) (REGS *regs);
 void storage_clear(void);
+void storage_clear_kept(void);
 void xstorage_clear(void);
 
 
@@ -3096,6 +3201,11 @@ int  queue_channel_report( U32* crwarray, U32 crwcount );
 /* Functions in module opcode.c */
 void init_opcode_tables(void);
 void init_opcode_pointers(REGS *regs);
+#if defined(OPTION_PREDECODE_CACHE)
+void ARCH_DEP(pdc_decode) (const zz_func oct[], BYTE inst[], REGS *regs,
+    PDCENT *pde);
+void ARCH_DEP(pdc_reset) (REGS *regs);
+#endif /*defined(OPTION_PREDECODE_CACHE)*/
 
 
 /* Functions in module panel.c */
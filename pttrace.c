@@ -27,11 +27,83 @@ struct PTT_TRACE
     const void*     data1;              /* Data 1                    */
     const void*     data2;              /* Data 2                    */
     const char*     loc;                /* File name:line number     */
-    struct timeval  tv;                 /* Time of day               */
+    U64             tick;               /* Trace clock timestamp     */
     int             rc;                 /* Return code               */
+    U32             seq;                /* Merge sequence number     */
 };
 typedef struct PTT_TRACE PTT_TRACE;
 
+/*-------------------------------------------------------------------*/
+/* Per-thread Trace Table                                            */
+/*                                                                   */
+/* Each thread traces into its own table so that no lock is needed   */
+/* to claim an entry. A thread reaches its table through its trace   */
+/* slot. The slots of all threads are chained from pttslots and are  */
+/* only merged, by timestamp, when they are printed or dumped. The   */
+/* slot of a thread that ends is reused, with its table, by the next */
+/* new thread, so its entries survive until overwritten.             */
+/*                                                                   */
+/* Slots are never freed, so a thread may always touch its own. A    */
+/* thread marks its slot busy while it uses the table; tables are    */
+/* only read or freed after tracing is stopped and ptt_quiesce has   */
+/* seen every slot idle.                                             */
+/*-------------------------------------------------------------------*/
+struct PTT_RING
+{
+    int             n;                  /* Number of table entries   */
+    int             x;                  /* Index of next entry       */
+    int             full;               /* 1=table has wrapped       */
+    PTT_TRACE       trace[1];           /* Trace table entries       */
+};
+typedef struct PTT_RING PTT_RING;
+
+struct PTT_SLOT
+{
+    struct PTT_SLOT* next;              /* Next slot in chain        */
+    TID             tid;                /* Owning thread (0 = free)  */
+    volatile int    busy;               /* 1=owner is using the table*/
+    PTT_RING*       ring;               /* Trace table or NULL       */
+};
+typedef struct PTT_SLOT PTT_SLOT;
+
+/*-------------------------------------------------------------------*/
+/* Binary trace dump file layout ("ptt dump=filename"). All fields   */
+/* are in host byte order. Times are microseconds since the epoch.   */
+/*-------------------------------------------------------------------*/
+#define PTT_DUMP_ID             "HERCPTT1"
+
+struct PTT_DUMP_HDR
+{
+    char            id[8];              /* PTT_DUMP_ID               */
+    U32             hdrlen;             /* Length of this header     */
+    U32             reclen;             /* Length of each record     */
+    U64             count;              /* Number of records         */
+};
+typedef struct PTT_DUMP_HDR PTT_DUMP_HDR;
+
+struct PTT_DUMP_REC
+{
+    U64             tod;                /* Time of day (usecs)       */
+    U64             tid;                /* Thread id                 */
+    U64             trclass;            /* Trace class               */
+    U64             data1;              /* Data 1                    */
+    U64             data2;              /* Data 2                    */
+    S32             rc;                 /* Return code               */
+    U32             seq;                /* Merge sequence number     */
+    char            msg[32];            /* Trace message             */
+    char            loc[32];            /* File name:line number     */
+};
+typedef struct PTT_DUMP_REC PTT_DUMP_REC;
+
+/*-------------------------------------------------------------------*/
+/* Thread local storage class                                        */
+/*-------------------------------------------------------------------*/
+#if defined( _MSVC_ )
+  #define PTT_THREAD_LOCAL      __declspec( thread )
+#else
+  #define PTT_THREAD_LOCAL      __thread
+#endif
+
 /*-------------------------------------------------------------------*/
 /* Trace classes table                                               */
 /*-------------------------------------------------------------------*/
@@ -50,13 +122,16 @@ typedef struct PTTCL PTTCL;
 HLOCK      pttlock;                     /* Pthreads trace lock       */
 DLL_EXPORT U64 pttclass  = 0;           /* Pthreads trace class      */
 DLL_EXPORT int pttthread = 0;           /* pthreads is active        */
-int        pttracen      = 0;           /* Number of table entries   */
-int        pttracex      = 0;           /* Index of current entry    */
-PTT_TRACE *pttrace       = NULL;        /* Pointer to current entry  */
-int        pttnolock     = 0;           /* 1=no table locking        */
-int        pttnotod      = 0;           /* 1=don't call gettimeofday */
+int        pttracen      = 0;           /* Entries per thread table  */
+PTT_SLOT  *pttslots      = NULL;        /* Chain of thread slots     */
+int        pttnolock     = 0;           /* (obsolete; no table lock) */
+int        pttnotod      = 0;           /* 1=don't timestamp entries */
 int        pttnowrap     = 0;           /* 1=don't wrap              */
 int        pttto         = 0;           /* timeout in seconds        */
+U64        ptttick0      = 0;           /* Trace clock at calibration*/
+U64        pttns0        = 0;           /* Host nsecs at calibration */
+TIMEVAL    ptttv0;                      /* Time of day at calibration*/
+static PTT_THREAD_LOCAL PTT_SLOT* pttmyslot;  /* This thread's slot  */
 COND       ptttocond;                   /* timeout thread condition  */
 HLOCK      ptttolock;                   /* timeout thread lock       */
 TID        ptttotid;                    /* timeout thread id         */
@@ -94,9 +169,10 @@ PTTCL      pttcltab[] =                 /* trace class names table   */
 /* Internal helper macros                                            */
 /*-------------------------------------------------------------------*/
 #define PTT_TRACE_SIZE          sizeof(PTT_TRACE)
+#define PTT_RING_SIZE( _n )     (sizeof(PTT_RING) + ((_n) - 1) * PTT_TRACE_SIZE)
 
 #define OBTAIN_PTTLOCK                                               \
-  do if (!pttnolock) {                                               \
+  do {                                                               \
     int rc = hthread_mutex_lock( &pttlock );                         \
     if (rc)                                                          \
       BREAK_INTO_DEBUGGER();                                         \
@@ -104,7 +180,7 @@ PTTCL      pttcltab[] =                 /* trace class names table   */
   while (0)
 
 #define RELEASE_PTTLOCK                                              \
-  do if (!pttnolock) {                                               \
+  do {                                                               \
     int rc = hthread_mutex_unlock( &pttlock );                       \
     if (rc)                                                          \
       BREAK_INTO_DEBUGGER();                                         \
@@ -169,6 +245,273 @@ static char* pttcl_all( U64 trcl, char** ppStr )
     return *ppStr;
 }
 
+/*-------------------------------------------------------------------*/
+/* Trace clock: the TSC where available, else monotonic nanoseconds  */
+/*-------------------------------------------------------------------*/
+static INLINE U64 ptt_clock()
+{
+#if defined(_MSVC_) && (defined(_M_IX86) || defined(_M_X64))
+    return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((U64) ts.tv_sec * 1000000000) + ts.tv_nsec;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Host nanoseconds, to calibrate the trace clock                    */
+/*-------------------------------------------------------------------*/
+static U64 ptt_ns()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((U64) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/*-------------------------------------------------------------------*/
+/* Calibrate the trace clock against the time of day                 */
+/*-------------------------------------------------------------------*/
+static void ptt_calibrate()
+{
+    gettimeofday( &ptttv0, NULL );
+    pttns0   = ptt_ns();
+    ptttick0 = ptt_clock();
+}
+
+/*-------------------------------------------------------------------*/
+/* Convert a trace clock timestamp to microseconds since the epoch.  */
+/* The tick rate is measured over the whole period since the clock   */
+/* was calibrated, which is as precise as it is going to get.        */
+/*-------------------------------------------------------------------*/
+static U64 ptt_tick2us( U64 tick, double nspertick )
+{
+    U64 us = ((U64) ptttv0.tv_sec * 1000000) + ptttv0.tv_usec;
+    if (tick > ptttick0)
+        us += (U64)((double)(tick - ptttick0) * nspertick / 1000);
+    return us;
+}
+
+static double ptt_nspertick()
+{
+    U64 ns   = ptt_ns();
+    U64 tick = ptt_clock();
+    if (tick <= ptttick0 || ns <= pttns0)
+        return 1.0;
+    return (double)(ns - pttns0) / (double)(tick - ptttick0);
+}
+
+/*-------------------------------------------------------------------*/
+/* Obtain a trace slot for the current thread. Returns NULL when no  */
+/* storage is available.                                             */
+/*-------------------------------------------------------------------*/
+static PTT_SLOT* ptt_get_slot()
+{
+    PTT_SLOT* slot;
+    TID       tid = thread_id();
+
+    OBTAIN_PTTLOCK;
+
+    /* Reuse the slot of a thread that has ended if there is one */
+    for (slot = pttslots; slot; slot = slot->next)
+        if (!slot->tid)
+            break;
+
+    if (!slot && (slot = calloc( 1, sizeof( PTT_SLOT ))) != NULL)
+    {
+        slot->next = pttslots;
+        pttslots   = slot;
+    }
+
+    if (slot)
+    {
+        slot->tid = tid;
+        pttmyslot = slot;
+    }
+
+    RELEASE_PTTLOCK;
+    return slot;
+}
+
+/*-------------------------------------------------------------------*/
+/* Obtain a trace table for a slot. Called with the slot not busy.   */
+/* Returns NULL when tracing is not active or no storage is          */
+/* available.                                                        */
+/*-------------------------------------------------------------------*/
+static PTT_RING* ptt_get_ring( PTT_SLOT* slot )
+{
+    PTT_RING* ring;
+
+    OBTAIN_PTTLOCK;
+
+    if (pttracen == 0)
+    {
+        RELEASE_PTTLOCK;
+        return NULL;
+    }
+
+    if (!(ring = slot->ring)
+     && (ring = calloc( 1, PTT_RING_SIZE( pttracen ))) != NULL)
+    {
+        ring->n    = pttracen;
+        slot->ring = ring;
+    }
+
+    RELEASE_PTTLOCK;
+    return ring;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return 1 if any thread has a trace table                          */
+/*-------------------------------------------------------------------*/
+static int ptt_any_ring()
+{
+    PTT_SLOT* slot;
+    for (slot = pttslots; slot; slot = slot->next)
+        if (slot->ring)
+            return 1;
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Wait until no thread is using its trace table. Caller holds       */
+/* pttlock and has set pttracen to 0. A thread marks its slot busy   */
+/* before it checks pttracen, and we set pttracen before we check    */
+/* the slots, each followed by a full barrier: so either the thread  */
+/* sees that tracing is stopped and leaves its table alone, or we    */
+/* see its slot busy and wait for it. A busy thread never takes      */
+/* pttlock, so waiting while holding it cannot deadlock.             */
+/*-------------------------------------------------------------------*/
+static void ptt_quiesce()
+{
+    PTT_SLOT* slot;
+
+    HOST_MB();
+    for (slot = pttslots; slot; slot = slot->next)
+        while (slot->busy)
+            sched_yield();
+    HOST_MB();
+}
+
+/*-------------------------------------------------------------------*/
+/* Free all trace tables. Caller holds pttlock and has quiesced.     */
+/*-------------------------------------------------------------------*/
+static void ptt_free_rings()
+{
+    PTT_SLOT* slot;
+    for (slot = pttslots; slot; slot = slot->next)
+    {
+        free( slot->ring );
+        slot->ring = NULL;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Release the current thread's trace slot as the thread ends        */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT void ptt_thread_end()
+{
+    if (!pttmyslot)
+        return;
+    OBTAIN_PTTLOCK;
+    pttmyslot->tid = 0;
+    pttmyslot = NULL;
+    RELEASE_PTTLOCK;
+}
+
+/*-------------------------------------------------------------------*/
+/* Compare two trace entries by timestamp, then merge sequence       */
+/*-------------------------------------------------------------------*/
+static int ptt_compare( const void* a, const void* b )
+{
+    const PTT_TRACE* ta = (const PTT_TRACE*) a;
+    const PTT_TRACE* tb = (const PTT_TRACE*) b;
+    if (ta->tick != tb->tick)
+        return ta->tick < tb->tick ? -1 : 1;
+    return ta->seq < tb->seq ? -1 : ta->seq > tb->seq ? 1 : 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Stop tracing and merge all thread tables into one array sorted   */
+/* by time.  Returns the array (caller frees) and the entry count.   */
+/* The caller must call ptt_resume afterwards to restart tracing.    */
+/*-------------------------------------------------------------------*/
+static PTT_TRACE* ptt_merge( int* pn, int* pcount )
+{
+    PTT_SLOT*  slot;
+    PTT_RING*  ring;
+    PTT_TRACE* all;
+    int        i, k, count = 0;
+
+    /* Temporarily disable tracing by indicating empty tables
+       and wait for any thread still filling in an entry */
+    OBTAIN_PTTLOCK;
+    *pn = pttracen;
+    pttracen = 0;
+    ptt_quiesce();
+    RELEASE_PTTLOCK;
+
+    for (slot = pttslots; slot; slot = slot->next)
+        if ((ring = slot->ring) != NULL)
+            count += ring->full ? ring->n : ring->x;
+
+    *pcount = 0;
+    if (!count || !(all = malloc( count * PTT_TRACE_SIZE )))
+        return NULL;
+
+    /* Copy each table oldest entry first so that the sequence
+       number preserves each thread's own order of events even
+       when the entries were not timestamped ('notod'). */
+    for (k = 0, slot = pttslots; slot; slot = slot->next)
+    {
+        if (!(ring = slot->ring))
+            continue;
+        i = ring->full ? ring->x : 0;
+        do
+        {
+            if (ring->trace[i].tid)
+            {
+                all[k] = ring->trace[i];
+                all[k].seq = k;
+                k++;
+            }
+            if (++i >= ring->n) i = 0;
+        }
+        while (i != ring->x && k < count);
+    }
+
+    qsort( all, k, PTT_TRACE_SIZE, ptt_compare );
+    *pcount = k;
+    return all;
+}
+
+/*-------------------------------------------------------------------*/
+/* Restart tracing after ptt_merge, optionally clearing all tables   */
+/*-------------------------------------------------------------------*/
+static void ptt_resume( int n, int clear )
+{
+    PTT_SLOT* slot;
+    PTT_RING* ring;
+
+    if (clear)
+    {
+        for (slot = pttslots; slot; slot = slot->next)
+        {
+            if (!(ring = slot->ring))
+                continue;
+            memset( ring->trace, 0, PTT_TRACE_SIZE * ring->n );
+            ring->x    = 0;
+            ring->full = 0;
+        }
+    }
+
+    /* NOTE: there is no need to obtain the lock since setting
+       an int to non-zero again should be atomic. */
+    pttracen = n;
+}
+
 /*-------------------------------------------------------------------*/
 /* Show the currently defined trace parameters                       */
 /*-------------------------------------------------------------------*/
@@ -313,27 +656,27 @@ DLL_EXPORT int ptt_cmd( int argc, char* argv[], char* cmdline )
                 pttto = to;
                 continue;
             }
+            else if (strncasecmp("dump=", argv[0], 5) == 0 && strlen(argv[0]) > 5)
+            {
+                if (ptt_pthread_dump( &argv[0][5] ) < 0)
+                    rc = -1;
+                continue;
+            }
             else if (argc == 1 && sscanf(argv[0], "%d%c", &n, &c) == 1 && n >= 0)
             {
                 OBTAIN_PTTLOCK;
-                if (pttracen == 0)
+                if (pttracen == 0 && ptt_any_ring())
                 {
-                    if (pttrace != NULL)
-                    {
-                        RELEASE_PTTLOCK;
-                        // "Pttrace: trace is busy"
-                        WRMSG(HHC90010, "E");
-                        return -1;
-                    }
+                    RELEASE_PTTLOCK;
+                    // "Pttrace: trace is busy"
+                    WRMSG(HHC90010, "E");
+                    return -1;
                 }
-                else if (pttrace)
+                if (ptt_any_ring())
                 {
                     pttracen = 0;
-                    RELEASE_PTTLOCK;
-                    usleep(1000);
-                    OBTAIN_PTTLOCK;
-                    free (pttrace);
-                    pttrace = NULL;
+                    ptt_quiesce();
+                    ptt_free_rings();
                 }
                 ptt_trace_init (n, 0);
                 RELEASE_PTTLOCK;
@@ -386,18 +729,14 @@ DLL_EXPORT int ptt_cmd( int argc, char* argv[], char* cmdline )
     return rc;
 }
 
+
 /*-------------------------------------------------------------------*/
 /* Initialize PTT tracing                                            */
 /*-------------------------------------------------------------------*/
 DLL_EXPORT void ptt_trace_init( int n, int init )
 {
-    if (n > 0)
-        pttrace = calloc( n, PTT_TRACE_SIZE );
-    else
-        pttrace = NULL;
-
-    pttracen = pttrace ? n : 0;
-    pttracex = 0;
+    /* Thread tables are allocated as each thread first traces */
+    pttracen = n > 0 ? n : 0;
 
     if (init)       /* First time? */
     {
@@ -420,19 +759,27 @@ DLL_EXPORT void ptt_trace_init( int n, int init )
         pttnowrap = 0;
         pttto     = 0;
         ptttotid  = 0;
+        ptt_calibrate();
     }
 }
 
 /*-------------------------------------------------------------------*/
 /* Primary PTT tracing function to fill in a PTT_TRACE table entry.  */
+/* The entry is taken from the calling thread's own table, so no     */
+/* lock is needed and the timestamp is a single trace clock read.    */
+/* pTV is no longer used; it is retained for compatibility.          */
 /*-------------------------------------------------------------------*/
 DLL_EXPORT void ptt_pthread_trace (U64 trclass, const char *msg,
                                    const void *data1, const void *data2,
                                    const char *loc, int rc, TIMEVAL* pTV)
 {
-int i, n;
+PTT_SLOT*  slot;
+PTT_RING*  ring;
+PTT_TRACE* p;
+
+    UNREFERENCED( pTV );
 
-    if (pttrace == NULL || pttracen == 0 || !(pttclass & trclass)) return;
+    if (pttracen == 0 || !(pttclass & trclass)) return;
     /*
      * Messages from timer.c, clock.c and/or logger.c are not usually
      * that interesting and take up table space.  Check the flags to
@@ -443,106 +790,200 @@ int i, n;
     if (!(pttclass & PTT_CL_TMR) && !strncasecmp( loc, "clock.c:",  8)) return;
     if (!(pttclass & PTT_CL_LOG) && !strncasecmp( loc, "logger.c:", 9)) return;
 
-    /* Check for 'nowrap' */
-    if (pttnowrap && pttracex + 1 >= pttracen) return;
+    /* Locate this thread's trace slot */
+    slot = pttmyslot;
+    if (!slot && !(slot = ptt_get_slot()))
+        return;
 
-    /* Consume another trace table entry */
-    OBTAIN_PTTLOCK;
-    if (pttrace == NULL || (n = pttracen) == 0)
+    /* Mark the slot busy before looking at the table, which may
+       otherwise be freed or read under us (see ptt_quiesce) */
+    slot->busy = 1;
+    HOST_MB();
+    if (pttracen == 0)
     {
-        RELEASE_PTTLOCK;
+        slot->busy = 0;
         return;
     }
-    i = pttracex++;
-    if (pttracex >= n)
-        pttracex = 0;
-    RELEASE_PTTLOCK;
+    if (!(ring = slot->ring))
+    {
+        slot->busy = 0;
+        if (!ptt_get_ring( slot ))
+            return;
+        slot->busy = 1;
+        HOST_MB();
+        if (pttracen == 0 || !(ring = slot->ring))
+        {
+            slot->busy = 0;
+            return;
+        }
+    }
 
-    /* Fill in the trace table entry */
-    if (pttnotod == 0)
+    /* Check for 'nowrap' */
+    if (pttnowrap && ring->full)
     {
-        if (pTV)
-            memcpy( &pttrace[i].tv, pTV, sizeof( TIMEVAL ));
-        else
-            gettimeofday( &pttrace[i].tv, NULL );
+        slot->busy = 0;
+        return;
+    }
+
+    /* Consume another trace table entry */
+    p = &ring->trace[ ring->x ];
+    if (++ring->x >= ring->n)
+    {
+        ring->x    = 0;
+        ring->full = 1;
     }
-    pttrace[i].tid     = thread_id();
-    pttrace[i].trclass = trclass;
-    pttrace[i].msg     = msg;
-    pttrace[i].data1   = data1;
-    pttrace[i].data2   = data2;
-    pttrace[i].loc     = loc;
-    pttrace[i].rc      = rc;
+
+    /* Fill in the trace table entry */
+    p->tick    = pttnotod ? 0 : ptt_clock();
+    p->tid     = thread_id();
+    p->trclass = trclass;
+    p->msg     = msg;
+    p->data1   = data1;
+    p->data2   = data2;
+    p->loc     = loc;
+    p->rc      = rc;
+
+    /* Let ptt_quiesce see the entry complete before the slot idle */
+    HOST_MB();
+    slot->busy = 0;
 }
 
 /*-------------------------------------------------------------------*/
-/* Function to print all PTT_TRACE table entries.                    */
+/* Function to print all PTT_TRACE table entries in time order.      */
 /* Return code is the  #of table entries printed.                    */
 /*-------------------------------------------------------------------*/
 DLL_EXPORT int ptt_pthread_print ()
 {
+PTT_TRACE* all;
+TIMEVAL    tv;
+U64        us;
+double     nspertick;
 int   i, n, count = 0;
 char  retcode[32]; // (retcode is 'int'; if x64, 19 digits or more!)
 char  tod[27];     // "YYYY-MM-DD HH:MM:SS.uuuuuu"
 
-    if (pttrace && pttracen)
+    if (pttracen)
     {
-        /* Temporarily disable tracing by indicating an empty table */
-        OBTAIN_PTTLOCK;
-        n = pttracen;       /* save number of trace table entries   */
-        pttracen = 0;       /* indicate empty table to stop tracing */
-        RELEASE_PTTLOCK;
+        nspertick = ptt_nspertick();
+        all = ptt_merge( &n, &count );
 
-        /* Print the trace table */
-        i = pttracex;
-        do
+        /* Print the merged trace table */
+        for (i=0; i < count; i++)
         {
-            if (pttrace[i].tid)
+            us = ptt_tick2us( all[i].tick, nspertick );
+            tv.tv_sec  = (long)(us / 1000000);
+            tv.tv_usec = (long)(us % 1000000);
+            FormatTIMEVAL( &tv, tod, sizeof( tod ));
+
+            /* If this is the thread class, an 'rc' of PTT_MAGIC
+               indicates its value is uninteresting to us, so we
+               don't show it by formatting it as an empty string.
+            */
+            if (all[i].rc == PTT_MAGIC && (all[i].trclass & PTT_CL_THR))
+                retcode[0] = '\0';
+            else
             {
-                FormatTIMEVAL( &pttrace[i].tv, tod, sizeof( tod ));
-
-                /* If this is the thread class, an 'rc' of PTT_MAGIC
-                   indicates its value is uninteresting to us, so we
-                   don't show it by formatting it as an empty string.
+                /* If not thread class, format return code as just
+                   another 32-bit hex value. Otherwise if it is the
+                   thread class, format it as a +/- decimal value.
                 */
-                if (pttrace[i].rc == PTT_MAGIC && (pttrace[i].trclass & PTT_CL_THR))
-                    retcode[0] = '\0';
+                if((all[i].trclass & ~PTT_CL_THR))
+                    MSGBUF(retcode, "%8.8"PRIx32, all[i].rc);
                 else
-                {
-                    /* If not thread class, format return code as just
-                       another 32-bit hex value. Otherwise if it is the
-                       thread class, format it as a +/- decimal value.
-                    */
-                    if((pttrace[i].trclass & ~PTT_CL_THR))
-                        MSGBUF(retcode, "%8.8"PRIx32, pttrace[i].rc);
-                    else
-                        MSGBUF(retcode, "%d", pttrace[i].rc);
-                }
-                WRMSG( HHC90021, "I"
-                    , pttrace[i].loc                    // File name (string; 18 chars)
-                    , &tod[11]                          // Time of day (HH:MM:SS.usecs)
-                    , pttrace[i].tid                    // Thread id
-                    , pttrace[i].msg                    // Trace message (string; 18 chars)
-                    , (uintptr_t)pttrace[i].data1       // Data value 1
-                    , (uintptr_t)pttrace[i].data2       // Data value 2
-                    , retcode                           // Return code (or empty string)
-                );
-                count++;
+                    MSGBUF(retcode, "%d", all[i].rc);
             }
-            if (++i >= n) i = 0;
-        } while (i != pttracex);
+            WRMSG( HHC90021, "I"
+                , all[i].loc                        // File name (string; 18 chars)
+                , &tod[11]                          // Time of day (HH:MM:SS.usecs)
+                , all[i].tid                        // Thread id
+                , all[i].msg                        // Trace message (string; 18 chars)
+                , (uintptr_t)all[i].data1           // Data value 1
+                , (uintptr_t)all[i].data2           // Data value 2
+                , retcode                           // Return code (or empty string)
+            );
+        }
+        free( all );
 
         /* Clear all the table entries we just printed and
-           enable tracing again starting at entry number 0.
-           NOTE: there is no need to obtain the lock since:
-           a) pttracex is never accessed unless pttracen is
-           non-zero, b) because pttracen is an int, setting
-           it to non-zero again should be atomic.
-        */
-        memset( pttrace, 0, PTT_TRACE_SIZE * n );
-        pttracex = 0;
-        pttracen = n;
+           enable tracing again starting at entry number 0. */
+        ptt_resume( n, 1 );
+    }
+
+    return count;
+}
+
+/*-------------------------------------------------------------------*/
+/* Function to write all PTT_TRACE table entries in time order to a  */
+/* binary file for offline analysis. The tables are not cleared.     */
+/* Return code is the #of entries written, or -1 on error.           */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int ptt_pthread_dump( const char* filename )
+{
+PTT_TRACE*   all;
+PTT_DUMP_HDR hdr;
+PTT_DUMP_REC rec;
+FILE*        fp;
+double       nspertick;
+int   i, n, count = 0, rc = 0;
+char  pathname[ MAX_PATH ];
+
+    if (!pttracen)
+    {
+        // "Pttrace: trace is not active"
+        WRMSG( HHC90027, "E" );
+        return -1;
+    }
+
+    hostpath( pathname, filename, sizeof( pathname ));
+    if (!(fp = fopen( pathname, "wb" )))
+    {
+        // "Pttrace: error writing file %s: %s"
+        WRMSG( HHC90026, "E", pathname, strerror( errno ));
+        return -1;
+    }
+
+    nspertick = ptt_nspertick();
+    all = ptt_merge( &n, &count );
+
+    memset( &hdr, 0, sizeof( hdr ));
+    memcpy( hdr.id, PTT_DUMP_ID, sizeof( hdr.id ));
+    hdr.hdrlen = sizeof( hdr );
+    hdr.reclen = sizeof( rec );
+    hdr.count  = count;
+    if (fwrite( &hdr, sizeof( hdr ), 1, fp ) != 1)
+        rc = -1;
+
+    for (i=0; i < count && !rc; i++)
+    {
+        memset( &rec, 0, sizeof( rec ));
+        rec.tod     = ptt_tick2us( all[i].tick, nspertick );
+        rec.tid     = (U64)(uintptr_t) all[i].tid;
+        rec.trclass = all[i].trclass;
+        rec.data1   = (U64)(uintptr_t) all[i].data1;
+        rec.data2   = (U64)(uintptr_t) all[i].data2;
+        rec.rc      = all[i].rc;
+        rec.seq     = all[i].seq;
+        strlcpy( rec.msg, all[i].msg ? all[i].msg : "", sizeof( rec.msg ));
+        strlcpy( rec.loc, all[i].loc ? all[i].loc : "", sizeof( rec.loc ));
+        if (fwrite( &rec, sizeof( rec ), 1, fp ) != 1)
+            rc = -1;
+    }
+    free( all );
+
+    /* Resume tracing without clearing anything */
+    ptt_resume( n, 0 );
+
+    if (fclose( fp ) != 0)
+        rc = -1;
+
+    if (rc)
+    {
+        // "Pttrace: error writing file %s: %s"
+        WRMSG( HHC90026, "E", pathname, strerror( errno ));
+        return -1;
     }
 
+    // "Pttrace: %d entries written to file %s"
+    WRMSG( HHC90025, "I", count, pathname );
     return count;
 }
@@ -4951,6 +4951,9 @@ U32 num;                                /* Number of bytes to move   */
         DBGTRC( dev, "Activate Queues: Entry iqm=%8.8x oqm=%8.8x\n",dev->qdio.i_qmask, dev->qdio.o_qmask);
         PTT_QETH_TRACE( "actq entr", 0,0,0 );
 
+        /* This device thread runs the queues until they are halted */
+        apply_thread_affinity( AFFINITY_QETH, -1 );
+
         /* Loop until halt signal is received via notification pipe */
         while (1)
         {
@@ -5056,6 +5059,10 @@ U32 num;                                /* Number of bytes to move   */
         DBGTRC( dev, "Activate Queues: Exit\n");
         PTT_QETH_TRACE( "actq exit", 0,0,0 );
 
+        /* Give the device thread back its device thread affinity */
+        if (sysblk.affinity[ AFFINITY_QETH ])
+            set_thread_affinity( 0, sysblk.affinity[ AFFINITY_DEV ] );
+
         /* Return unit status */
         *unitstat = CSW_CE | CSW_DE;
         break;
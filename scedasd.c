@@ -139,6 +139,8 @@ size_t chunk;
 int bytes;
 time_t begtime, curtime;
 char fmt_mem[8];
+struct stat st;
+U64 len;
 
     fd = HOPEN (fname, O_RDONLY|O_BINARY);
     if (fd < 0)
@@ -148,6 +150,32 @@ char fmt_mem[8];
         return fd;
     }
 
+    /* Large files are mapped and copied with several threads */
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+     && (U64)st.st_size >= LOADMEM_MAP_MIN && startloc < sysblk.mainsize)
+    {
+        len = MIN((U64)st.st_size, sysblk.mainsize - startloc);
+        if (loadmem_map_file(fd, 0, len, sysblk.mainstor + startloc,
+                             noisy ? "loaded" : NULL) == 0)
+        {
+            for (pageaddr = startloc & PAGEFRAME_PAGEMASK;
+                 pageaddr < startloc + len;
+                 pageaddr += PAGEFRAME_PAGESIZE)
+                STORAGE_KEY(pageaddr, &sysblk) |= STORKEY_REF|STORKEY_CHANGE;
+            close(fd);
+
+            /* Check if end of storage reached */
+            if ((U64)st.st_size > len)
+            {
+                if (noisy)
+                    // "SCE file %s: load main terminated at end of mainstor"
+                    WRMSG(HHC00603, "W", fname);
+                return +1;
+            }
+            return 0;
+        }
+    }
+
     /* Calculate size of first chunk to reach page boundary */
     chunk = PAGEFRAME_PAGESIZE - (startloc & PAGEFRAME_BYTEMASK);
     aaddr = startloc;
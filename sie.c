@@ -290,7 +290,15 @@ U64     dreg;
 #endif
             return;
         }
-        cpu_init (regs->cpuad, GUESTREGS, regs);
+        if (cpu_init (regs->cpuad, GUESTREGS, regs))
+        {
+            free_aligned(GUESTREGS);
+            GUESTREGS = NULL;
+#if !defined(NO_SIGABEND_HANDLER)
+            signal_thread(sysblk.cputid[regs->cpuad], SIGUSR1);
+#endif
+            return;
+        }
      }
 
     /* Direct pointer to state descriptor block */
@@ -64,40 +64,903 @@ DEVBLK *dev;
     return NULL;
 }
 
-int suspend_cmd(int argc, char *argv[],char *cmdline)
+/*-------------------------------------------------------------------*/
+/* Chunked storage images                                            */
+/*-------------------------------------------------------------------*/
+typedef struct _SR_AREA {               /* Storage area being saved  */
+    U32      key;                       /* Chunk unit key            */
+    char    *what;                      /* Name for messages         */
+    BYTE    *stor;                      /* Storage area              */
+    U64      size;                      /* ...and its size           */
+    U64     *basesum;                   /* Base image chunk sums     */
+    U64     *pagesum;                   /* Sums of the pages saved   */
+    BYTE    *dirty;                     /* Pages to save again       */
+    int      tracked;                   /* Host tracks page changes  */
+} SR_AREA;
+
+typedef struct _SR_SLOT {               /* Chunk unit read by resume */
+    int      state;                     /* Slot state...             */
+#define SR_SLOT_FREE    0               /* ...available for reading  */
+#define SR_SLOT_READING 1               /* ...being read             */
+#define SR_SLOT_READY   2               /* ...waiting to be restored */
+#define SR_SLOT_BUSY    3               /* ...being restored         */
+    U32      key;                       /* Chunk unit key            */
+    U32      len;                       /* Chunk unit length         */
+    U64      off;                       /* Chunk storage offset      */
+    U64      seq;                       /* Order read                */
+    BYTE    *buf;                       /* Chunk unit data           */
+} SR_SLOT;
+
+typedef struct _SR_CHUNKS {             /* Chunk worker threads      */
+    LOCK     lock;                      /* Serializes this block     */
+    COND     cond;                      /* Signalled on slot changes */
+    int      nthreads;                  /* Number of workers         */
+    TID      tid[SR_MAX_THREADS];       /* Worker thread ids         */
+    int      error;                     /* A worker has failed       */
+    /* Suspend */
+    SR_FILE  file;                      /* Image being written       */
+    SR_AREA *area;                      /* Storage being written     */
+    U64      next;                      /* Next chunk to consider    */
+    U64      written;                   /* Chunks written            */
+    U64      pages;                     /* Pages written             */
+    U64      bytes;                     /* Unit bytes written        */
+    /* Resume */
+    int      stop;                      /* Workers are to exit       */
+    U64      seq;                       /* Chunk units read          */
+    SR_SLOT  slot[2*SR_MAX_THREADS];    /* Chunk units read          */
+} SR_CHUNKS;
+
+/* Checksum identifying the contents of a page */
+static U64 sr_page_sum (BYTE *p)
 {
-char    *fn = SR_DEFAULT_FILENAME;
-SR_FILE  file;
-CPU_BITMAP started_mask;
-struct   timeval tv;
-time_t   tt;
-int      i, j, rc;
-REGS    *regs;
-DEVBLK  *dev;
-IOINT   *ioq;
-BYTE     psw[16];
+#ifdef HAVE_LIBZ
+    return ((U64)crc32(0L, p, 4096) << 32) | adler32(1L, p, 4096);
+#else
+    UNREFERENCED(p);
+    return 0;
+#endif
+}
 
-    UNREFERENCED(cmdline);
+/* Append a page checksum to a chunk checksum */
+static U64 sr_sum_append (U64 sum, U64 psum)
+{
+#ifdef HAVE_LIBZ
+    return ((U64)crc32_combine((uLong)(sum >> 32), (uLong)(psum >> 32), 4096) << 32)
+         | adler32_combine((uLong)(sum & 0xFFFFFFFF), (uLong)(psum & 0xFFFFFFFF), 4096);
+#else
+    UNREFERENCED(sum);
+    UNREFERENCED(psum);
+    return 0;
+#endif
+}
 
-    if (argc > 2)
+/* Initial chunk checksum, to which page checksums are appended */
+#ifdef HAVE_LIBZ
+  #define SR_SUM_INIT   1               /* crc32 0, adler32 1        */
+#else
+  #define SR_SUM_INIT   0
+#endif
+
+/* Test whether a 4K page is all zero */
+static int sr_page_zero (BYTE *p)
+{
+U64    *q = (U64*)p;
+int     i;
+
+    for (i = 0; i < 4096 / 8; i++)
+        if (q[i])
+            return 0;
+    return 1;
+}
+
+/* Number of chunk worker threads to use */
+static int sr_chunk_threads ()
+{
+    return hostinfo.num_procs > 1 ?
+           MIN(hostinfo.num_procs, SR_MAX_THREADS) : 1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Suspend worker: checksum, pack and compress chunks and write them */
+/*                                                                   */
+/* Without area->dirty a chunk unit holds the whole chunk, with pages */
+/* that are zero left out.  With it, a delta unit is written holding */
+/* just the pages marked dirty whose checksum differs from the one   */
+/* saved, and only those pages are replaced when it is restored.     */
+/*-------------------------------------------------------------------*/
+static void *sr_suspend_thread (void *arg)
+{
+SR_CHUNKS *ck = arg;                    /* Chunk worker block        */
+SR_AREA *area = ck->area;               /* Storage being written     */
+BYTE    *raw, *out;                     /* Page data, chunk unit     */
+BYTE    *p, *copy;                      /* Chunk in storage, page    */
+U64      i, off, pn, sum, psum, zsum;   /* Chunk number, offset, ... */
+U32      len, n, pg, datalen;
+int      rc, zero;
+
+    raw = malloc(SR_STOR_CHUNKSIZE);
+    out = malloc(SR_CHUNK_HDRLEN + SR_STOR_CHUNKSIZE);
+    zsum = 0;
+    if (out)
     {
-        // "SR: too many arguments"
-        WRMSG(HHC02000, "E");
+        memset(out, 0, 4096);
+        zsum = sr_page_sum(out);
+    }
+
+    while (raw && out)
+    {
+        obtain_lock(&ck->lock);
+        i = ck->next++;
+        rc = ck->error;
+        release_lock(&ck->lock);
+
+        off = i * SR_STOR_CHUNKSIZE;
+        if (rc || off >= area->size)
+            break;
+        p = area->stor + off;
+        len = (U32)MIN(SR_STOR_CHUNKSIZE, area->size - off);
+
+        memset(out, 0, SR_CHUNK_HDRLEN);
+        sum = SR_SUM_INIT;
+        for (n = pg = 0; pg < len / 4096; pg++)
+        {
+            pn = off / 4096 + pg;
+            if (area->dirty && !(area->dirty[pn / 8] & (0x80 >> (pn % 8))))
+                continue;
+
+            /* Work from a copy, since the storage may be changing */
+            copy = raw + n * 4096;
+            memcpy(copy, p + pg * 4096, 4096);
+            zero = sr_page_zero(copy);
+            psum = zero ? zsum : sr_page_sum(copy);
+            sum = sr_sum_append(sum, psum);
+
+            if (area->pagesum)
+            {
+                if (area->dirty && area->pagesum[pn] == psum)
+                    continue;
+                area->pagesum[pn] = psum;
+            }
+            if (zero && !area->dirty)
+                continue;
+            out[SR_CHUNK_MAP + pg / 8] |= 0x80 >> (pg % 8);
+            n++;
+        }
+
+        if (area->dirty)
+        {
+            /* Delta units only hold the pages that changed */
+            if (n == 0)
+                continue;
+            out[SR_CHUNK_FLAGS] |= SR_CHUNK_DELTA;
+            sum = 0;
+        }
+        else
+        {
+            /* Chunks unchanged since the base image are left out */
+            if (area->basesum && area->basesum[i] == sum)
+                continue;
+
+            /* Zero chunks are left out of a full image, which resume
+               clears storage for; an increment must still record them */
+            if (n == 0 && area->basesum == NULL)
+                continue;
+        }
+
+        datalen = n * 4096;
+#ifdef HAVE_LIBZ
+        {
+            uLongf clen = datalen;
+            if (n && compress2(out + SR_CHUNK_HDRLEN, &clen, raw, datalen,
+                               Z_BEST_SPEED) == Z_OK && clen < datalen)
+            {
+                out[SR_CHUNK_FLAGS] |= SR_CHUNK_ZLIB;
+                datalen = (U32)clen;
+            }
+        }
+        if (!(out[SR_CHUNK_FLAGS] & SR_CHUNK_ZLIB))
+#endif
+            memcpy(out + SR_CHUNK_HDRLEN, raw, datalen);
+        store_dw(out + SR_CHUNK_OFFSET, off);
+        store_dw(out + SR_CHUNK_SUM, sum);
+        store_fw(out + SR_CHUNK_DATALEN, datalen);
+
+        obtain_lock(&ck->lock);
+        if (!ck->error)
+        {
+            if (sr_write_hdr((FILE*)ck->file, area->key,
+                             SR_CHUNK_HDRLEN + datalen) != 0)
+                ck->error = 1;
+            else if ((U32)SR_WRITE(out, 1, SR_CHUNK_HDRLEN + datalen,
+                                   ck->file) != SR_CHUNK_HDRLEN + datalen)
+            {
+                sr_write_error_();
+                ck->error = 1;
+            }
+            else
+            {
+                ck->written++;
+                ck->pages += n;
+                ck->bytes += 8 + SR_CHUNK_HDRLEN + datalen;
+            }
+        }
+        release_lock(&ck->lock);
+    }
+
+    if (!raw || !out)
+    {
+        // "SR: error in function %s: %s"
+        WRMSG(HHC02001, "E", "malloc()", strerror(errno));
+        obtain_lock(&ck->lock);
+        ck->error = 1;
+        release_lock(&ck->lock);
+    }
+    free(raw);
+    free(out);
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Write a storage area as chunk units using several threads.        */
+/* Returns the number of pages written, or -1.                       */
+/*-------------------------------------------------------------------*/
+static S64 sr_write_chunks (SR_FILE file, SR_AREA *area)
+{
+SR_CHUNKS *ck;
+char       buf[32];
+int        i, rc;
+S64        pages;
+
+    if ((ck = calloc(1, sizeof(SR_CHUNKS))) == NULL)
+    {
+        // "SR: error in function %s: %s"
+        WRMSG(HHC02001, "E", "calloc()", strerror(errno));
         return -1;
     }
+    initialize_lock(&ck->lock);
+    ck->file = file;
+    ck->area = area;
 
-    if (argc == 2)
-        fn = argv[1];
+    /* The chunks compress themselves; spare the stream the effort */
+    SR_SETLEVEL(file, SR_LEVEL_NONE);
 
-    file = SR_OPEN (fn, "wb");
+    for (i = 0; i < sr_chunk_threads(); i++)
+    {
+        rc = create_thread(&ck->tid[ck->nthreads], JOINABLE,
+                           sr_suspend_thread, ck, "sr_suspend_thread");
+        if (rc)
+        {
+            // "Error in function create_thread(): %s"
+            WRMSG(HHC00102, "E", strerror(rc));
+            break;
+        }
+        ck->nthreads++;
+    }
+    if (ck->nthreads == 0)
+        sr_suspend_thread(ck);
+    for (i = 0; i < ck->nthreads; i++)
+        join_thread(ck->tid[i], NULL);
+
+    SR_SETLEVEL(file, SR_LEVEL_DEFAULT);
+
+    if (!ck->error && !area->dirty)
+        // "SR: %s storage: %"PRIu64" of %"PRIu64" chunks written in %s"
+        WRMSG(HHC02023, "I", area->what, ck->written,
+              (area->size + SR_STOR_CHUNKSIZE - 1) / SR_STOR_CHUNKSIZE,
+              fmt_memsize_rounded(ck->bytes, buf, sizeof(buf)));
+
+    pages = ck->error ? -1 : (S64)ck->pages;
+    destroy_lock(&ck->lock);
+    free(ck);
+    return pages;
+}
+
+/*-------------------------------------------------------------------*/
+/* Restore one chunk unit into main or expanded storage              */
+/*-------------------------------------------------------------------*/
+static int sr_restore_chunk (SR_SLOT *slot, BYTE *raw)
+{
+BYTE    *stor, *data, *p;               /* Storage, page data        */
+U64      size, off;                     /* Storage size, offset      */
+U32      len, datalen, pg, n, run;
+int      back, delta;
+
+    if (slot->key == SR_SYS_MAINCHUNK)
+    {
+        stor = sysblk.mainstor;
+        size = sysblk.mainsize;
+        back = sysblk.mainback;
+    }
+    else
+    {
+        stor = sysblk.xpndstor;
+        size = (U64)sysblk.xpndsize * 4096;
+        back = sysblk.xpndback;
+    }
+
+    off = fetch_dw(slot->buf + SR_CHUNK_OFFSET);
+    datalen = fetch_fw(slot->buf + SR_CHUNK_DATALEN);
+    data = slot->buf + SR_CHUNK_HDRLEN;
+    if (off % SR_STOR_CHUNKSIZE || off >= size
+     || datalen != slot->len - SR_CHUNK_HDRLEN)
+        goto sr_chunk_error;
+    p = stor + off;
+    len = (U32)MIN(SR_STOR_CHUNKSIZE, size - off);
+    delta = (slot->buf[SR_CHUNK_FLAGS] & SR_CHUNK_DELTA) != 0;
+
+    /* Count the pages present */
+    for (n = pg = 0; pg < len / 4096; pg++)
+        if (slot->buf[SR_CHUNK_MAP + pg / 8] & (0x80 >> (pg % 8)))
+            n++;
+
+    if (slot->buf[SR_CHUNK_FLAGS] & SR_CHUNK_ZLIB)
+    {
+#ifdef HAVE_LIBZ
+        uLongf rawlen = SR_STOR_CHUNKSIZE;
+        if (uncompress(raw, &rawlen, data, datalen) != Z_OK
+         || rawlen != n * 4096)
+            goto sr_chunk_error;
+        data = raw;
+#else
+        goto sr_chunk_error;
+#endif
+    }
+    else if (datalen != n * 4096)
+        goto sr_chunk_error;
+
+    /* Copy the pages present and clear the others, unless this
+       is a delta unit, where the others are left as they are */
+    for (run = pg = 0; pg < len / 4096; pg++)
+    {
+        if (!(slot->buf[SR_CHUNK_MAP + pg / 8] & (0x80 >> (pg % 8))))
+            continue;
+        if (run < pg && !delta)
+            storage_release(p + run * 4096, (pg - run) * 4096, back);
+        memcpy(p + pg * 4096, data, 4096);
+        data += 4096;
+        run = pg + 1;
+    }
+    if (run < len / 4096 && !delta)
+        storage_release(p + run * 4096, (len / 4096 - run) * 4096, back);
+    return 0;
+
+sr_chunk_error:
+    // "SR: invalid storage chunk at offset %16.16"PRIX64
+    WRMSG(HHC02026, "E", off);
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Resume worker: restore chunk units as they are read.  A later     */
+/* unit for the same chunk, which a delta unit of a checkpoint is,   */
+/* waits until all the earlier ones have been restored.              */
+/*-------------------------------------------------------------------*/
+static void *sr_resume_thread (void *arg)
+{
+SR_CHUNKS *ck = arg;                    /* Chunk worker block        */
+SR_SLOT   *slot, *s;                    /* Chunk unit to restore     */
+BYTE      *raw;                         /* Uncompressed page data    */
+int        i, j, rc;
+
+    raw = malloc(SR_STOR_CHUNKSIZE);
+
+    obtain_lock(&ck->lock);
+    if (raw == NULL)
+    {
+        // "SR: error in function %s: %s"
+        WRMSG(HHC02001, "E", "malloc()", strerror(errno));
+        ck->error = 1;
+    }
+    while (raw)
+    {
+        for (slot = NULL, i = 0; i < 2 * ck->nthreads && !slot; i++)
+        {
+            if (ck->slot[i].state != SR_SLOT_READY)
+                continue;
+            slot = &ck->slot[i];
+            for (j = 0; j < 2 * ck->nthreads; j++)
+            {
+                s = &ck->slot[j];
+                if ((s->state == SR_SLOT_READY || s->state == SR_SLOT_BUSY)
+                 && s->seq < slot->seq
+                 && s->key == slot->key && s->off == slot->off)
+                {
+                    slot = NULL;
+                    break;
+                }
+            }
+        }
+        if (slot == NULL)
+        {
+            if (ck->stop || ck->error)
+                break;
+            wait_condition(&ck->cond, &ck->lock);
+            continue;
+        }
+        slot->state = SR_SLOT_BUSY;
+        release_lock(&ck->lock);
+
+        rc = sr_restore_chunk(slot, raw);
+
+        obtain_lock(&ck->lock);
+        slot->state = SR_SLOT_FREE;
+        if (rc)
+            ck->error = 1;
+        broadcast_condition(&ck->cond);
+    }
+    broadcast_condition(&ck->cond);
+    release_lock(&ck->lock);
+
+    free(raw);
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Start the resume workers                                          */
+/*-------------------------------------------------------------------*/
+static SR_CHUNKS *sr_chunks_start ()
+{
+SR_CHUNKS *ck;
+int        i, rc;
+
+    if ((ck = calloc(1, sizeof(SR_CHUNKS))) == NULL)
+    {
+        // "SR: error in function %s: %s"
+        WRMSG(HHC02001, "E", "calloc()", strerror(errno));
+        return NULL;
+    }
+    initialize_lock(&ck->lock);
+    initialize_condition(&ck->cond);
+
+    for (i = 0; i < 2 * sr_chunk_threads(); i++)
+        if ((ck->slot[i].buf = malloc(SR_CHUNK_HDRLEN + SR_STOR_CHUNKSIZE)) == NULL)
+            break;
+
+    obtain_lock(&ck->lock);
+    for (i = 0; i < sr_chunk_threads() && ck->slot[2*i+1].buf; i++)
+    {
+        rc = create_thread(&ck->tid[ck->nthreads], JOINABLE,
+                           sr_resume_thread, ck, "sr_resume_thread");
+        if (rc)
+        {
+            // "Error in function create_thread(): %s"
+            WRMSG(HHC00102, "E", strerror(rc));
+            break;
+        }
+        ck->nthreads++;
+    }
+    release_lock(&ck->lock);
+
+    if (ck->nthreads == 0)
+    {
+        for (i = 0; i < 2 * SR_MAX_THREADS; i++)
+            free(ck->slot[i].buf);
+        destroy_condition(&ck->cond);
+        destroy_lock(&ck->lock);
+        free(ck);
+        return NULL;
+    }
+    return ck;
+}
+
+/*-------------------------------------------------------------------*/
+/* Wait for the resume workers to restore all chunks, then stop them */
+/*-------------------------------------------------------------------*/
+static int sr_chunks_finish (SR_CHUNKS *ck)
+{
+int     i, rc;
+
+    obtain_lock(&ck->lock);
+    ck->stop = 1;
+    broadcast_condition(&ck->cond);
+    release_lock(&ck->lock);
+
+    for (i = 0; i < ck->nthreads; i++)
+        join_thread(ck->tid[i], NULL);
+
+    rc = ck->error ? -1 : 0;
+    for (i = 0; i < 2 * SR_MAX_THREADS; i++)
+        free(ck->slot[i].buf);
+    destroy_condition(&ck->cond);
+    destroy_lock(&ck->lock);
+    free(ck);
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Read a chunk unit and pass it to a resume worker                  */
+/*-------------------------------------------------------------------*/
+static int sr_read_chunk (SR_CHUNKS *ck, SR_FILE file, U32 key, U32 len)
+{
+SR_SLOT *slot;
+int      i;
+
+    if (len < SR_CHUNK_HDRLEN || len > SR_CHUNK_HDRLEN + SR_STOR_CHUNKSIZE)
+    {
+        // "SR: value error, incorrect length"
+        WRMSG(HHC02020, "E");
+        return -1;
+    }
+
+    /* Wait for a free slot */
+    obtain_lock(&ck->lock);
+    for (;;)
+    {
+        for (slot = NULL, i = 0; i < 2 * ck->nthreads; i++)
+            if (ck->slot[i].state == SR_SLOT_FREE)
+            {
+                slot = &ck->slot[i];
+                break;
+            }
+        if (slot || ck->error)
+            break;
+        wait_condition(&ck->cond, &ck->lock);
+    }
+    if (ck->error)
+    {
+        release_lock(&ck->lock);
+        return -1;
+    }
+    slot->state = SR_SLOT_READING;
+    release_lock(&ck->lock);
+
+    slot->key = key;
+    slot->len = len;
+    i = sr_read_buf((FILE*)file, slot->buf, len);
+    slot->off = fetch_dw(slot->buf + SR_CHUNK_OFFSET);
+
+    obtain_lock(&ck->lock);
+    slot->seq = ck->seq++;
+    slot->state = i ? SR_SLOT_FREE : SR_SLOT_READY;
+    broadcast_condition(&ck->cond);
+    release_lock(&ck->lock);
+    return i;
+}
+
+/*-------------------------------------------------------------------*/
+/* Process the storage chunks of a base image and of its own bases.  */
+/* With ck, the chunks are restored; otherwise their checksums are   */
+/* recorded in msum and xsum, which must match the storage sizes.    */
+/*-------------------------------------------------------------------*/
+static int sr_scan_base (char *fn, int depth, SR_CHUNKS *ck,
+                         U64 *msum, U64 *xsum)
+{
+SR_FILE  file;
+U32      key, len;
+U64      value, n, size;
+BYTE     hdr[SR_CHUNK_HDRLEN];
+char     buf[SR_MAX_STRING_LENGTH+1];
+char     buf1[20], buf2[20];
+
+    if (depth > SR_MAX_BASE_DEPTH)
+    {
+        // "SR: base images nested more than %d deep"
+        WRMSG(HHC02028, "E", SR_MAX_BASE_DEPTH);
+        return -1;
+    }
+
+    file = SR_OPEN(fn, "rb");
     if (file == NULL)
     {
-        // "SR: error in function '%s': '%s'"
-        WRMSG(HHC02001, "E","open()",strerror(errno));
+        // "SR: error in function %s: %s"
+        WRMSG(HHC02001, "E", "open()", strerror(errno));
+        goto sr_base_error;
+    }
+
+    if (sr_read_hdr((FILE*)file, &key, &len) != 0
+     || key != SR_HDR_ID
+     || sr_read_string((FILE*)file, buf, len) != 0
+     || strcmp(buf, SR_ID_CHUNKED))
+    {
+        // "SR: file %s does not contain chunked storage"
+        WRMSG(HHC02024, "E", fn);
+        goto sr_base_error;
+    }
+
+    /* Storage units all precede the first delimiter */
+    while (key != SR_DELIMITER && key != SR_EOF)
+    {
+        if (sr_read_hdr((FILE*)file, &key, &len) != 0)
+            goto sr_base_error;
+
+        switch (key) {
+
+        case SR_SYS_STORBASE:
+            if (sr_read_string((FILE*)file, buf, len) != 0
+             || sr_scan_base(buf, depth + 1, ck, msum, xsum) != 0)
+                goto sr_base_error;
+            break;
+
+        case SR_SYS_MAINSIZE:
+        case SR_SYS_XPNDSIZE:
+            if (sr_read_value((FILE*)file, len, &value, sizeof(value)) != 0)
+                goto sr_base_error;
+            size = key == SR_SYS_MAINSIZE ? sysblk.mainsize
+                                          : (U64)sysblk.xpndsize;
+            if (ck == NULL && value != size)
+            {
+                MSGBUF(buf1, "%"PRIu64, value);
+                MSGBUF(buf2, "%"PRIu64, size);
+                // "SR: mismatch in %s: %s found, %s expected"
+                WRMSG(HHC02009, "E", key == SR_SYS_MAINSIZE ? "mainsize"
+                                                            : "expand size",
+                      buf1, buf2);
+                goto sr_base_error;
+            }
+            break;
+
+        case SR_SYS_MAINCHUNK:
+        case SR_SYS_XPNDCHUNK:
+            if (ck)
+            {
+                if (sr_read_chunk(ck, file, key, len) != 0)
+                    goto sr_base_error;
+                break;
+            }
+            if (len < SR_CHUNK_HDRLEN
+             || sr_read_buf((FILE*)file, hdr, SR_CHUNK_HDRLEN) != 0
+             || sr_read_skip((FILE*)file, len - SR_CHUNK_HDRLEN) != 0)
+                goto sr_base_error;
+            value = fetch_dw(hdr + SR_CHUNK_OFFSET);
+            size = key == SR_SYS_MAINCHUNK ? sysblk.mainsize
+                                           : (U64)sysblk.xpndsize * 4096;
+            if (value % SR_STOR_CHUNKSIZE || value >= size)
+            {
+                // "SR: invalid storage chunk at offset %16.16"PRIX64
+                WRMSG(HHC02026, "E", value);
+                goto sr_base_error;
+            }
+            /* The sum of a delta unit is zero, which matches no chunk */
+            n = value / SR_STOR_CHUNKSIZE;
+            if (key == SR_SYS_MAINCHUNK)
+                msum[n] = fetch_dw(hdr + SR_CHUNK_SUM);
+            else
+                xsum[n] = fetch_dw(hdr + SR_CHUNK_SUM);
+            break;
+
+        default:
+            if (sr_read_skip((FILE*)file, len) != 0)
+                goto sr_base_error;
+            break;
+        }
+    }
+
+    SR_CLOSE(file);
+    return 0;
+
+sr_base_error:
+    // "SR: error processing file %s"
+    WRMSG(HHC02004, "E", fn);
+    if (file)
+        SR_CLOSE(file);
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Obtain the chunk checksums of storage as saved in a base image    */
+/*-------------------------------------------------------------------*/
+static U64 *sr_base_sums (char *fn, U64 **xsum)
+{
+U64     *msum;                          /* Main storage chunk sums   */
+U64      nm, nx, i, len;
+U64      size = sysblk.mainsize;
+U64      xsize = (U64)sysblk.xpndsize * 4096;
+U64      zsum, psum;
+BYTE    *zeros;
+
+    nm = (size + SR_STOR_CHUNKSIZE - 1) / SR_STOR_CHUNKSIZE;
+    nx = (xsize + SR_STOR_CHUNKSIZE - 1) / SR_STOR_CHUNKSIZE;
+    msum = malloc((nm + nx + 1) * sizeof(U64));
+    zeros = calloc(1, 4096);
+    if (msum == NULL || zeros == NULL)
+    {
+        // "SR: error in function %s: %s"
+        WRMSG(HHC02001, "E", "malloc()", strerror(errno));
+        free(msum);
+        free(zeros);
+        return NULL;
+    }
+    *xsum = msum + nm;
+
+    /* Chunks left out of the base images are zero */
+    psum = sr_page_sum(zeros);
+    free(zeros);
+    for (zsum = SR_SUM_INIT, len = 0; len < SR_STOR_CHUNKSIZE; len += 4096)
+        zsum = sr_sum_append(zsum, psum);
+    for (i = 0; i < nm; i++)
+    {
+        msum[i] = zsum;
+        if ((i + 1) * SR_STOR_CHUNKSIZE > size)
+            for (msum[i] = SR_SUM_INIT, len = i * SR_STOR_CHUNKSIZE;
+                 len < size; len += 4096)
+                msum[i] = sr_sum_append(msum[i], psum);
+    }
+    for (i = 0; i < nx; i++)
+        (*xsum)[i] = zsum;
+
+    if (sr_scan_base(fn, 1, NULL, msum, *xsum) != 0)
+    {
+        free(msum);
+        return NULL;
+    }
+    return msum;
+}
+
+/*-------------------------------------------------------------------*/
+/* Host page change tracking for checkpoint                          */
+/*                                                                   */
+/* The soft-dirty bits of the host page tables are reset once, when  */
+/* the checkpoint starts, and from then on mark every page written   */
+/* to since, by the CPUs or by I/O.  They are not reset between      */
+/* passes, which would lose the writes made between reading and      */
+/* resetting them; the page checksums decide instead which of the    */
+/* pages marked have really changed since they were last written.    */
+/*-------------------------------------------------------------------*/
+#if defined( __linux__ )
+#define SR_PM_SOFT_DIRTY    0x0080000000000000ULL   /* Written to    */
+#define SR_PM_SWAPPED       0x4000000000000000ULL   /* Page swapped  */
+#define SR_PM_PRESENT       0x8000000000000000ULL   /* Page present  */
+#define SR_PM_BATCH         512                     /* Entries read  */
+
+/* Read the pagemap entry of a host page */
+static U64 sr_pagemap (int fd, void *addr)
+{
+U64      ent;
+
+    if (pread(fd, &ent, sizeof(ent),
+              (off_t)((uintptr_t)addr / hostinfo.hostpagesz) * sizeof(ent))
+        != sizeof(ent))
+        return 0;
+    return ent;
+}
+#endif
+
+/*-------------------------------------------------------------------*/
+/* Start tracking page changes.  Returns the pagemap file descriptor */
+/* or -1 if the host cannot track them.                              */
+/*-------------------------------------------------------------------*/
+static int sr_track_start ()
+{
+#if defined( __linux__ )
+BYTE    *probe;                         /* Page to test tracking on  */
+int      fd, ok = 0;
+
+    if (hostinfo.hostpagesz % 4096)
+        return -1;
+    probe = mmap(NULL, hostinfo.hostpagesz, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (probe == MAP_FAILED)
         return -1;
+    probe[0] = 1;
+
+    /* Reset the soft-dirty bits, then see that writing sets them */
+    if ((fd = open("/proc/self/clear_refs", O_WRONLY)) >= 0)
+    {
+        ok = write(fd, "4", 1) == 1;
+        close(fd);
+    }
+    if ((fd = open("/proc/self/pagemap", O_RDONLY)) >= 0 && ok)
+    {
+        ok = !(sr_pagemap(fd, probe) & SR_PM_SOFT_DIRTY);
+        probe[0] = 2;
+        ok = ok && (sr_pagemap(fd, probe) & SR_PM_SOFT_DIRTY);
     }
+    munmap(probe, hostinfo.hostpagesz);
 
-    TRACE("SR: Begin Suspend Processing...\n");
+    if (!ok && fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Mark the pages of a storage area that may have changed since the  */
+/* tracking started, or all of them if it is not tracked             */
+/*-------------------------------------------------------------------*/
+static void sr_mark_dirty (SR_AREA *area, int fd, U64 zsum)
+{
+U64      npages = area->size / 4096;    /* Pages in the area         */
+#if defined( __linux__ )
+U64      ent[SR_PM_BATCH];              /* Pagemap entries           */
+U64      first, nhp, hp, pn, i, n;      /* Host pages, guest page    */
+U32      per;                           /* Guest pages per host page */
+int      dirty;
+#endif
+
+    memset(area->dirty, area->tracked ? 0 : 0xFF, (npages + 7) / 8);
+#if defined( __linux__ )
+    if (!area->tracked)
+        return;
+
+    per = (U32)(hostinfo.hostpagesz / 4096);
+    first = (uintptr_t)area->stor / hostinfo.hostpagesz;
+    nhp = (npages + per - 1) / per;
+    for (hp = 0; hp < nhp; hp += n)
+    {
+        n = MIN(SR_PM_BATCH, nhp - hp);
+        if (pread(fd, ent, n * sizeof(U64), (off_t)((first + hp) * sizeof(U64)))
+            != (ssize_t)(n * sizeof(U64)))
+        {
+            /* Fall back to checking every page */
+            area->tracked = 0;
+            memset(area->dirty, 0xFF, (npages + 7) / 8);
+            return;
+        }
+        for (i = 0; i < n; i++)
+            for (pn = (hp + i) * per; pn < (hp + i + 1) * per && pn < npages; pn++)
+            {
+                /* A page no longer present was released, and is zero */
+                if (ent[i] & (SR_PM_PRESENT | SR_PM_SWAPPED))
+                    dirty = (ent[i] & SR_PM_SOFT_DIRTY) != 0;
+                else
+                    dirty = area->pagesum[pn] != zsum;
+                if (dirty)
+                    area->dirty[pn / 8] |= 0x80 >> (pn % 8);
+            }
+    }
+#else
+    UNREFERENCED(fd);
+    UNREFERENCED(zsum);
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Write storage while the CPUs run: in full first, and then the     */
+/* pages that changed meanwhile, until few enough keep changing for  */
+/* the final pass to be made with the CPUs stopped                   */
+/*-------------------------------------------------------------------*/
+static int sr_live_precopy (SR_FILE file, SR_AREA *area, BYTE **dirty,
+                            int fd, U64 zsum)
+{
+S64      pages, last = -1, n;           /* Pages written             */
+int      pass, i;
+
+    for (i = 0; i < 2; i++)
+        if (area[i].size && sr_write_chunks(file, &area[i]) < 0)
+            return -1;
+    for (i = 0; i < 2; i++)
+        area[i].dirty = dirty[i];
+
+    for (pass = 1; pass <= SR_LIVE_PASSES
+                && (area[0].tracked || area[1].tracked); pass++)
+    {
+        for (pages = i = 0; i < 2; i++)
+        {
+            if (!area[i].size || !area[i].tracked)
+                continue;
+            sr_mark_dirty(&area[i], fd, zsum);
+            if ((n = sr_write_chunks(file, &area[i])) < 0)
+                return -1;
+            pages += n;
+        }
+        // "SR: checkpoint pass %d: %"PRIu64" changed pages written"
+        WRMSG(HHC02030, "I", pass, (U64)pages);
+        if (pages <= SR_LIVE_PAGES || (last >= 0 && pages >= last))
+            break;
+        last = pages;
+    }
+
+    for (i = 0; i < 2; i++)
+        if (area[i].size && !area[i].tracked)
+            // "SR: %s storage changes are not tracked; all of it is checked with the CPUs stopped"
+            WRMSG(HHC02031, "W", area[i].what);
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Stop all CPUs and wait for I/O to complete.  Returns the mask of  */
+/* the CPUs that were started.                                       */
+/*-------------------------------------------------------------------*/
+static CPU_BITMAP sr_quiesce ()
+{
+CPU_BITMAP started_mask;
+DEVBLK  *dev;
+int      i;
 
     /* Save CPU state and stop all CPU's */
     TRACE("SR: Stopping All CPUs...\n");
@@ -111,7 +974,7 @@ BYTE     psw[16];
             {
                 sysblk.regs[i]->cpustate = CPUSTATE_STOPPING;
                 ON_IC_INTERRUPT(sysblk.regs[i]);
-                signal_condition(&sysblk.regs[i]->intcond);
+                WAKEUP_CPU(sysblk.regs[i]);
             }
         }
         RELEASE_INTLOCK(NULL);
@@ -149,27 +1012,285 @@ BYTE     psw[16];
         // "SR: device %04X still busy, proceeding anyway"
         WRMSG(HHC02003, "W",dev->devnum);
     }
+    return started_mask;
+}
+
+static int sr_suspend(int argc, char *argv[], CPU_BITMAP *stopped,
+                      struct timeval *paused);
+
+int suspend_cmd(int argc, char *argv[],char *cmdline)
+{
+    UNREFERENCED(cmdline);
+
+    if (sr_suspend(argc, argv, NULL, NULL) != 0)
+        return -1;
+
+    TRACE("SR: Suspend Complete; shutting down...\n");
+
+    /* Shutdown */
+    do_shutdown();
+
+    return 0;
+}
+
+int checkpoint_cmd(int argc, char *argv[],char *cmdline)
+{
+CPU_BITMAP stopped = 0;                 /* CPUs stopped for the pass */
+struct   timeval paused, tv;            /* Time the CPUs stopped     */
+int      i, rc;
+
+    UNREFERENCED(cmdline);
+
+    rc = sr_suspend(argc, argv, &stopped, &paused);
+
+    /* Start the CPUs again, whether or not the checkpoint worked */
+    if (stopped)
+    {
+        TRACE("SR: Restarting CPUs...\n");
+        OBTAIN_INTLOCK(NULL);
+        for (i = 0; i < sysblk.maxcpu; i++)
+            if (IS_CPU_ONLINE(i) && (stopped & CPU_BIT(i)))
+            {
+                sysblk.regs[i]->cpustate = CPUSTATE_STARTED;
+                WAKEUP_CPU(sysblk.regs[i]);
+            }
+        RELEASE_INTLOCK(NULL);
+
+        gettimeofday(&tv, NULL);
+        timeval_subtract(&paused, &tv, &tv);
+        if (rc == 0)
+            // "SR: checkpoint written to %s; CPUs were stopped for %d.%3.3d seconds"
+            WRMSG(HHC02032, "I", argc >= 2 ? argv[1] : SR_DEFAULT_FILENAME,
+                  (int)tv.tv_sec, (int)(tv.tv_usec / 1000));
+    }
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Write a suspend image.  With stopped, it is a checkpoint written  */
+/* while the CPUs run; they are stopped for the final pass only, and */
+/* the mask of those to start again and the time they were stopped   */
+/* are returned.  Otherwise the CPUs are stopped from the start.     */
+/*-------------------------------------------------------------------*/
+static int sr_suspend(int argc, char *argv[], CPU_BITMAP *stopped,
+                      struct timeval *paused)
+{
+char    *fn = SR_DEFAULT_FILENAME;
+SR_FILE  file;
+CPU_BITMAP started_mask = 0;
+struct   timeval tv;
+time_t   tt;
+int      i, j, rc = -1;
+REGS    *regs;
+DEVBLK  *dev;
+IOINT   *ioq;
+BYTE     psw[16];
+int      live = stopped != NULL;        /* Checkpoint while running  */
+int      chunked = live;                /* Write chunked storage     */
+int      shared = 0;                    /* Storage left in its file  */
+U64      stamp;                         /* ...and its suspend stamp  */
+char    *base = NULL;                   /* Base of incremental image */
+U64     *msum = NULL, *xsum = NULL;     /* Base image chunk sums     */
+SR_AREA  area[2];                       /* Main and expanded storage */
+BYTE    *dirty[2] = { NULL, NULL };     /* ...pages to write again   */
+int      fd = -1;                       /* Host pagemap              */
+U64      zsum = 0;                      /* Sum of a zero page        */
+static BYTE zeropage[4096];
+
+    if (argc >= 2)
+        fn = argv[1];
+
+    /* Process options */
+    for (i = 2; i < argc; i++)
+    {
+        if (strcasecmp(argv[i], "chunked") == 0)
+            chunked = 1;
+        else if (strncasecmp(argv[i], "base=", 5) == 0 && argv[i][5])
+        {
+            chunked = 1;
+            base = argv[i] + 5;
+        }
+        else if (strcasecmp(argv[i], "shared") == 0 && !live)
+            shared = 1;
+        else
+        {
+            // "SR: invalid argument %s"
+            WRMSG(HHC02027, "E", argv[i]);
+            return -1;
+        }
+    }
+
+    /* Storage left in a shared file is not written to the image */
+    if (shared && chunked)
+    {
+        // "SR: invalid argument %s"
+        WRMSG(HHC02027, "E", "shared");
+        return -1;
+    }
+    if (shared && sysblk.mainfhdr == NULL)
+    {
+        // "SR: main storage is not shared with a file"
+        WRMSG(HHC02033, "E");
+        return -1;
+    }
+
+#ifndef HAVE_LIBZ
+    if (base || live)
+    {
+        // "SR: incremental and checkpoint images are not supported without zlib"
+        WRMSG(HHC02025, "E");
+        return -1;
+    }
+#endif
+
+    /* Obtain the chunk checksums of an incremental image's base */
+    if (base)
+    {
+        if (strcmp(base, fn) == 0)
+        {
+            // "SR: invalid argument %s"
+            WRMSG(HHC02027, "E", base);
+            return -1;
+        }
+        if ((msum = sr_base_sums(base, &xsum)) == NULL)
+            return -1;
+    }
+
+    /* Set up the storage areas for chunked images */
+    memset(area, 0, sizeof(area));
+    area[0].key = SR_SYS_MAINCHUNK;
+    area[0].what = "Main";
+    area[0].stor = sysblk.mainstor;
+    area[0].size = sysblk.mainsize;
+    area[0].basesum = msum;
+    area[1].key = SR_SYS_XPNDCHUNK;
+    area[1].what = "Expanded";
+    area[1].stor = sysblk.xpndstor;
+    area[1].size = (U64)sysblk.xpndsize * 4096;
+    area[1].basesum = xsum;
+
+    /* A checkpoint keeps the sums of the pages written to tell which
+       have changed, and starts tracking host page changes */
+    if (live)
+    {
+        zsum = sr_page_sum(zeropage);
+        for (i = 0; i < 2; i++)
+        {
+            if (area[i].size == 0)
+                continue;
+            area[i].pagesum = malloc((size_t)(area[i].size / 4096) * sizeof(U64));
+            dirty[i] = malloc((size_t)(area[i].size / 4096 + 7) / 8);
+            if (area[i].pagesum == NULL || dirty[i] == NULL)
+            {
+                // "SR: error in function %s: %s"
+                WRMSG(HHC02001, "E", "malloc()", strerror(errno));
+                goto sr_free_exit;
+            }
+        }
+        fd = sr_track_start();
+        area[0].tracked = fd >= 0 && sysblk.mainback != HUGEPG_2M
+                                  && sysblk.mainback != HUGEPG_1G;
+        area[1].tracked = fd >= 0 && sysblk.xpndback != HUGEPG_2M
+                                  && sysblk.xpndback != HUGEPG_1G;
+    }
+
+    file = SR_OPEN (fn, "wb");
+    if (file == NULL)
+    {
+        // "SR: error in function '%s': '%s'"
+        WRMSG(HHC02001, "E","open()",strerror(errno));
+        goto sr_free_exit;
+    }
+
+    TRACE("SR: Begin Suspend Processing...\n");
+
+    if (!live)
+        started_mask = sr_quiesce();
 
     /* Write header */
     TRACE("SR: Writing File Header...\n");
-    SR_WRITE_STRING(file, SR_HDR_ID, SR_ID);
+    SR_WRITE_STRING(file, SR_HDR_ID, chunked ? SR_ID_CHUNKED : SR_ID);
     SR_WRITE_STRING(file, SR_HDR_VERSION, VERSION);
     gettimeofday(&tv, NULL); tt = tv.tv_sec;
     SR_WRITE_STRING(file, SR_HDR_DATE, ctime(&tt));
 
+    /* Write storage while the CPUs run, then stop them */
+    if (live)
+    {
+        SR_WRITE_VALUE (file,SR_SYS_MAINSIZE,sysblk.mainsize,sizeof(sysblk.mainsize));
+        SR_WRITE_VALUE (file,SR_SYS_XPNDSIZE,sysblk.xpndsize,sizeof(sysblk.xpndsize));
+        SR_WRITE_VALUE (file,SR_SYS_CHUNKSIZE,SR_STOR_CHUNKSIZE,sizeof(U32));
+        if (base)
+            SR_WRITE_STRING(file,SR_SYS_STORBASE,base);
+        TRACE("SR: Saving Storage...\n");
+        if (sr_live_precopy(file, area, dirty, fd, zsum) != 0)
+            goto sr_error_exit;
+
+        gettimeofday(paused, NULL);
+        started_mask = *stopped = sr_quiesce();
+    }
+
     /* Write system data */
     TRACE("SR: Saving System Data...\n");
     SR_WRITE_STRING(file,SR_SYS_ARCH_NAME,arch_name[sysblk.arch_mode]);
     SR_WRITE_VALUE (file,SR_SYS_STARTED_MASK,started_mask,sizeof(started_mask));
-    SR_WRITE_VALUE (file,SR_SYS_MAINSIZE,sysblk.mainsize,sizeof(sysblk.mainsize));
-    TRACE("SR: Saving MAINSTOR...\n");
-    SR_WRITE_BUF   (file,SR_SYS_MAINSTOR,sysblk.mainstor,sysblk.mainsize);
+    if (live)
+    {
+        /* Final pass over the pages changed, with the CPUs stopped */
+        for (i = 0; i < 2; i++)
+        {
+            if (area[i].size == 0)
+                continue;
+            sr_mark_dirty(&area[i], fd, zsum);
+            if (sr_write_chunks(file, &area[i]) < 0)
+                goto sr_error_exit;
+        }
+    }
+    else
+    {
+        SR_WRITE_VALUE (file,SR_SYS_MAINSIZE,sysblk.mainsize,sizeof(sysblk.mainsize));
+        TRACE("SR: Saving MAINSTOR...\n");
+        if (shared)
+        {
+            /* Stamp the file so resume can tell it still holds the
+               storage of this image, and write it back */
+            stamp = (U64)tv.tv_sec * 1000000 + tv.tv_usec;
+            sysblk.mainfhdr->suspended = stamp;
+            if ((i = storage_sync()) != 0)
+            {
+                // "SR: error in function %s: %s"
+                WRMSG(HHC02001, "E", "msync()", strerror(i));
+                goto sr_error_exit;
+            }
+            SR_WRITE_STRING(file,SR_SYS_MAINFILE,sysblk.mainfile);
+            SR_WRITE_VALUE (file,SR_SYS_MAINSTAMP,stamp,sizeof(stamp));
+        }
+        else if (chunked)
+        {
+            SR_WRITE_VALUE (file,SR_SYS_CHUNKSIZE,SR_STOR_CHUNKSIZE,sizeof(U32));
+            if (base)
+                SR_WRITE_STRING(file,SR_SYS_STORBASE,base);
+            if (sr_write_chunks(file, &area[0]) < 0)
+                goto sr_error_exit;
+        }
+        else
+            SR_WRITE_BUF   (file,SR_SYS_MAINSTOR,sysblk.mainstor,sysblk.mainsize);
+    }
     SR_WRITE_VALUE (file,SR_SYS_SKEYSIZE,(sysblk.mainsize/_STORKEY_ARRAY_UNITSIZE),sizeof(U32));
     TRACE("SR: Saving Storage Keys...\n");
     SR_WRITE_BUF   (file,SR_SYS_STORKEYS,sysblk.storkeys,sysblk.mainsize/_STORKEY_ARRAY_UNITSIZE);
-    SR_WRITE_VALUE (file,SR_SYS_XPNDSIZE,sysblk.xpndsize,sizeof(sysblk.xpndsize));
-    TRACE("SR: Saving Expanded Storage...\n");
-    SR_WRITE_BUF   (file,SR_SYS_XPNDSTOR,sysblk.xpndstor,4096*sysblk.xpndsize);
+    if (!live)
+    {
+        SR_WRITE_VALUE (file,SR_SYS_XPNDSIZE,sysblk.xpndsize,sizeof(sysblk.xpndsize));
+        TRACE("SR: Saving Expanded Storage...\n");
+        if (chunked)
+        {
+            if (sr_write_chunks(file, &area[1]) < 0)
+                goto sr_error_exit;
+        }
+        else
+            SR_WRITE_BUF   (file,SR_SYS_XPNDSTOR,sysblk.xpndstor,4096*sysblk.xpndsize);
+    }
     SR_WRITE_VALUE (file,SR_SYS_CPUID,sysblk.cpuid,sizeof(sysblk.cpuid));
     SR_WRITE_VALUE (file,SR_SYS_CPUMODEL,sysblk.cpumodel,sizeof(sysblk.cpumodel));
     SR_WRITE_VALUE (file,SR_SYS_CPUVERSION,sysblk.cpuversion,sizeof(sysblk.cpuversion));
@@ -344,30 +1465,54 @@ BYTE     psw[16];
 
     SR_WRITE_HDR(file, SR_EOF, 0);
     SR_CLOSE (file);
-
-    TRACE("SR: Suspend Complete; shutting down...\n");
-
-    /* Shutdown */
-    do_shutdown();
-
-    return 0;
+    rc = 0;
+    goto sr_free_exit;
 
 sr_error_exit:
     // "SR: error processing file '%s'"
     WRMSG(HHC02004, "E", fn);
     SR_CLOSE (file);
-    return -1;
+    rc = -1;
+sr_free_exit:
+    if (fd >= 0)
+        close(fd);
+    for (i = 0; i < 2; i++)
+    {
+        free(area[i].pagesum);
+        free(dirty[i]);
+    }
+    free(msum);
+    return rc;
 }
 
 #define SR_NULL_REGS_CHECK(_regs)  if ((_regs) == NULL) goto sr_null_regs_exit;
 
+static int sr_resume(int argc, char *argv[], SR_CHUNKS **chunks);
+
 int resume_cmd(int argc, char *argv[],char *cmdline)
 {
+SR_CHUNKS *chunks = NULL;               /* Chunk restore workers     */
+int        rc;
+
+    UNREFERENCED(cmdline);
+
+    rc = sr_resume(argc, argv, &chunks);
+
+    /* Stop any workers left by a resume that failed */
+    if (chunks)
+        sr_chunks_finish(chunks);
+
+    return rc;
+}
+
+static int sr_resume(int argc, char *argv[], SR_CHUNKS **chunks)
+{
 char    *fn = SR_DEFAULT_FILENAME;
 SR_FILE  file;
 U32      key = 0, len = 0;
 U64      mainsize = 0;
 U64      xpndsize = 0;
+U64      stamp;
 CPU_BITMAP started_mask = 0;
 int      i, rc = -1;
 REGS    *regs = NULL;
@@ -384,8 +1529,6 @@ char     zeros[16];
 S64      dreg;
 int      numconfdev=0;
 
-    UNREFERENCED(cmdline);
-
     if (argc > 2)
     {
         // "SR: too many arguments"
@@ -421,7 +1564,7 @@ int      numconfdev=0;
     TRACE("SR: Reading File Header...\n");
     SR_READ_HDR(file, key, len);
     if (key == SR_HDR_ID) SR_READ_STRING(file, buf, len);
-    if (key != SR_HDR_ID || strcmp(buf, SR_ID))
+    if (key != SR_HDR_ID || (strcmp(buf, SR_ID) && strcmp(buf, SR_ID_CHUNKED)))
     {
         // "SR: file identifier error"
         WRMSG(HHC02006, "E");
@@ -514,6 +1657,81 @@ int      numconfdev=0;
             SR_READ_BUF(file, sysblk.mainstor, mainsize);
             break;
 
+        case SR_SYS_MAINFILE:
+            SR_READ_STRING(file, buf, len);
+            if (sysblk.mainfhdr == NULL)
+            {
+                // "SR: main storage is not shared with a file"
+                WRMSG(HHC02033, "E");
+                goto sr_error_exit;
+            }
+            // "SR: main storage was left in shared file %s"
+            WRMSG(HHC02034, "I", buf);
+            break;
+
+        case SR_SYS_MAINSTAMP:
+            SR_READ_VALUE(file, len, &stamp, sizeof(stamp));
+            if (sysblk.mainfhdr == NULL
+             || sysblk.mainfhdr->suspended != stamp)
+            {
+                // "SR: shared file %s does not hold the main storage of this image"
+                WRMSG(HHC02035, "E", sysblk.mainfile ? sysblk.mainfile : "");
+                goto sr_error_exit;
+            }
+            /* The storage is resumed as it is; once only, as the
+               system will change it */
+            sysblk.mainfhdr->suspended = 0;
+            sysblk.main_clear = 0;
+            break;
+
+        case SR_SYS_CHUNKSIZE:
+            SR_READ_VALUE(file, len, &len, sizeof(len));
+            if (len != SR_STOR_CHUNKSIZE)
+            {
+                char buf1[20];
+                char buf2[20];
+                MSGBUF(buf1, "%d", len);
+                MSGBUF(buf2, "%d", SR_STOR_CHUNKSIZE);
+                // "SR: mismatch in '%s': '%s' found, '%s' expected"
+                WRMSG(HHC02009, "E", "chunk size", buf1, buf2);
+                goto sr_error_exit;
+            }
+            /* Storage not in any chunk is zero */
+            storage_release(sysblk.mainstor, sysblk.mainsize, sysblk.mainback);
+            if (sysblk.xpndstor)
+                storage_release(sysblk.xpndstor, (size_t)sysblk.xpndsize * 4096,
+                                sysblk.xpndback);
+            sysblk.main_clear = sysblk.xpnd_clear = 0;
+            if (*chunks == NULL && (*chunks = sr_chunks_start()) == NULL)
+                goto sr_error_exit;
+            break;
+
+        case SR_SYS_STORBASE:
+            SR_READ_STRING(file, buf, len);
+            if (*chunks == NULL)
+            {
+                // "SR: invalid key %8.8X"
+                WRMSG(HHC02018, "E", key);
+                goto sr_error_exit;
+            }
+            // "SR: restoring storage from base image %s"
+            WRMSG(HHC02029, "I", buf);
+            if (sr_scan_base(buf, 1, *chunks, NULL, NULL) != 0)
+                goto sr_error_exit;
+            break;
+
+        case SR_SYS_MAINCHUNK:
+        case SR_SYS_XPNDCHUNK:
+            if (*chunks == NULL)
+            {
+                // "SR: invalid key %8.8X"
+                WRMSG(HHC02018, "E", key);
+                goto sr_error_exit;
+            }
+            if (sr_read_chunk(*chunks, file, key, len) != 0)
+                goto sr_error_exit;
+            break;
+
         case SR_SYS_SKEYSIZE:
             SR_READ_VALUE(file, len, &len, sizeof(len));
             if (len > (U32)(sysblk.mainsize/_STORKEY_ARRAY_UNITSIZE))
@@ -1358,6 +2576,15 @@ int      numconfdev=0;
 
     } /* while (key != SR_EOF) */
 
+    /* Wait for the last storage chunks to be restored */
+    if (*chunks)
+    {
+        rc = sr_chunks_finish(*chunks);
+        *chunks = NULL;
+        if (rc != 0)
+            goto sr_error_exit;
+    }
+
     TRACE("SR: Resume File Processing Complete...\n");
     TRACE("SR: Resuming Devices...\n");
 
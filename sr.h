@@ -127,6 +127,46 @@
  * There may be other instances where the processing of one
  * key requires that another key has been previously processed.
  *
+ * Chunked images
+ *
+ * `suspend file chunked' writes main and expanded storage as
+ * SR_SYS_MAINCHUNK and SR_SYS_XPNDCHUNK units of SR_STOR_CHUNKSIZE
+ * bytes of storage each, instead of as a single SR_SYS_MAINSTOR or
+ * SR_SYS_XPNDSTOR buffer.  The chunks are built and compressed by
+ * several threads and may appear in any order.  A chunk unit starts
+ * with an SR_CHUNK_HDRLEN byte header giving the offset of the chunk
+ * in storage, a checksum of its contents and a bitmap of the pages
+ * whose contents follow; pages not in the bitmap are zero.  Chunks
+ * that are entirely zero are left out, since resume clears storage
+ * when it reads the SR_SYS_CHUNKSIZE unit that precedes them.
+ *
+ * `suspend file base=basefile' writes an incremental image, which
+ * only contains the chunks whose checksum differs from the one in
+ * basefile (or in its own base, and so on).  The SR_SYS_STORBASE
+ * unit names the base, which resume restores storage from first.
+ *
+ * `checkpoint file' writes a chunked image while the CPUs keep
+ * running.  Storage is first written in full and then, in up to
+ * SR_LIVE_PASSES further passes, the pages that changed meanwhile are
+ * written again in delta units, flagged SR_CHUNK_DELTA, which replace
+ * just the pages in their bitmap.  Once few pages are left changing,
+ * the CPUs are stopped for the final delta and for the remaining
+ * state, and then started again.  Resume restores the units for a
+ * chunk in the order they were written.  The checksum of a delta unit
+ * is zero, so that an increment based on a checkpoint writes those
+ * chunks in full.
+ *
+ * `suspend file shared', with main storage shared with a file
+ * (mainsize FILE=), leaves main storage in that file and writes
+ * SR_SYS_MAINFILE and SR_SYS_MAINSTAMP units in place of it.  The
+ * stamp is also placed in the file's STORFILE header; resume, in a
+ * Hercules that maps the same file again, checks that it still
+ * matches and then takes storage as it is, and resets the stamp so
+ * that the image is only resumed once.
+ *
+ * Chunked images have a different SR_HDR_ID string so that releases
+ * without chunk support reject them instead of skipping storage.
+ *
  */
 
 #ifndef _HERCULES_SR_H
@@ -135,9 +175,27 @@
 #include "opcode.h"
 
 #define SR_ID                   "Hercules suspend/resume file"
+#define SR_ID_CHUNKED           "Hercules suspend/resume file, chunked storage"
 #define SR_MAX_STRING_LENGTH    4096
 #define SR_SKIP_CHUNKSIZE       256
 #define SR_BUF_CHUNKSIZE        (256*1024*1024)
+#define SR_STOR_CHUNKSIZE       (1024*1024)
+#define SR_MAX_THREADS          16
+#define SR_MAX_BASE_DEPTH       16
+#define SR_LIVE_PASSES          8       /* Checkpoint delta passes   */
+#define SR_LIVE_PAGES           8192    /* ...until fewer pages left */
+
+/* Chunk unit header */
+#define SR_CHUNK_OFFSET         0       /* U64 storage offset        */
+#define SR_CHUNK_SUM            8       /* U64 checksum of the chunk */
+#define SR_CHUNK_DATALEN        16      /* U32 length of page data   */
+#define SR_CHUNK_FLAGS          20      /* Flags...                  */
+#define SR_CHUNK_ZLIB           0x80    /* Page data is compressed   */
+#define SR_CHUNK_DELTA          0x40    /* Pages not present are     */
+                                        /* unchanged, not zero       */
+#define SR_CHUNK_MAP            24      /* Bitmap of pages present   */
+#define SR_CHUNK_PAGES          (SR_STOR_CHUNKSIZE/4096)
+#define SR_CHUNK_HDRLEN         (SR_CHUNK_MAP + SR_CHUNK_PAGES/8)
 
 #define SR_KEY_ID_MASK          0xfff00000
 #define SR_KEY_ID               0xace00000
@@ -192,6 +250,12 @@
 #define SR_SYS_LPARNUM          0xace10052
 #define SR_SYS_CPUIDFMT         0xace10053
 #define SR_SYS_OPERATION_MODE   0xace10054
+#define SR_SYS_CHUNKSIZE        0xace10060
+#define SR_SYS_STORBASE         0xace10061
+#define SR_SYS_MAINCHUNK        0xace10062
+#define SR_SYS_XPNDCHUNK        0xace10063
+#define SR_SYS_MAINFILE         0xace10064
+#define SR_SYS_MAINSTAMP        0xace10065
 
 #define SR_SYS_SERVC            0xace11000
 
@@ -468,6 +532,10 @@
  gzseek((gzFile)(_stream), (_offset), (_whence))
 #define SR_CLOSE(_stream) \
  gzclose((gzFile)(_stream))
+#define SR_SETLEVEL(_stream, _level) \
+ gzsetparams((gzFile)(_stream), (_level), Z_DEFAULT_STRATEGY)
+#define SR_LEVEL_NONE           Z_NO_COMPRESSION
+#define SR_LEVEL_DEFAULT        Z_DEFAULT_COMPRESSION
 #else
 #define SR_DEFAULT_FILENAME "hercules.srf"
 #define SR_FILE FILE *
@@ -481,6 +549,9 @@
  fseek((_stream), (_offset), (_whence))
 #define SR_CLOSE(_stream) \
  fclose((_stream))
+#define SR_SETLEVEL(_stream, _level)
+#define SR_LEVEL_NONE           0
+#define SR_LEVEL_DEFAULT        0
 #endif
 
 static INLINE int sr_write_hdr    (FILE* file, U32  key,               U32  len);
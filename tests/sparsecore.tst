@@ -0,0 +1,62 @@
+*Testcase sparsecore save and load a sparse core image
+
+# A sparse core image holds only the pages that are not zero.  Pages 1
+# and 3-4 of the range 1000-7FFF are set, so the image holds two
+# extents.  savecore does not replace an existing file; rerun in the
+# same directory, the image left by the earlier run is loaded, which
+# was saved from the same storage.
+
+msglevel -debug
+sysclear
+archmode z/Arch
+r 1000=0102030405060708
+r 3FF8=1112131415161718
+r 4000=2122232425262728
+savecore "sparsecore.core" 1000 7FFF sparse
+
+# Loaded where it was saved from; the zero pages are cleared.
+
+sysclear
+r 2000=FFFFFFFFFFFFFFFF
+loadcore "sparsecore.core"
+*Compare
+*Info 1 HHC02250I Loading file sparsecore.core to location 1000
+*Info HHC02249I Operation complete
+r 1000.10
+*Want "page 1" 01020304 05060708 00000000 00000000
+r 2000.10
+*Want "page 2 left out" 00000000 00000000 00000000 00000000
+r 3FF0.10
+*Want "end of page 3" 00000000 00000000 11121314 15161718
+r 4000.10
+*Want "page 4" 21222324 25262728 00000000 00000000
+
+# Loaded at a given address.
+
+r 21000=FFFFFFFFFFFFFFFF
+loadcore "sparsecore.core" 20000
+*Info 1 HHC02250I Loading file sparsecore.core to location 20000
+*Info HHC02249I Operation complete
+r 20000.10
+*Want "page 1" 01020304 05060708 00000000 00000000
+r 21000.10
+*Want "page 2 left out" 00000000 00000000 00000000 00000000
+r 22FF0.10
+*Want "end of page 3" 00000000 00000000 11121314 15161718
+r 23000.10
+*Want "page 4" 21222324 25262728 00000000 00000000
+
+# sparsecore-short.core says it has two extents but its file ends
+# after the first index entry.  sparsecore-badidx.core has both, but
+# the second extent comes before the first.  Both are rejected before
+# storage is changed.
+
+r 1000=FFFFFFFFFFFFFFFF
+loadcore "$(testpath)/sparsecore-short.core"
+*Error HHC02360E Loadcore: file $(testpath)/sparsecore-short.core is not a valid sparse core image
+loadcore "$(testpath)/sparsecore-badidx.core"
+*Error HHC02360E Loadcore: file $(testpath)/sparsecore-badidx.core is not a valid sparse core image
+r 1000.10
+*Want "storage not changed" FFFFFFFF FFFFFFFF 00000000 00000000
+
+*Done nowait
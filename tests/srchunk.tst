@@ -0,0 +1,28 @@
+*Testcase srchunk resume an incremental chunked checkpoint
+
+# The storage is two 1M chunks.  A base image is written with both,
+# then only the second is changed, and the incremental image written
+# against the base holds only that chunk.  Resuming the incremental
+# image restores the first chunk from the base.
+
+msglevel -debug
+sysclear
+archmode z/Arch
+mainsize 2M
+r 1000=0102030405060708
+r 180000=1112131415161718
+checkpoint "srchunk-base.srf"
+r 180000=2122232425262728
+checkpoint "srchunk-incr.srf" base=srchunk-base.srf
+
+sysclear
+r 1000=FFFFFFFFFFFFFFFF
+r 180000=FFFFFFFFFFFFFFFF
+resume "srchunk-incr.srf"
+*Compare
+r 1000.10
+*Want "chunk from base" 01020304 05060708 00000000 00000000
+r 180000.10
+*Want "changed chunk" 21222324 25262728 00000000 00000000
+
+*Done nowait
@@ -35,6 +35,9 @@ void update_cpu_timer(void)
 int             cpu;                    /* CPU counter               */
 REGS           *regs;                   /* -> CPU register context   */
 CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
+#if defined(_FEATURE_INTERVAL_TIMER)
+CPU_BITMAP      itmask = 0;             /* Interval timer CPU mask   */
+#endif /*defined(_FEATURE_INTERVAL_TIMER)*/
 
 #if defined(OPTION_MIPS_COUNTING)
     /* If no CPUs are available, just return (device server mode) */
@@ -42,18 +45,21 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
       return;
 #endif /*defined(OPTION_MIPS_COUNTING)*/
 
-    /* Access the diffent register contexts with the intlock held */
-    OBTAIN_INTLOCK(NULL);
-
-    /* Check for [1] clock comparator, [2] cpu timer, and
-     * [3] interval timer interrupts for each CPU.
+    /* Check for [1] clock comparator and [2] cpu timer interrupts
+     * for each CPU.  These only concern the CPU itself, so each
+     * register context is accessed with just its cpulock held.
      */
     for (cpu = 0; cpu < sysblk.hicpu; cpu++)
     {
+        obtain_lock(&sysblk.cpulock[cpu]);
+
         /* Ignore this CPU if it is not started */
         if (!IS_CPU_ONLINE(cpu)
          || CPUSTATE_STOPPED == sysblk.regs[cpu]->cpustate)
+        {
+            release_lock(&sysblk.cpulock[cpu]);
             continue;
+        }
 
         /* Point to the CPU register context */
         regs = sysblk.regs[cpu];
@@ -119,41 +125,152 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
 #endif /*defined(_FEATURE_SIE)*/
 
 #if defined(_FEATURE_INTERVAL_TIMER)
-        /*-------------------------------------------*
-         * [3] Check for interval timer interrupt    *
-         *-------------------------------------------*/
+        /* Note the CPUs whose interval timer must be checked */
+        if(regs->arch_mode == ARCH_370
+#if defined(_FEATURE_SIE)
+          || (regs->sie_active
+            && SIE_STATB(regs->guestregs, M, 370)
+            && SIE_STATNB(regs->guestregs, M, ITMOF))
+#endif /*defined(_FEATURE_SIE)*/
+          )
+            itmask |= regs->cpubit;
+#endif /*defined(_FEATURE_INTERVAL_TIMER)*/
 
-        if(regs->arch_mode == ARCH_370)
-        {
-            if( chk_int_timer(regs) )
-                intmask |= regs->cpubit;
-        }
+        /* Wake up the CPU if it is waiting */
+        if (intmask & regs->cpubit)
+            wakeup_posted_cpu(regs);
 
+        release_lock(&sysblk.cpulock[cpu]);
 
-#if defined(_FEATURE_SIE)
-        /* When running under SIE also update the SIE copy */
-        if(regs->sie_active)
+    } /* end for(cpu) */
+
+#if defined(_FEATURE_INTERVAL_TIMER)
+    /* [3] Check for interval timer interrupts.  The interval timer
+     * is kept in the PSA and updated by its CPU under the intlock.
+     */
+    if (itmask)
+    {
+        OBTAIN_INTLOCK(NULL);
+
+        intmask = 0;
+        for (cpu = 0; cpu < sysblk.hicpu; cpu++)
         {
-            if(SIE_STATB(regs->guestregs, M, 370)
-              && SIE_STATNB(regs->guestregs, M, ITMOF))
+            if (!(itmask & CPU_BIT(cpu)) || !IS_CPU_ONLINE(cpu))
+                continue;
+
+            regs = sysblk.regs[cpu];
+
+            if(regs->arch_mode == ARCH_370)
             {
-                if( chk_int_timer(regs->guestregs) )
+                if( chk_int_timer(regs) )
                     intmask |= regs->cpubit;
             }
-        }
+
+#if defined(_FEATURE_SIE)
+            /* When running under SIE also update the SIE copy */
+            if(regs->sie_active)
+            {
+                if(SIE_STATB(regs->guestregs, M, 370)
+                  && SIE_STATNB(regs->guestregs, M, ITMOF))
+                {
+                    if( chk_int_timer(regs->guestregs) )
+                        intmask |= regs->cpubit;
+                }
+            }
 #endif /*defined(_FEATURE_SIE)*/
+        }
 
+        /* If an interval timer interrupt condition was detected
+           then wake up those CPUs if they are waiting */
+        WAKEUP_CPUS_MASK (intmask & sysblk.waiting_mask);
+
+        RELEASE_INTLOCK(NULL);
+    }
 #endif /*defined(_FEATURE_INTERVAL_TIMER)*/
 
-    } /* end for(cpu) */
+} /* end function check_timer_event */
 
-    /* If a timer interrupt condition was detected for any CPU
-       then wake up those CPUs if they are waiting */
-    WAKEUP_CPUS_MASK (intmask);
+#if defined(OPTION_GUEST_PROFILER)
+/*-------------------------------------------------------------------*/
+/* Take a guest PSW profiler sample of each online CPU               */
+/*                                                                   */
+/* Called by the timer thread when the profiler is active, with the  */
+/* sampling rate it read once from sysblk.profhz, which the profile  */
+/* command may reset to zero at any time.  A CPU in SIE is sampled   */
+/* as its guest.  The instruction address is derived from the AIA    */
+/* if it is valid, which is read without serialization; a torn read  */
+/* only ever costs one inaccurate sample.                            */
+/*-------------------------------------------------------------------*/
+static void profile_sample (U32 hz)
+{
+static U64  next;                       /* Time of next sample       */
+U64         now;                        /* Current time of day       */
+int         i;                          /* CPU index                 */
+REGS       *regs;                       /* -> REGS                   */
+PROFBUF    *pb;                         /* -> CPU sample ring        */
+PROFSAMP   *ps;                         /* -> Sample                 */
+BYTE       *ip, *aip;                   /* Instruction pointers      */
+
+    now = host_tod();
+    if (now < next)
+        return;
+    next = now + ETOD_SEC / hz;
+
+    for (i = 0; i < sysblk.hicpu; i++)
+    {
+        obtain_lock (&sysblk.cpulock[i]);
 
-    RELEASE_INTLOCK(NULL);
+        if (!IS_CPU_ONLINE(i))
+        {
+            release_lock (&sysblk.cpulock[i]);
+            continue;
+        }
 
-} /* end function check_timer_event */
+        if (!(pb = sysblk.profbuf[i]))
+            pb = sysblk.profbuf[i] = calloc(1, sizeof(PROFBUF));
+        if (!pb)
+        {
+            release_lock (&sysblk.cpulock[i]);
+            continue;
+        }
+
+        regs = sysblk.regs[i];
+        ps = &pb->samp[pb->head % PROF_SAMPLES];
+        ps->flags = 0;
+        ps->cpuad = regs->cpuad;
+        if (regs->sie_active && regs->guestregs)
+        {
+            regs = regs->guestregs;
+            ps->flags |= PROF_SIE;
+        }
+
+        ip  = regs->ip;
+        aip = regs->aip;
+        if (regs->aie && ip >= aip && ip < aip + PAGEFRAME_PAGESIZE)
+            ps->ia = regs->aiv.D + (ip - aip);
+        else
+            ps->ia = regs->psw.IA_G;
+
+        if (regs->arch_mode == ARCH_900)
+            ps->asce = regs->CR_G(1);
+        else
+        {
+            ps->ia  &= 0x7FFFFFFF;
+            ps->asce = regs->CR_L(1);
+        }
+        ps->asn = regs->CR_LHL(4);
+
+        if (PROBSTATE(&regs->psw))
+            ps->flags |= PROF_PROB;
+        if (WAITSTATE(&regs->psw) || regs->cpustate != CPUSTATE_STARTED)
+            ps->flags |= PROF_WAIT;
+
+        pb->head++;
+
+        release_lock (&sysblk.cpulock[i]);
+    }
+}
+#endif /*defined(OPTION_GUEST_PROFILER)*/
 
 /*-------------------------------------------------------------------*/
 /* TOD clock and timer thread                                        */
@@ -186,11 +303,15 @@ const U64   period = ETOD_SEC;          /* MIPS calculation period   */
         ((((_x) * (_y)) + halfdiff) / diff)
 
 #endif /*OPTION_MIPS_COUNTING*/
+#if defined(OPTION_GUEST_PROFILER)
+U32     profhz;                         /* Profiler samples/sec      */
+#endif
 
     UNREFERENCED(argp);
 
-    /* Set timer thread priority */
+    /* Set timer thread priority and host CPU affinity */
     set_thread_priority(0, sysblk.todprio);
+    apply_thread_affinity(AFFINITY_TOD, -1);
 
     /* Display thread started message on control panel */
     WRMSG (HHC00100, "I", thread_id(), get_thread_priority(0), "Timer");
@@ -286,6 +407,12 @@ const U64   period = ETOD_SEC;          /* MIPS calculation period   */
 
 #endif /*OPTION_MIPS_COUNTING*/
 
+#if defined(OPTION_GUEST_PROFILER)
+        profhz = sysblk.profhz;
+        if (unlikely(profhz))
+            profile_sample(profhz);
+#endif
+
         /* Sleep for another timer update interval... */
         usleep ( sysblk.timerint );
 
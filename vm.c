@@ -1580,6 +1580,70 @@ static  char timefmt[]="%m/%d/%y%H:%M:%S%m/%d/%Y%Y-%m-%d";
 
 } /* end function pseudo_timer */
 
+/*-------------------------------------------------------------------*/
+/* Give the host pages backing a range of absolute storage back to   */
+/* the host and reset the reference and change bits of its frames    */
+/*-------------------------------------------------------------------*/
+static void ARCH_DEP(release_frames) (RADR abs, RADR len, REGS *regs)
+{
+RADR    a;                              /* Frame address             */
+
+    if (len == 0)
+        return;
+
+    storage_release(regs->mainstor + abs, (size_t)len, sysblk.mainback);
+
+    for (a = abs; a < abs + len; a += STORAGE_KEY_PAGESIZE)
+        STORAGE_KEY(a, regs) &= ~(STORKEY_REF | STORKEY_CHANGE);
+
+} /* end function release_frames */
+
+/*-------------------------------------------------------------------*/
+/* Release Pages (Function code 0x010)                               */
+/*-------------------------------------------------------------------*/
+void ARCH_DEP(diag_release_pages) (int r1, int r2, REGS *regs)
+{
+RADR    start, end;                     /* First/last frame to free  */
+RADR    real;                           /* Real frame address        */
+RADR    run;                            /* Start of frames to free   */
+RADR    pxsize;                         /* Size of the prefix area   */
+
+    /* Obtain the first and last frame addresses from R1 and R2 */
+#if defined(FEATURE_ESAME)
+    start = regs->GR_G(r1);
+    end = regs->GR_G(r2);
+#else
+    start = regs->GR_L(r1) & 0x7FFFFFFF;
+    end = regs->GR_L(r2) & 0x7FFFFFFF;
+#endif
+
+    /* Program check if the addresses are not on frame boundaries
+       or the first address is beyond the last */
+    if ((start & PAGEFRAME_BYTEMASK) || (end & PAGEFRAME_BYTEMASK)
+        || start > end)
+        ARCH_DEP(program_interrupt) (regs, PGM_SPECIFICATION_EXCEPTION);
+
+    /* Program check if the last frame is outside main storage */
+    if (end > regs->mainlim)
+        ARCH_DEP(program_interrupt) (regs, PGM_ADDRESSING_EXCEPTION);
+
+    /* Real frames are absolute frames, except in the prefix area
+       and at the prefix, which are never released */
+    pxsize = PX_MASK & (0 - PX_MASK);
+    run = start;
+    for (real = start; real <= end; real += PAGEFRAME_PAGESIZE)
+    {
+        if (real < pxsize
+         || (real >= regs->PX && real < regs->PX + pxsize))
+        {
+            ARCH_DEP(release_frames) (run, real - run, regs);
+            run = real + PAGEFRAME_PAGESIZE;
+        }
+    }
+    ARCH_DEP(release_frames) (run, end + PAGEFRAME_PAGESIZE - run, regs);
+
+} /* end function diag_release_pages */
+
 /*-------------------------------------------------------------------*/
 /* Pending Page Release (Function code 0x214)                        */
 /*-------------------------------------------------------------------*/
@@ -1617,6 +1681,11 @@ BYTE    func;                           /* Function code...          */
     switch (func)
     {
     case DIAG214_EPR:  /* Establish Pending Release */
+
+        /* The contents of the frames are unpredictable once the
+           release is established, so release them at once */
+        ARCH_DEP(release_frames) (start, end + STORAGE_KEY_PAGESIZE - start,
+                                  regs);
         break;
 
     case DIAG214_CPR:  /* Cancel Pending Release */
@@ -691,6 +691,32 @@ int     len;                            /* Length for page crossing  */
     }
 #endif /*defined(FEATURE_PER)*/
 
+#if defined(OPTION_BRANCH_TARGET_CACHE)
+    /* Return to a recently executed page without a TLB lookup */
+    if (!exec && likely(!regs->tracing && !regs->permode)
+     && likely(pagesz == PAGEFRAME_PAGESIZE))
+    {
+        BTCENT *bte = &regs->btc[(addr >> PAGEFRAME_PAGESHIFT) & (BTC_ENTRIES-1)];
+
+        if (bte->vaddr == (addr & PAGEFRAME_PAGEMASK)
+         && bte->tlbID == regs->tlbID
+         && bte->pkey == regs->psw.pkey
+         && regs->AEA_AR(USE_INST_SPACE)
+         && bte->asd == regs->CR(regs->AEA_AR(USE_INST_SPACE))
+         && offset + ILC(bte->aip[offset]) <= pagesz)
+        {
+            regs->btchits++;
+            regs->ip  = bte->aip + offset;
+            regs->AIV = addr & PAGEFRAME_PAGEMASK;
+            regs->aip = bte->aip;
+            regs->aim = (uintptr_t)regs->aip ^ (uintptr_t)regs->AIV;
+            regs->aie = regs->aip + pagesz - 5;
+            PDC_SET_PAGE(regs);
+            return regs->ip;
+        }
+    }
+#endif /*defined(OPTION_BRANCH_TARGET_CACHE)*/
+
     if (!exec) regs->instinvalid = 1;
 
     /* Get instruction address */
@@ -724,7 +750,24 @@ int     len;                            /* Length for page crossing  */
         regs->aip = (BYTE *)((uintptr_t)ia & ~PAGEFRAME_BYTEMASK);
         regs->aim = (uintptr_t)regs->aip ^ (uintptr_t)regs->AIV;
         if (likely(!regs->tracing && !regs->permode))
+        {
             regs->aie = regs->aip + pagesz - 5;
+            PDC_SET_PAGE(regs);
+#if defined(OPTION_BRANCH_TARGET_CACHE)
+            if (likely(pagesz == PAGEFRAME_PAGESIZE)
+             && regs->AEA_AR(USE_INST_SPACE))
+            {
+                BTCENT *bte = &regs->btc[(regs->AIV >> PAGEFRAME_PAGESHIFT)
+                                         & (BTC_ENTRIES-1)];
+                bte->vaddr = regs->AIV;
+                bte->asd   = regs->CR(regs->AEA_AR(USE_INST_SPACE));
+                bte->aip   = regs->aip;
+                bte->tlbID = regs->tlbID;
+                bte->pkey  = regs->psw.pkey;
+                regs->btcfills++;
+            }
+#endif /*defined(OPTION_BRANCH_TARGET_CACHE)*/
+        }
         else
         {
             regs->aie = (BYTE *)1;
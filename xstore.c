@@ -175,11 +175,13 @@ int     r1, r2;                         /* Values of R fields        */
     /* Perform serialization before operation */
     PERFORM_SERIALIZATION (regs);
     OBTAIN_INTLOCK(regs);
-    SYNCHRONIZE_CPUS(regs);
 
     /* Invalidate page table entry */
     ARCH_DEP(invalidate_pte) (inst[1], regs->GR_G(r1), regs->GR_L(r2), regs);
 
+    /* Wait for the other CPUs to purge their TLB entries */
+    ARCH_DEP(purge_wait) (regs);
+
     RELEASE_INTLOCK(regs);
 
     /* Perform serialization after operation */